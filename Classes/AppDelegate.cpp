@@ -56,6 +56,22 @@ bool AppDelegate::applicationDidFinishLaunching() {
     glview->setDesignResolutionSize(designResolutionSize.width, designResolutionSize.height, ResolutionPolicy::NO_BORDER);
 
     director->setContentScaleFactor(1);
+
+    // pack the small sprite images into shared textures, so they are drawn in a single batch
+    director->getTextureCache()->setDynamicAtlasEnabled(true);
+
+    // keep the decoded images in the writable path, so later launches skip decoding them
+    DecodedImageCache::setEnabled(true);
+
+    // resolve the file names from the paths found at the previous launch, or from one scan of the search paths,
+    // keeping a cache per version since an update may add files in front of the cached ones
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPathCache = fileUtils->getWritablePath() + "fullpaths-" + Application::getInstance()->getVersion() + ".plist";
+    if (!fileUtils->loadFullPathCache(fullPathCache))
+    {
+        fileUtils->buildFullPathCache();
+        fileUtils->saveFullPathCache(fullPathCache);
+    }
     
     register_all_packages();
 
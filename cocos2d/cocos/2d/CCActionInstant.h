@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include <functional>
 #include "2d/CCAction.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -324,6 +325,8 @@ private:
 class CC_DLL CallFunc : public ActionInstant
 {
 public:
+    CC_DECLARE_OBJECT_POOL(CallFunc)
+
     /** Creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
      * When this function bound in js or lua ,the input param will be changed.
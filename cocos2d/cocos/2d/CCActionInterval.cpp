@@ -39,9 +39,27 @@ THE SOFTWARE.
 #include "base/CCEventDispatcher.h"
 #include "platform/CCStdC.h"
 #include "base/CCScriptSupport.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+// the common actions are allocated from pools, they can be created by any thread
+CC_DEFINE_OBJECT_POOL(Sequence, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(Spawn, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(RepeatForever, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(Repeat, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(DelayTime, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(MoveBy, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(MoveTo, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(ScaleTo, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(ScaleBy, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(RotateTo, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(RotateBy, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(FadeTo, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(FadeIn, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(FadeOut, 64, locking_semantics)
+CC_DEFINE_OBJECT_POOL(TintTo, 64, locking_semantics)
+
 // Extra action for making a Sequence or Spawn when only adding one action to it.
 class ExtraAction : public FiniteTimeAction
 {
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "2d/CCAnimation.h"
 #include "base/CCProtocols.h"
 #include "base/CCVector.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -128,6 +129,8 @@ protected:
 class CC_DLL Sequence : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Sequence)
+
     /** Helper constructor to create an array of sequenceable actions.
      *
      * @return An autoreleased Sequence object.
@@ -216,6 +219,8 @@ private:
 class CC_DLL Repeat : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Repeat)
+
     /** Creates a Repeat action. Times is an unsigned integer between 1 and pow(2,30).
      *
      * @param action The action needs to repeat.
@@ -287,6 +292,8 @@ private:
 class CC_DLL RepeatForever : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(RepeatForever)
+
     /** Creates the action.
      *
      * @param action The action need to repeat forever.
@@ -352,6 +359,8 @@ private:
 class CC_DLL Spawn : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Spawn)
+
     /** Helper constructor to create an array of spawned actions.
      * @code
      * When this function bound to the js or lua, the input params changed.
@@ -441,6 +450,8 @@ private:
 class CC_DLL RotateTo : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(RotateTo)
+
     /** 
      * Creates the action with separate rotation angles.
      *
@@ -518,6 +529,8 @@ private:
 class CC_DLL RotateBy : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(RotateBy)
+
     /** 
      * Creates the action.
      *
@@ -588,6 +601,8 @@ private:
 class CC_DLL MoveBy : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(MoveBy)
+
     /** 
      * Creates the action.
      *
@@ -643,6 +658,8 @@ private:
 class CC_DLL MoveTo : public MoveBy
 {
 public:
+    CC_DECLARE_OBJECT_POOL(MoveTo)
+
     /** 
      * Creates the action.
      * @param duration Duration time, in seconds.
@@ -1053,6 +1070,8 @@ private:
 class CC_DLL ScaleTo : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(ScaleTo)
+
     /** 
      * Creates the action with the same scale factor for X and Y.
      * @param duration Duration time, in seconds.
@@ -1136,6 +1155,8 @@ private:
 class CC_DLL ScaleBy : public ScaleTo
 {
 public:
+    CC_DECLARE_OBJECT_POOL(ScaleBy)
+
     /** 
      * Creates the action with the same scale factor for X and Y.
      * @param duration Duration time, in seconds.
@@ -1230,6 +1251,8 @@ private:
 class CC_DLL FadeTo : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(FadeTo)
+
     /** 
      * Creates an action with duration and opacity.
      * @param duration Duration time, in seconds.
@@ -1275,6 +1298,8 @@ private:
 class CC_DLL FadeIn : public FadeTo
 {
 public:
+    CC_DECLARE_OBJECT_POOL(FadeIn)
+
     /** 
      * Creates the action.
      * @param d Duration time, in seconds.
@@ -1310,6 +1335,8 @@ private:
 class CC_DLL FadeOut : public FadeTo
 {
 public:
+    CC_DECLARE_OBJECT_POOL(FadeOut)
+
     /** 
      * Creates the action.
      * @param d Duration time, in seconds.
@@ -1344,6 +1371,8 @@ private:
 class CC_DLL TintTo : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(TintTo)
+
     /** 
      * Creates an action with duration and color.
      * @param duration Duration time, in seconds.
@@ -1441,6 +1470,8 @@ private:
 class CC_DLL DelayTime : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(DelayTime)
+
     /** 
      * Creates the action.
      * @param d Duration time, in seconds.
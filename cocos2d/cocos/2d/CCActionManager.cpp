@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
 #include "base/uthash.h"
+#include "base/CCFrameTracer.h"
 
 NS_CC_BEGIN
 //
@@ -439,6 +440,8 @@ ssize_t ActionManager::getNumberOfRunningActions() const
 // main loop
 void ActionManager::update(float dt)
 {
+    CC_TRACE_SCOPE("ActionManager::update");
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -39,8 +39,10 @@ THE SOFTWARE.
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
+#include "2d/CCTweenSystem.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
+#include "2d/CCSpatialIndex.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
@@ -86,6 +88,7 @@ Node::Node()
 // lazy alloc
 , _localZOrder$Arrival(0LL)
 , _globalZOrder(0)
+, _spatialIndex(nullptr)
 , _parent(nullptr)
 // "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
 , _tag(Node::INVALID_TAG)
@@ -100,6 +103,7 @@ Node::Node()
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
 , _isTransitionFinished(false)
+, _reorderedChildrenOverflow(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
 #endif
@@ -172,6 +176,7 @@ Node::~Node()
     {
         child->_parent = nullptr;
     }
+    CC_SAFE_DELETE(_spatialIndex);
 
     removeAllComponents();
     
@@ -215,6 +220,7 @@ void Node::cleanup()
     
     // actions
     this->stopAllActions();
+    _director->getTweenSystem()->removeAllTweensFromTarget(this);
     // timers
     this->unscheduleAllCallbacks();
 
@@ -251,6 +257,7 @@ void Node::setSkewX(float skewX)
     
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 float Node::getSkewY() const
@@ -265,6 +272,7 @@ void Node::setSkewY(float skewY)
     
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 void Node::setLocalZOrder(std::int32_t z)
@@ -317,6 +325,7 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
     
     updateRotationQuat();
 }
@@ -334,6 +343,7 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -385,6 +395,7 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     updateRotation3D();
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -399,6 +410,7 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
     
     updateRotationQuat();
 }
@@ -415,6 +427,7 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
     
     updateRotationQuat();
 }
@@ -434,6 +447,7 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 /// scaleX getter
@@ -451,6 +465,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 /// scaleX setter
@@ -461,6 +476,7 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 /// scaleY getter
@@ -477,6 +493,7 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 /// scaleY getter
@@ -493,6 +510,7 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 
@@ -523,6 +541,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
     _usingNormalizedPosition = false;
 }
 
@@ -568,6 +587,7 @@ void Node::setPositionZ(float positionZ)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 
     _positionZ = positionZ;
 }
@@ -588,6 +608,7 @@ void Node::setPositionNormalized(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -630,6 +651,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        markSpatialIndexDirty();
     }
 }
 
@@ -647,6 +669,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        markSpatialIndexDirty();
     }
 }
 
@@ -661,6 +684,7 @@ void Node::setParent(Node * parent)
 {
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 /// isRelativeAnchorPoint getter
@@ -676,6 +700,7 @@ void Node::setIgnoreAnchorPointForPosition(bool newValue)
     {
         _ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        markSpatialIndexDirty();
     }
 }
 
@@ -976,6 +1001,9 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
     }
     
     this->insertChild(child, localZOrder);
+
+    if (_spatialIndex)
+        _spatialIndex->insert(child);
     
     if (setTag)
         child->setTag(tag);
@@ -1116,6 +1144,10 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
     }
     
     _children.clear();
+
+    if (_spatialIndex)
+        _spatialIndex->clear();
+    markSpatialIndexDirty();
 }
 
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
@@ -1147,6 +1179,10 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
     child->setParent(nullptr);
 
     _children.erase(childIndex);
+
+    if (_spatialIndex)
+        _spatialIndex->remove(child);
+    markSpatialIndexDirty();
 }
 
 
@@ -1161,7 +1197,7 @@ void Node::insertChild(Node* child, int z)
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
     _transformUpdated = true;
-    _reorderChildDirty = true;
+    markChildReordered(child);
     _children.pushBack(child);
     child->_setLocalZOrder(z);
 }
@@ -1169,21 +1205,114 @@ void Node::insertChild(Node* child, int z)
 void Node::reorderChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Child must be non-nil");
-    _reorderChildDirty = true;
+    markChildReordered(child);
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
 }
 
+// above this number of children added or reordered in a frame, sorting all the children is faster
+static const size_t MAX_INCREMENTALLY_SORTED_CHILDREN = 32;
+
+void Node::markChildReordered(Node* child)
+{
+    _reorderChildDirty = true;
+    if (_reorderedChildrenOverflow)
+        return;
+
+    if (_reorderedChildren.size() < MAX_INCREMENTALLY_SORTED_CHILDREN)
+    {
+        _reorderedChildren.push_back(child);
+    }
+    else
+    {
+        _reorderedChildren.clear();
+        _reorderedChildrenOverflow = true;
+    }
+}
+
 void Node::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        // the flag may have been set by a subclass without recording the children
+        if (_reorderedChildren.empty() || _reorderedChildrenOverflow)
+        {
+            sortNodes(_children);
+            _eventDispatcher->setDirtyForNode(this);
+        }
+        else
+        {
+            sortReorderedChildren();
+        }
+        _reorderedChildren.clear();
+        _reorderedChildrenOverflow = false;
         _reorderChildDirty = false;
-        _eventDispatcher->setDirtyForNode(this);
     }
 }
 
+void Node::sortReorderedChildren()
+{
+    // same order as sortNodes()
+#if CC_64BITS
+    auto less = [](Node* n1, Node* n2) {
+        return (n1->_localZOrder$Arrival < n2->_localZOrder$Arrival);
+    };
+#else
+    auto less = [](Node* n1, Node* n2) {
+        return (n1->_localZOrder == n2->_localZOrder && n1->_orderOfArrival < n2->_orderOfArrival) || n1->_localZOrder < n2->_localZOrder;
+    };
+#endif
+
+    // the recorded children are moved without retaining or releasing them, and the removed ones aren't found
+    auto begin = _children.begin();
+    auto end = _children.end();
+
+    if (_reorderedChildren.size() == 1)
+    {
+        // single binary insertion, only the children between the old and the new place are moved
+        auto iter = std::find(std::reverse_iterator<decltype(end)>(end), std::reverse_iterator<decltype(begin)>(begin), _reorderedChildren[0]).base();
+        if (iter == begin)
+            return;
+        --iter;
+
+        Node* child = *iter;
+        if (iter != begin && less(child, *(iter - 1)))
+        {
+            std::rotate(std::upper_bound(begin, iter, child, less), iter, iter + 1);
+        }
+        else if (iter + 1 != end && less(*(iter + 1), child))
+        {
+            std::rotate(iter, iter + 1, std::lower_bound(iter + 1, end, child, less));
+        }
+        else
+        {
+            return;
+        }
+        _eventDispatcher->setDirtyForNode(child);
+        return;
+    }
+
+    // move the recorded children after the sorted ones, sort them, and merge them in
+    auto sortedEnd = end;
+    for (auto child : _reorderedChildren)
+    {
+        auto iter = std::find(begin, sortedEnd, child);
+        if (iter != sortedEnd)
+        {
+            std::rotate(iter, iter + 1, sortedEnd);
+            --sortedEnd;
+        }
+    }
+    // only the moved children change of place relatively to the nodes that have listeners
+    for (auto iter = sortedEnd; iter != end; ++iter)
+    {
+        _eventDispatcher->setDirtyForNode(*iter);
+    }
+
+    std::sort(sortedEnd, end, less);
+    std::inplace_merge(begin, sortedEnd, end, less);
+}
+
 // MARK: draw / visit
 
 void Node::draw()
@@ -1214,6 +1343,7 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
             _position.x = _normalizedPosition.x * s.width;
             _position.y = _normalizedPosition.y * s.height;
             _transformUpdated = _transformDirty = _inverseDirty = true;
+            markSpatialIndexDirty();
             _normalizedPositionDirty = false;
         }
     }
@@ -1237,6 +1367,124 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     return flags;
 }
 
+void Node::setSpatialIndexEnabled(bool enabled, float cellSize)
+{
+    CC_SAFE_DELETE(_spatialIndex);
+    if (enabled)
+    {
+        _spatialIndex = new (std::nothrow) SpatialIndex(cellSize);
+        for (const auto& child : _children)
+        {
+            _spatialIndex->insert(child);
+        }
+    }
+}
+
+void Node::markSpatialIndexDirty()
+{
+    if (SpatialIndex::getInstanceCount() == 0)
+        return;
+
+    // the bounds in an index cover the whole subtree of a child, so every index above this node is outdated
+    for (Node* node = this; node->_parent; node = node->_parent)
+    {
+        if (node->_parent->_spatialIndex)
+            node->_parent->_spatialIndex->markDirty(node);
+    }
+}
+
+bool Node::visitIndexedChildren(Renderer* renderer, uint32_t flags, bool visibleByCamera)
+{
+    // like Renderer::checkVisibility(), only the default camera is culled
+    auto camera = Camera::getVisitingCamera();
+    auto scene = _director->getRunningScene();
+    if (!camera || !scene || camera != scene->getDefaultCamera())
+        return false;
+
+    // bring the corners of the visible area from clip space to the plane z = 0 of this node
+    Mat4 clipToNode = camera->getViewProjectionMatrix() * _modelViewTransform;
+    clipToNode.inverse();
+
+    const Size& winSize = _director->getWinSize();
+    const Vec2 origin = _director->getVisibleOrigin();
+    const Size visibleSize = _director->getVisibleSize();
+    const Vec2 corners[4] = {
+        origin,
+        Vec2(origin.x + visibleSize.width, origin.y),
+        Vec2(origin.x, origin.y + visibleSize.height),
+        Vec2(origin.x + visibleSize.width, origin.y + visibleSize.height),
+    };
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (const auto& corner : corners)
+    {
+        const float ndcX = corner.x / winSize.width * 2.0f - 1.0f;
+        const float ndcY = corner.y / winSize.height * 2.0f - 1.0f;
+        Vec4 nearPoint(ndcX, ndcY, -1.0f, 1.0f);
+        Vec4 farPoint(ndcX, ndcY, 1.0f, 1.0f);
+        clipToNode.transformVector(&nearPoint);
+        clipToNode.transformVector(&farPoint);
+        if (nearPoint.w == 0.0f || farPoint.w == 0.0f)
+            return false;
+        nearPoint *= 1.0f / nearPoint.w;
+        farPoint *= 1.0f / farPoint.w;
+
+        // the ray of this corner has to cross the plane of the node between the near and far planes
+        const float dz = farPoint.z - nearPoint.z;
+        if (std::abs(dz) < FLT_EPSILON)
+            return false;
+        const float t = -nearPoint.z / dz;
+        if (t < 0.0f || t > 1.0f)
+            return false;
+
+        const float x = nearPoint.x + (farPoint.x - nearPoint.x) * t;
+        const float y = nearPoint.y + (farPoint.y - nearPoint.y) * t;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    _spatialIndex->update();
+    // the culled children miss this transform update, they will catch up when they are visible again
+    if (flags & FLAGS_DIRTY_MASK)
+        _spatialIndex->invalidateTransforms();
+
+    auto& visibleChildren = _spatialIndex->query(Rect(minX, minY, maxX - minX, maxY - minY));
+    // same order as sortAllChildren()
+#if CC_64BITS
+    std::sort(visibleChildren.begin(), visibleChildren.end(), [](Node* n1, Node* n2) {
+        return (n1->_localZOrder$Arrival < n2->_localZOrder$Arrival);
+    });
+#else
+    std::sort(visibleChildren.begin(), visibleChildren.end(), [](Node* n1, Node* n2) {
+        return (n1->_localZOrder == n2->_localZOrder && n1->_orderOfArrival < n2->_orderOfArrival) || n1->_localZOrder < n2->_localZOrder;
+    });
+#endif
+
+    size_t i = 0;
+    const size_t count = visibleChildren.size();
+    // draw children zOrder < 0
+    for (; i < count; ++i)
+    {
+        auto node = visibleChildren[i];
+        if (node->_localZOrder >= 0)
+            break;
+        node->visit(renderer, _modelViewTransform, _spatialIndex->consumeTransformInvalidation(node) ? (flags | FLAGS_DIRTY_MASK) : flags);
+    }
+    // self draw
+    if (visibleByCamera)
+        this->draw(renderer, _modelViewTransform, flags);
+
+    for (; i < count; ++i)
+    {
+        auto node = visibleChildren[i];
+        node->visit(renderer, _modelViewTransform, _spatialIndex->consumeTransformInvalidation(node) ? (flags | FLAGS_DIRTY_MASK) : flags);
+    }
+
+    return true;
+}
+
 bool Node::isVisitableByVisitingCamera() const
 {
     auto camera = Camera::getVisitingCamera();
@@ -1264,7 +1512,11 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     int i = 0;
 
-    if(!_children.empty())
+    if(_spatialIndex && !_children.empty() && visitIndexedChildren(renderer, flags, visibleByCamera))
+    {
+        // the children outside of the visible area were culled
+    }
+    else if(!_children.empty())
     {
         sortAllChildren();
         // draw children zOrder < 0
@@ -1299,7 +1551,17 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
 Mat4 Node::transform(const Mat4& parentTransform)
 {
-    return parentTransform * this->getNodeToParentTransform();
+    const Mat4& nodeToParentTransform = this->getNodeToParentTransform();
+
+    // Most nodes of a 2D scene graph are plain affine transforms, which only need a 2x3 multiply
+    if (parentTransform.isAffine2D() && nodeToParentTransform.isAffine2D())
+    {
+        Mat4 ret;
+        Mat4::multiplyAffine2D(parentTransform, nodeToParentTransform, &ret);
+        return ret;
+    }
+
+    return parentTransform * nodeToParentTransform;
 }
 
 // MARK: events
@@ -1630,6 +1892,7 @@ void Node::resume()
 {
     _scheduler->resumeTarget(this);
     _actionManager->resumeTarget(this);
+    _director->getTweenSystem()->resumeTarget(this);
     _eventDispatcher->resumeEventListenersForTarget(this);
 }
 
@@ -1637,6 +1900,7 @@ void Node::pause()
 {
     _scheduler->pauseTarget(this);
     _actionManager->pauseTarget(this);
+    _director->getTweenSystem()->pauseTarget(this);
     _eventDispatcher->pauseEventListenersForTarget(this);
 }
 
@@ -1686,7 +1950,11 @@ Mat4 Node::getNodeToParentTransform(Node* ancestor) const
 
     for (Node *p = _parent;  p != nullptr && p != ancestor ; p = p->getParent())
     {
-        t = p->getNodeToParentTransform() * t;
+        const Mat4& parentTransform = p->getNodeToParentTransform();
+        if (parentTransform.isAffine2D() && t.isAffine2D())
+            Mat4::multiplyAffine2D(parentTransform, t, &t);
+        else
+            t = parentTransform * t;
     }
 
     return t;
@@ -1719,10 +1987,6 @@ const Mat4& Node::getNodeToParentTransform() const
         bool needsSkewMatrix = ( _skewX || _skewY );
 
         // Build Transform Matrix = translation * rotation * scale
-        Mat4 translation;
-        //move to anchor point first, then rotate
-        Mat4::createTranslation(x, y, z, &translation);
-        
         Mat4::createRotation(_rotationQuat, &_transform);
         
         if (_rotationZ_X != _rotationZ_Y)
@@ -1741,7 +2005,9 @@ const Mat4& Node::getNodeToParentTransform() const
             _transform.m[0] = cy * m0 - sx * m1, _transform.m[4] = cy * m4 - sx * m5, _transform.m[8] = cy * m8 - sx * m9;
             _transform.m[1] = sy * m0 + cx * m1, _transform.m[5] = sy * m4 + cx * m5, _transform.m[9] = sy * m8 + cx * m9;
         }
-        _transform = translation * _transform;
+        // The rotation has no translation part, so translation * rotation only fills in the last column.
+        //move to anchor point first, then rotate
+        _transform.m[12] = x, _transform.m[13] = y, _transform.m[14] = z;
 
         if (_scaleX != 1.f)
         {
@@ -1756,20 +2022,19 @@ const Mat4& Node::getNodeToParentTransform() const
             _transform.m[8] *= _scaleZ, _transform.m[9] *= _scaleZ, _transform.m[10] *= _scaleZ;
         }
         
-        // FIXME:: Try to inline skew
-        // If skew is needed, apply skew and then anchor point
+        // If skew is needed, apply skew and then anchor point.
+        // Post-multiplying by the skew matrix only mixes the first two columns.
         if (needsSkewMatrix)
         {
-            float skewMatArray[16] =
+            float skewX = tanf(CC_DEGREES_TO_RADIANS(_skewX));
+            float skewY = tanf(CC_DEGREES_TO_RADIANS(_skewY));
+
+            for (int i = 0; i < 4; ++i)
             {
-                1, (float)tanf(CC_DEGREES_TO_RADIANS(_skewY)), 0, 0,
-                (float)tanf(CC_DEGREES_TO_RADIANS(_skewX)), 1, 0, 0,
-                0,  0,  1, 0,
-                0,  0,  0, 1
-            };
-            Mat4 skewMatrix(skewMatArray);
-            
-            _transform = _transform * skewMatrix;
+                float c0 = _transform.m[i], c1 = _transform.m[4 + i];
+                _transform.m[i] = c0 + skewY * c1;
+                _transform.m[4 + i] = skewX * c0 + c1;
+            }
         }
 
         // adjust anchor point
@@ -1808,6 +2073,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    markSpatialIndexDirty();
 
     if (_additionalTransform)
         // _additionalTransform[1] has a copy of lastest transform
@@ -1841,6 +2107,7 @@ void Node::setAdditionalTransform(const Mat4* additionalTransform)
         _additionalTransform[0] = *additionalTransform;
     }
     _transformUpdated = _additionalTransformDirty = _inverseDirty = true;
+    markSpatialIndexDirty();
 }
 
 void Node::setAdditionalTransform(const Mat4& additionalTransform)
@@ -63,6 +63,7 @@ class GLProgramState;
 class Material;
 class Camera;
 class PhysicsBody;
+class SpatialIndex;
 
 /**
  * @addtogroup _2d
@@ -957,6 +958,32 @@ public:
 #endif
     }
 
+    /**
+     * Enables or disables the spatial index of the children.
+     *
+     * When it is enabled, the children are kept in a grid by the bounding box of their subtree, and visit() only
+     * visits the children that intersect the visible area of the default camera, skipping the others together
+     * with their whole subtree. The grid is in the coordinates of this node, so moving this node doesn't
+     * re-index anything: only the children whose subtree was moved, resized, added or removed are updated.
+     * Useful for big scrolling worlds where most of the children are off-screen.
+     *
+     * @note Leaf nodes without content size (eg: DrawNode, ParticleSystem) are never culled.
+     * @param enabled Whether the spatial index is enabled.
+     * @param cellSize Size of the cells of the grid, in points of this node.
+     * @since v3.17
+     */
+    void setSpatialIndexEnabled(bool enabled, float cellSize = 256.0f);
+    /**
+     * Returns whether the spatial index of the children is enabled.
+     * @since v3.17
+     */
+    bool isSpatialIndexEnabled() const { return _spatialIndex != nullptr; }
+    /**
+     * Returns the spatial index of the children, or nullptr if it is disabled.
+     * @since v3.17
+     */
+    SpatialIndex* getSpatialIndex() const { return _spatialIndex; }
+
     /// @} end of Children and Parent
     
     /// @{
@@ -1871,6 +1898,12 @@ protected:
     /// helper that reorder a child
     void insertChild(Node* child, int z);
 
+    /// Records a child whose order changed, to sort it incrementally in sortAllChildren().
+    void markChildReordered(Node* child);
+
+    /// Moves the children recorded by markChildReordered() to their place, the other children must be sorted.
+    void sortReorderedChildren();
+
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
@@ -1891,6 +1924,11 @@ protected:
     
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
+
+    // tells the spatial indices of the ancestors that the bounds of this subtree changed
+    void markSpatialIndexDirty();
+    // visits the children inside the visible area only. Returns false if the spatial index can't be used with the visiting camera
+    bool visitIndexedChildren(Renderer* renderer, uint32_t flags, bool visibleByCamera);
     
     // update quaternion from Rotation3D
     void updateRotationQuat();
@@ -1964,6 +2002,7 @@ protected:
     static std::uint32_t s_globalOrderOfArrival;
 
     Vector<Node*> _children;        ///< array of children nodes
+    SpatialIndex* _spatialIndex;    ///< spatial index of the children, nullptr unless enabled
     Node *_parent;                  ///< weak reference to parent node
     Director* _director;            //cached director pointer to improve rendering performance
     int _tag;                       ///< a tag. Can be any number you assigned just to identify this node
@@ -1991,6 +2030,8 @@ protected:
 
     bool _reorderChildDirty;          ///< children order dirty flag
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
+    bool _reorderedChildrenOverflow;  ///< too many children were reordered to sort them incrementally
+    std::vector<Node*> _reorderedChildren; ///< children added or reordered since the last sortAllChildren()
 
 #if CC_ENABLE_SCRIPT_BINDING
     int _scriptHandler;               ///< script handler for onEnter() & onExit(), used in Javascript binding and Lua binding.
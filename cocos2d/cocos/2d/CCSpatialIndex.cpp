@@ -0,0 +1,277 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+// entries covering more cells than this are kept in a separate list instead of in the grid
+static const int MAX_CELLS_PER_ENTRY = 64;
+
+int SpatialIndex::s_instanceCount = 0;
+
+SpatialIndex::SpatialIndex(float cellSize)
+: _cellSize(cellSize > 0 ? cellSize : 256.0f)
+, _queryStamp(0)
+, _transformEpoch(0)
+{
+    ++s_instanceCount;
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    --s_instanceCount;
+}
+
+void SpatialIndex::insert(Node* child)
+{
+    if (_entries.find(child) != _entries.end())
+    {
+        markDirty(child);
+        return;
+    }
+
+    auto& entry = _entries[child];
+    entry.node = child;
+    entry.bounds = Rect::ZERO;
+    entry.minCellX = entry.minCellY = entry.maxCellX = entry.maxCellY = 0;
+    entry.inCells = false;
+    entry.unbounded = false;
+    entry.dirty = false;
+    entry.queryStamp = _queryStamp;
+    // it was never visited: its transform has to be calculated
+    entry.transformEpoch = _transformEpoch - 1;
+
+    _largeEntries.push_back(&entry);
+    markDirty(child);
+}
+
+void SpatialIndex::remove(Node* child)
+{
+    auto it = _entries.find(child);
+    if (it == _entries.end())
+        return;
+
+    Entry* entry = &it->second;
+    removeFromCells(entry);
+    if (entry->dirty)
+    {
+        _dirtyEntries.erase(std::find(_dirtyEntries.begin(), _dirtyEntries.end(), entry));
+    }
+    _entries.erase(it);
+}
+
+void SpatialIndex::clear()
+{
+    _entries.clear();
+    _cells.clear();
+    _largeEntries.clear();
+    _dirtyEntries.clear();
+}
+
+void SpatialIndex::markDirty(Node* child)
+{
+    auto it = _entries.find(child);
+    if (it != _entries.end() && !it->second.dirty)
+    {
+        it->second.dirty = true;
+        _dirtyEntries.push_back(&it->second);
+    }
+}
+
+void SpatialIndex::update()
+{
+    for (auto entry : _dirtyEntries)
+    {
+        removeFromCells(entry);
+        entry->bounds = calculateSubtreeBounds(entry->node, &entry->unbounded);
+        addToCells(entry);
+        entry->dirty = false;
+    }
+    _dirtyEntries.clear();
+}
+
+std::vector<Node*>& SpatialIndex::query(const Rect& rect)
+{
+    ++_queryStamp;
+    _queryResult.clear();
+
+    auto visit = [&](Entry* entry) {
+        if (entry->queryStamp != _queryStamp && (entry->unbounded || entry->bounds.intersectsRect(rect)))
+        {
+            entry->queryStamp = _queryStamp;
+            _queryResult.push_back(entry->node);
+        }
+    };
+
+    const int minX = (int)std::floor(rect.getMinX() / _cellSize);
+    const int minY = (int)std::floor(rect.getMinY() / _cellSize);
+    const int maxX = (int)std::floor(rect.getMaxX() / _cellSize);
+    const int maxY = (int)std::floor(rect.getMaxY() / _cellSize);
+    const double rangeCells = ((double)maxX - minX + 1) * ((double)maxY - minY + 1);
+
+    if (rangeCells > _cells.size())
+    {
+        // zoomed out: cheaper to walk the existing cells than the range
+        for (auto& cell : _cells)
+        {
+            for (auto entry : cell.second)
+                visit(entry);
+        }
+    }
+    else
+    {
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                auto it = _cells.find(cellKey(x, y));
+                if (it == _cells.end())
+                    continue;
+                for (auto entry : it->second)
+                    visit(entry);
+            }
+        }
+    }
+
+    for (auto entry : _largeEntries)
+        visit(entry);
+
+    return _queryResult;
+}
+
+bool SpatialIndex::consumeTransformInvalidation(Node* child)
+{
+    auto it = _entries.find(child);
+    if (it == _entries.end() || it->second.transformEpoch == _transformEpoch)
+        return false;
+
+    it->second.transformEpoch = _transformEpoch;
+    return true;
+}
+
+static void addNodeBounds(Node* node, const Mat4& transform, Rect& bounds, bool& hasBounds, bool* unbounded)
+{
+    const Size& size = node->getContentSize();
+    auto& children = node->getChildren();
+
+    if (size.width != 0 || size.height != 0)
+    {
+        Rect rect = RectApplyTransform(Rect(0, 0, size.width, size.height), transform);
+        bounds = hasBounds ? bounds.unionWithRect(rect) : rect;
+        hasBounds = true;
+    }
+    else if (children.empty())
+    {
+        // nothing tells where it draws (DrawNode, ParticleSystem...)
+        *unbounded = true;
+        return;
+    }
+
+    for (const auto& child : children)
+    {
+        addNodeBounds(child, transform * child->getNodeToParentTransform(), bounds, hasBounds, unbounded);
+        if (*unbounded)
+            return;
+    }
+}
+
+Rect SpatialIndex::calculateSubtreeBounds(Node* child, bool* unbounded)
+{
+    Rect bounds;
+    bool hasBounds = false;
+    *unbounded = false;
+    addNodeBounds(child, child->getNodeToParentTransform(), bounds, hasBounds, unbounded);
+    return bounds;
+}
+
+void SpatialIndex::addToCells(Entry* entry)
+{
+    if (!entry->unbounded)
+    {
+        entry->minCellX = (int)std::floor(entry->bounds.getMinX() / _cellSize);
+        entry->minCellY = (int)std::floor(entry->bounds.getMinY() / _cellSize);
+        entry->maxCellX = (int)std::floor(entry->bounds.getMaxX() / _cellSize);
+        entry->maxCellY = (int)std::floor(entry->bounds.getMaxY() / _cellSize);
+
+        const double cells = ((double)entry->maxCellX - entry->minCellX + 1) * ((double)entry->maxCellY - entry->minCellY + 1);
+        if (cells <= MAX_CELLS_PER_ENTRY)
+        {
+            for (int y = entry->minCellY; y <= entry->maxCellY; ++y)
+            {
+                for (int x = entry->minCellX; x <= entry->maxCellX; ++x)
+                {
+                    _cells[cellKey(x, y)].push_back(entry);
+                }
+            }
+            entry->inCells = true;
+            return;
+        }
+    }
+
+    _largeEntries.push_back(entry);
+    entry->inCells = false;
+}
+
+void SpatialIndex::removeFromCells(Entry* entry)
+{
+    if (!entry->inCells)
+    {
+        auto it = std::find(_largeEntries.begin(), _largeEntries.end(), entry);
+        if (it != _largeEntries.end())
+        {
+            *it = _largeEntries.back();
+            _largeEntries.pop_back();
+        }
+        return;
+    }
+
+    for (int y = entry->minCellY; y <= entry->maxCellY; ++y)
+    {
+        for (int x = entry->minCellX; x <= entry->maxCellX; ++x)
+        {
+            auto cell = _cells.find(cellKey(x, y));
+            if (cell == _cells.end())
+                continue;
+
+            auto& entries = cell->second;
+            auto it = std::find(entries.begin(), entries.end(), entry);
+            if (it != entries.end())
+            {
+                *it = entries.back();
+                entries.pop_back();
+            }
+            if (entries.empty())
+                _cells.erase(cell);
+        }
+    }
+    entry->inCells = false;
+}
+
+NS_CC_END
@@ -0,0 +1,136 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCSPATIALINDEX_H__
+#define __CCSPATIALINDEX_H__
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "math/CCGeometry.h"
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Node;
+
+/** @class SpatialIndex
+ * @brief A uniform grid of the bounding boxes of the children of a node.
+ *
+ * The bounds of each child cover its whole subtree, expressed in the coordinates of the node that owns the index.
+ * Moving the owner (eg: scrolling a world layer) doesn't invalidate them, only the children whose subtree
+ * changed are re-indexed.
+ * Children that draw outside of their content size (leaf nodes without content size, like DrawNode or
+ * ParticleSystem) are considered unbounded and are always returned by the queries.
+ *
+ * It is created by Node::setSpatialIndexEnabled(), there is no need to use it directly.
+ * @since v3.17
+ */
+class CC_DLL SpatialIndex
+{
+public:
+    /** Creates an index whose cells are `cellSize` x `cellSize` points. */
+    explicit SpatialIndex(float cellSize);
+    ~SpatialIndex();
+
+    /** Adds a child to the index. Its bounds are calculated the next time the index is updated. */
+    void insert(Node* child);
+    /** Removes a child from the index. */
+    void remove(Node* child);
+    /** Removes all the children from the index. */
+    void clear();
+    /** Marks the bounds of a child as outdated. */
+    void markDirty(Node* child);
+    /** Recalculates the bounds of the children marked as dirty. */
+    void update();
+
+    /** Returns the children whose bounds intersect `rect`, and the unbounded ones.
+     * Each child is returned only once, in no particular order.
+     * The returned vector is reused by the next query.
+     */
+    std::vector<Node*>& query(const Rect& rect);
+
+    /** Returns the number of children in the index. */
+    size_t getEntryCount() const { return _entries.size(); }
+    /** Returns the number of non-empty cells. */
+    size_t getCellCount() const { return _cells.size(); }
+    /** Returns the size of the cells, in points. */
+    float getCellSize() const { return _cellSize; }
+
+    /** Invalidates the transforms of the children: the ones that are culled keep a stale transform
+     * until they are visited again, and then they have to recalculate it.
+     */
+    void invalidateTransforms() { ++_transformEpoch; }
+    /** Returns whether a child has to recalculate its transform because of invalidateTransforms(),
+     * and marks it as up to date.
+     */
+    bool consumeTransformInvalidation(Node* child);
+
+    /** Returns the number of alive indices. Used by Node to skip the notifications when no index exists. */
+    static int getInstanceCount() { return s_instanceCount; }
+
+protected:
+    struct Entry
+    {
+        Node* node;
+        Rect bounds;
+        int minCellX, minCellY, maxCellX, maxCellY;
+        bool inCells;      // stored in _cells, otherwise it is in _largeEntries
+        bool unbounded;    // draws outside of its bounds, always visible
+        bool dirty;
+        uint32_t queryStamp;
+        uint32_t transformEpoch;
+    };
+
+    static int64_t cellKey(int x, int y) { return (int64_t)(((uint64_t)(uint32_t)x << 32) | (uint32_t)y); }
+    static Rect calculateSubtreeBounds(Node* child, bool* unbounded);
+
+    void addToCells(Entry* entry);
+    void removeFromCells(Entry* entry);
+
+    float _cellSize;
+    std::unordered_map<Node*, Entry> _entries;
+    std::unordered_map<int64_t, std::vector<Entry*>> _cells;
+    // entries that are not in the cells: unbounded, or covering too many cells
+    std::vector<Entry*> _largeEntries;
+    std::vector<Entry*> _dirtyEntries;
+    std::vector<Node*> _queryResult;
+    uint32_t _queryStamp;
+    uint32_t _transformEpoch;
+
+    static int s_instanceCount;
+};
+
+NS_CC_END
+
+// end of _2d group
+/// @}
+
+#endif // __CCSPATIALINDEX_H__
@@ -35,14 +35,18 @@ THE SOFTWARE.
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_OBJECT_POOL(Sprite, 128, lockless_semantics)
+
 // MARK: create, init, dealloc
 Sprite* Sprite::createWithTexture(Texture2D *texture)
 {
@@ -176,6 +180,17 @@ bool Sprite::initWithFile(const std::string& filename)
     _fileName = filename;
     _fileType = 0;
 
+    // small images are shared with other sprites through the dynamic atlas, if it is enabled
+    auto dynamicAtlas = _director->getTextureCache()->getDynamicAtlas();
+    if (dynamicAtlas)
+    {
+        SpriteFrame *frame = dynamicAtlas->getSpriteFrame(filename);
+        if (frame)
+        {
+            return initWithSpriteFrame(frame);
+        }
+    }
+
     Texture2D *texture = _director->getTextureCache()->addImage(filename);
     if (texture)
     {
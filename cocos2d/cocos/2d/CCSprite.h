@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "2d/CCAutoPolygon.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -96,6 +97,8 @@ struct transformValues_;
 class CC_DLL Sprite : public Node, public TextureProtocol
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Sprite)
+
     enum class RenderMode {
         QUAD,
         POLYGON,
@@ -31,11 +31,15 @@ THE SOFTWARE.
 #include "2d/CCSpriteFrameCache.h"
 
 #include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <xxhash.h>
 
 
 #include "2d/CCSprite.h"
 #include "2d/CCAutoPolygon.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCPlistParser.h"
 #include "base/CCNS.h"
 #include "base/ccMacros.h"
 #include "base/ccUTF8.h"
@@ -48,6 +52,413 @@ using namespace std;
 
 NS_CC_BEGIN
 
+namespace
+{
+    /** A frame as read from the .plist, before the metadata tells which of the formats it is in. */
+    struct SheetFrame
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstAlias;
+        uint32_t aliasCount;
+        int polygon;
+
+        // format 0
+        float x, y, width, height, offsetX, offsetY;
+        int originalWidth, originalHeight;
+
+        // format 1 and 2
+        Rect frame;
+        Vec2 offset;
+        Size sourceSize;
+        bool rotated;
+
+        // format 3
+        Size spriteSize;
+        Vec2 spriteOffset;
+        Size spriteSourceSize;
+        Rect textureRect;
+        bool textureRotated;
+        bool hasAnchor;
+        Vec2 anchor;
+    };
+
+    struct SheetAlias
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    struct SheetPolygon
+    {
+        std::string vertices;
+        std::string verticesUV;
+        std::string triangles;
+    };
+
+    inline uint32_t hashName(const char* name, size_t length)
+    {
+        return XXH32(name, static_cast<int>(length), 0);
+    }
+
+    inline bool hasSuffix(const char* str, size_t length, const char* suffix, size_t suffixLength)
+    {
+        return length >= suffixLength && memcmp(str + length - suffixLength, suffix, suffixLength) == 0;
+    }
+
+    // Reads the numbers of strings like "{1,2}" or "{{1,2},{3,4}}" the way RectFromString() does,
+    // without copying the string around
+    int parseFloats(const char* str, size_t length, float* out, int count)
+    {
+        const char* end = str + length;
+        int n = 0;
+        while (str < end && n < count)
+        {
+            if (!((*str >= '0' && *str <= '9') || *str == '-' || *str == '+' || *str == '.'))
+            {
+                ++str;
+                continue;
+            }
+
+            char number[32];
+            size_t numberLength = 0;
+            const char* dot = nullptr;
+            while (str < end && numberLength < sizeof(number) - 1
+                   && ((*str >= '0' && *str <= '9') || *str == '-' || *str == '+' || *str == '.' || *str == 'e' || *str == 'E'))
+            {
+                if (*str == '.' && !dot)
+                    dot = str;
+                // only 7 digits after '.' are kept, as utils::atof() does
+                if (!dot || str - dot <= 7)
+                    number[numberLength++] = *str;
+                ++str;
+            }
+            number[numberLength] = '\0';
+            out[n++] = static_cast<float>(atof(number));
+        }
+        return n;
+    }
+
+    inline bool boolFromString(const char* value, size_t length)
+    {
+        return !((length == 1 && value[0] == '0') || (length == 5 && memcmp(value, "false", 5) == 0));
+    }
+}
+
+/** The contents of a sheet .plist, read in a single pass. */
+struct SpriteFrameCache::SheetData
+{
+    SheetData() : format(0), hasFrames(false) {}
+
+    int format;
+    bool hasFrames;
+    Size textureSize;
+    std::string textureFileName;
+    std::string pixelFormat;
+    std::string names;
+    std::vector<SheetFrame> frames;
+    std::vector<SheetAlias> aliases;
+    std::vector<SheetPolygon> polygons;
+};
+
+namespace
+{
+    /** Fills SheetData from the events of PlistParser, keeping only the keys SpriteFrameCache reads. */
+    template <typename Sheet>
+    class SheetReader : public PlistVisitor
+    {
+    public:
+        explicit SheetReader(Sheet& sheet)
+        : _sheet(sheet)
+        {
+        }
+
+        virtual void startDict() override
+        {
+            Context context = Context::SKIP;
+            if (_contexts.empty())
+            {
+                context = Context::ROOT;
+            }
+            else if (_contexts.back() == Context::ROOT)
+            {
+                if (_key == "frames")
+                {
+                    context = Context::FRAMES;
+                    _sheet.hasFrames = true;
+                }
+                else if (_key == "metadata")
+                {
+                    context = Context::METADATA;
+                }
+            }
+            else if (_contexts.back() == Context::FRAMES)
+            {
+                context = Context::FRAME;
+                _sheet.frames.emplace_back();
+                SheetFrame& frame = _sheet.frames.back();
+                frame.nameOffset = static_cast<uint32_t>(_sheet.names.size());
+                frame.nameLength = static_cast<uint32_t>(_key.size());
+                frame.firstAlias = static_cast<uint32_t>(_sheet.aliases.size());
+                frame.polygon = -1;
+                _sheet.names.append(_key);
+            }
+            _contexts.push_back(context);
+        }
+
+        virtual void endDict() override
+        {
+            _contexts.pop_back();
+        }
+
+        virtual void startArray() override
+        {
+            bool aliases = !_contexts.empty() && _contexts.back() == Context::FRAME && _key == "aliases";
+            _contexts.push_back(aliases ? Context::ALIASES : Context::SKIP);
+        }
+
+        virtual void endArray() override
+        {
+            _contexts.pop_back();
+        }
+
+        virtual void key(const char* key, size_t length) override
+        {
+            _key.assign(key, length);
+        }
+
+        virtual void stringValue(const char* value, size_t length) override
+        {
+            if (_contexts.empty())
+                return;
+
+            switch (_contexts.back())
+            {
+            case Context::FRAME:
+                frameString(_sheet.frames.back(), value, length);
+                break;
+            case Context::ALIASES:
+                {
+                    SheetAlias alias;
+                    alias.nameOffset = static_cast<uint32_t>(_sheet.names.size());
+                    alias.nameLength = static_cast<uint32_t>(length);
+                    _sheet.names.append(value, length);
+                    _sheet.aliases.push_back(alias);
+                    _sheet.frames.back().aliasCount++;
+                }
+                break;
+            case Context::METADATA:
+                if (_key == "textureFileName")
+                {
+                    _sheet.textureFileName.assign(value, length);
+                }
+                else if (_key == "pixelFormat")
+                {
+                    _sheet.pixelFormat.assign(value, length);
+                }
+                else if (_key == "size")
+                {
+                    float size[2] = { 0, 0 };
+                    parseFloats(value, length, size, 2);
+                    _sheet.textureSize = Size(size[0], size[1]);
+                }
+                else if (_key == "format")
+                {
+                    _sheet.format = atoi(std::string(value, length).c_str());
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        virtual void integerValue(long long value) override
+        {
+            number(static_cast<double>(value));
+        }
+
+        virtual void realValue(double value) override
+        {
+            number(value);
+        }
+
+        virtual void boolValue(bool value) override
+        {
+            if (_contexts.empty() || _contexts.back() != Context::FRAME)
+                return;
+
+            SheetFrame& frame = _sheet.frames.back();
+            if (_key == "rotated")
+                frame.rotated = value;
+            else if (_key == "textureRotated")
+                frame.textureRotated = value;
+        }
+
+    private:
+        enum class Context
+        {
+            ROOT,
+            FRAMES,
+            FRAME,
+            ALIASES,
+            METADATA,
+            SKIP
+        };
+
+        void number(double value)
+        {
+            if (_contexts.empty())
+                return;
+
+            if (_contexts.back() == Context::METADATA)
+            {
+                if (_key == "format")
+                    _sheet.format = static_cast<int>(value);
+                return;
+            }
+            if (_contexts.back() != Context::FRAME)
+                return;
+
+            SheetFrame& frame = _sheet.frames.back();
+            float f = static_cast<float>(value);
+            if (_key == "x")                    frame.x = f;
+            else if (_key == "y")               frame.y = f;
+            else if (_key == "width")           frame.width = f;
+            else if (_key == "height")          frame.height = f;
+            else if (_key == "offsetX")         frame.offsetX = f;
+            else if (_key == "offsetY")         frame.offsetY = f;
+            else if (_key == "originalWidth")   frame.originalWidth = static_cast<int>(value);
+            else if (_key == "originalHeight")  frame.originalHeight = static_cast<int>(value);
+            else if (_key == "rotated")         frame.rotated = value != 0;
+            else if (_key == "textureRotated")  frame.textureRotated = value != 0;
+        }
+
+        void frameString(SheetFrame& frame, const char* value, size_t length)
+        {
+            float v[4] = { 0, 0, 0, 0 };
+            if (_key == "frame")
+            {
+                parseFloats(value, length, v, 4);
+                frame.frame.setRect(v[0], v[1], v[2], v[3]);
+            }
+            else if (_key == "offset")
+            {
+                parseFloats(value, length, v, 2);
+                frame.offset.set(v[0], v[1]);
+            }
+            else if (_key == "sourceSize")
+            {
+                parseFloats(value, length, v, 2);
+                frame.sourceSize.setSize(v[0], v[1]);
+            }
+            else if (_key == "spriteSize")
+            {
+                parseFloats(value, length, v, 2);
+                frame.spriteSize.setSize(v[0], v[1]);
+            }
+            else if (_key == "spriteOffset")
+            {
+                parseFloats(value, length, v, 2);
+                frame.spriteOffset.set(v[0], v[1]);
+            }
+            else if (_key == "spriteSourceSize")
+            {
+                parseFloats(value, length, v, 2);
+                frame.spriteSourceSize.setSize(v[0], v[1]);
+            }
+            else if (_key == "textureRect")
+            {
+                parseFloats(value, length, v, 4);
+                frame.textureRect.setRect(v[0], v[1], v[2], v[3]);
+            }
+            else if (_key == "anchor")
+            {
+                parseFloats(value, length, v, 2);
+                frame.anchor.set(v[0], v[1]);
+                frame.hasAnchor = true;
+            }
+            else if (_key == "rotated")
+            {
+                frame.rotated = boolFromString(value, length);
+            }
+            else if (_key == "textureRotated")
+            {
+                frame.textureRotated = boolFromString(value, length);
+            }
+            else if (_key == "vertices" || _key == "verticesUV" || _key == "triangles")
+            {
+                if (frame.polygon < 0)
+                {
+                    frame.polygon = static_cast<int>(_sheet.polygons.size());
+                    _sheet.polygons.emplace_back();
+                }
+                SheetPolygon& polygon = _sheet.polygons[frame.polygon];
+                std::string& list = _key == "vertices" ? polygon.vertices : (_key == "verticesUV" ? polygon.verticesUV : polygon.triangles);
+                list.assign(value, length);
+            }
+        }
+
+        Sheet& _sheet;
+        std::vector<Context> _contexts;
+        std::string _key;
+    };
+}
+
+namespace
+{
+    /** Replays a ValueMap read by FileUtils::getValueMapFromFile() as the events of PlistParser. */
+    void visitValue(const Value& value, PlistVisitor* visitor);
+
+    void visitValueMap(const ValueMap& dict, PlistVisitor* visitor)
+    {
+        visitor->startDict();
+        for (const auto& entry : dict)
+        {
+            visitor->key(entry.first.c_str(), entry.first.size());
+            visitValue(entry.second, visitor);
+        }
+        visitor->endDict();
+    }
+
+    void visitValue(const Value& value, PlistVisitor* visitor)
+    {
+        switch (value.getType())
+        {
+        case Value::Type::MAP:
+            visitValueMap(value.asValueMap(), visitor);
+            break;
+        case Value::Type::VECTOR:
+            visitor->startArray();
+            for (const auto& item : value.asValueVector())
+            {
+                visitValue(item, visitor);
+            }
+            visitor->endArray();
+            break;
+        case Value::Type::STRING:
+            {
+                const std::string& str = value.asString();
+                visitor->stringValue(str.c_str(), str.size());
+            }
+            break;
+        case Value::Type::INTEGER:
+        case Value::Type::UNSIGNED:
+        case Value::Type::BYTE:
+            visitor->integerValue(value.asInt());
+            break;
+        case Value::Type::FLOAT:
+        case Value::Type::DOUBLE:
+            visitor->realValue(value.asDouble());
+            break;
+        case Value::Type::BOOLEAN:
+            visitor->boolValue(value.asBool());
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
 SpriteFrameCache* SpriteFrameCache::getInstance()
@@ -68,14 +479,34 @@ void SpriteFrameCache::destroyInstance()
 
 bool SpriteFrameCache::init()
 {
-    _spriteFrames.reserve(20);
-    _spriteFramesAliases.reserve(20);
+    // atlas 0 holds the frames added by addSpriteFrame(), it has no texture and is never removed
+    auto manual = new (std::nothrow) Atlas();
+    manual->texture = nullptr;
+    manual->frameCount = 0;
+    _atlases.push_back(manual);
+
+    _frameSlots.assign(64, Slot{ 0, EMPTY_SLOT, 0 });
+    _aliasSlots.assign(16, Slot{ 0, EMPTY_SLOT, 0 });
+    _frameSlotCount = 0;
+    _aliasSlotCount = 0;
     _loadedFileNames = new std::set<std::string>();
     return true;
 }
 
 SpriteFrameCache::~SpriteFrameCache()
 {
+    for (uint32_t i = 0; i < _atlases.size(); ++i)
+    {
+        if (_atlases[i])
+        {
+            for (auto& def : _atlases[i]->frames)
+            {
+                CC_SAFE_RELEASE(def.spriteFrame);
+            }
+            CC_SAFE_RELEASE(_atlases[i]->texture);
+            delete _atlases[i];
+        }
+    }
     CC_SAFE_DELETE(_loadedFileNames);
 }
 
@@ -136,180 +567,466 @@ void SpriteFrameCache::initializePolygonInfo(const Size &textureSize,
     info.setRect(Rect(0, 0, spriteSize.width, spriteSize.height));
 }
 
-void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
+uint32_t SpriteFrameCache::addAtlas(const std::string& plist, Texture2D* texture)
 {
-    /*
-    Supported Zwoptex Formats:
+    auto atlas = new (std::nothrow) Atlas();
+    atlas->plist = plist;
+    atlas->texture = texture;
+    atlas->frameCount = 0;
+    CC_SAFE_RETAIN(texture);
+
+    // reuse the index of a removed atlas, atlas 0 is never removed
+    uint32_t index = 1;
+    while (index < _atlases.size() && _atlases[index])
+    {
+        ++index;
+    }
 
-    ZWTCoordinatesFormatOptionXMLLegacy = 0, // Flash Version
-    ZWTCoordinatesFormatOptionXML1_0 = 1, // Desktop Version 0.0 - 0.4b
-    ZWTCoordinatesFormatOptionXML1_1 = 2, // Desktop Version 1.0.0 - 1.0.1
-    ZWTCoordinatesFormatOptionXML1_2 = 3, // Desktop Version 1.0.2+
+    if (index < _atlases.size())
+        _atlases[index] = atlas;
+    else
+        _atlases.push_back(atlas);
+    return index;
+}
 
-    Version 3 with TexturePacker 4.0 polygon mesh packing
-    */
+const SpriteFrameCache::Slot* SpriteFrameCache::findSlot(const std::vector<Slot>& slots, const char* name, size_t length, uint32_t hash, bool alias) const
+{
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i].atlas != EMPTY_SLOT; i = (i + 1) & mask)
+    {
+        const Slot& slot = slots[i];
+        if (slot.hash != hash)
+            continue;
+
+        const Atlas* atlas = _atlases[slot.atlas];
+        uint32_t nameOffset, nameLength;
+        if (alias)
+        {
+            nameOffset = atlas->aliases[slot.index].nameOffset;
+            nameLength = atlas->aliases[slot.index].nameLength;
+        }
+        else
+        {
+            nameOffset = atlas->frames[slot.index].nameOffset;
+            nameLength = atlas->frames[slot.index].nameLength;
+        }
 
-    if (dictionary["frames"].getType() != cocos2d::Value::Type::MAP)
+        if (nameLength == length && memcmp(atlas->names.data() + nameOffset, name, length) == 0)
+            return &slot;
+    }
+    return nullptr;
+}
+
+void SpriteFrameCache::insertSlot(std::vector<Slot>& slots, size_t& slotCount, uint32_t hash, uint32_t atlasIndex, uint32_t index)
+{
+    // keep the table at most half full
+    if ((slotCount + 1) * 2 > slots.size())
+    {
+        std::vector<Slot> grown(slots.size() * 2, Slot{ 0, EMPTY_SLOT, 0 });
+        size_t grownMask = grown.size() - 1;
+        for (const auto& slot : slots)
+        {
+            if (slot.atlas == EMPTY_SLOT)
+                continue;
+            size_t i = slot.hash & grownMask;
+            while (grown[i].atlas != EMPTY_SLOT)
+                i = (i + 1) & grownMask;
+            grown[i] = slot;
+        }
+        slots.swap(grown);
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].atlas != EMPTY_SLOT)
+        i = (i + 1) & mask;
+    slots[i] = Slot{ hash, atlasIndex, index };
+    ++slotCount;
+}
+
+void SpriteFrameCache::eraseSlot(std::vector<Slot>& slots, size_t& slotCount, uint32_t hash, uint32_t atlasIndex, uint32_t index)
+{
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].atlas != EMPTY_SLOT && (slots[i].atlas != atlasIndex || slots[i].index != index))
+        i = (i + 1) & mask;
+    if (slots[i].atlas == EMPTY_SLOT)
         return;
 
-    ValueMap& framesDict = dictionary["frames"].asValueMap();
-    int format = 0;
+    // shift back the slots that probed past this one, so no tombstone is needed
+    size_t j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (slots[j].atlas == EMPTY_SLOT)
+            break;
+        size_t home = slots[j].hash & mask;
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable)
+        {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i].atlas = EMPTY_SLOT;
+    --slotCount;
+}
 
-    Size textureSize;
+SpriteFrame* SpriteFrameCache::getSpriteFrame(uint32_t atlasIndex, uint32_t frameIndex)
+{
+    Atlas* atlas = _atlases[atlasIndex];
+    FrameDef& def = atlas->frames[frameIndex];
+    if (!def.spriteFrame)
+    {
+        def.spriteFrame = SpriteFrame::createWithTexture(atlas->texture, def.rect, def.rotated, def.offset, def.originalSize);
+        CC_SAFE_RETAIN(def.spriteFrame);
+    }
+    return def.spriteFrame;
+}
 
-    // get the format
-    if (dictionary.find("metadata") != dictionary.end())
+void SpriteFrameCache::removeFrame(uint32_t atlasIndex, uint32_t frameIndex)
+{
+    Atlas* atlas = _atlases[atlasIndex];
+    FrameDef& def = atlas->frames[frameIndex];
+    if (def.removed)
+        return;
+
+    eraseSlot(_frameSlots, _frameSlotCount, def.hash, atlasIndex, frameIndex);
+    CC_SAFE_RELEASE_NULL(def.spriteFrame);
+    def.removed = true;
+
+    if (--atlas->frameCount == 0)
     {
-        ValueMap& metadataDict = dictionary["metadata"].asValueMap();
-        format = metadataDict["format"].asInt();
+        removeAtlas(atlasIndex);
+    }
+}
+
+void SpriteFrameCache::removeAlias(uint32_t atlasIndex, uint32_t aliasIndex)
+{
+    AliasDef& alias = _atlases[atlasIndex]->aliases[aliasIndex];
+    eraseSlot(_aliasSlots, _aliasSlotCount, alias.hash, atlasIndex, aliasIndex);
+    alias.nameLength = 0;
+}
 
-        if(metadataDict.find("size") != metadataDict.end())
+void SpriteFrameCache::removeAtlas(uint32_t atlasIndex)
+{
+    Atlas* atlas = _atlases[atlasIndex];
+    for (uint32_t i = 0; i < atlas->aliases.size(); ++i)
+    {
+        if (atlas->aliases[i].nameLength > 0)
+            removeAlias(atlasIndex, i);
+    }
+    for (uint32_t i = 0; i < atlas->frames.size(); ++i)
+    {
+        FrameDef& def = atlas->frames[i];
+        if (!def.removed)
         {
-            textureSize = SizeFromString(metadataDict["size"].asString());
+            eraseSlot(_frameSlots, _frameSlotCount, def.hash, atlasIndex, i);
+            CC_SAFE_RELEASE_NULL(def.spriteFrame);
+            def.removed = true;
         }
     }
 
+    if (atlasIndex == 0)
+    {
+        // atlas 0 stays, empty
+        atlas->frames.clear();
+        atlas->aliases.clear();
+        atlas->names.clear();
+        atlas->frameCount = 0;
+        return;
+    }
+
+    CC_SAFE_RELEASE(atlas->texture);
+    delete atlas;
+    _atlases[atlasIndex] = nullptr;
+}
+
+void SpriteFrameCache::compactManualAtlas()
+{
+    // drops the removed frames of atlas 0 and their names, the frames left move to new indices
+    Atlas* atlas = _atlases[0];
+    std::string names;
+    names.reserve(atlas->names.size());
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < atlas->frames.size(); ++i)
+    {
+        FrameDef def = atlas->frames[i];
+        if (def.removed)
+            continue;
+
+        eraseSlot(_frameSlots, _frameSlotCount, def.hash, 0, i);
+        names.append(atlas->names, def.nameOffset, def.nameLength);
+        def.nameOffset = static_cast<uint32_t>(names.size() - def.nameLength);
+        atlas->frames[count] = def;
+        insertSlot(_frameSlots, _frameSlotCount, def.hash, 0, count);
+        ++count;
+    }
+    atlas->frames.resize(count);
+    atlas->names.swap(names);
+}
+
+bool SpriteFrameCache::removeFrameByName(const std::string& name)
+{
+    const Slot* slot = findSlot(_frameSlots, name.c_str(), name.size(), hashName(name.c_str(), name.size()), false);
+    if (!slot)
+        return false;
+
+    removeFrame(slot->atlas, slot->index);
+    return true;
+}
+
+void SpriteFrameCache::addSpriteFramesWithSheet(SheetData& sheet, Texture2D* texture, const std::string& plist, bool replace)
+{
+    /*
+    Supported Zwoptex Formats:
+
+    ZWTCoordinatesFormatOptionXMLLegacy = 0, // Flash Version
+    ZWTCoordinatesFormatOptionXML1_0 = 1, // Desktop Version 0.0 - 0.4b
+    ZWTCoordinatesFormatOptionXML1_1 = 2, // Desktop Version 1.0.0 - 1.0.1
+    ZWTCoordinatesFormatOptionXML1_2 = 3, // Desktop Version 1.0.2+
+
+    Version 3 with TexturePacker 4.0 polygon mesh packing
+    */
+
+    int format = sheet.format;
+
     // check the format
     CCASSERT(format >=0 && format <= 3, "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
 
-    auto textureFileName = Director::getInstance()->getTextureCache()->getTextureFilePath(texture);
+    uint32_t atlasIndex = addAtlas(plist, texture);
+    Atlas* atlas = _atlases[atlasIndex];
+    atlas->names.swap(sheet.names);
+    atlas->frames.reserve(sheet.frames.size());
+
+    std::string textureFileName;
     Image* image = nullptr;
     NinePatchImageParser parser;
-    for (auto& iter : framesDict)
+    for (const auto& frame : sheet.frames)
     {
-        ValueMap& frameDict = iter.second.asValueMap();
-        std::string spriteFrameName = iter.first;
-        SpriteFrame* spriteFrame = _spriteFrames.at(spriteFrameName);
-        if (spriteFrame)
+        const char* name = atlas->names.data() + frame.nameOffset;
+        uint32_t hash = hashName(name, frame.nameLength);
+
+        const Slot* existing = findSlot(_frameSlots, name, frame.nameLength, hash, false);
+        if (existing)
         {
-            continue;
+            if (!replace)
+            {
+                continue;
+            }
+            removeFrame(existing->atlas, existing->index);
         }
-        
+
+        FrameDef def;
+        def.spriteFrame = nullptr;
+        def.hash = hash;
+        def.nameOffset = frame.nameOffset;
+        def.nameLength = frame.nameLength;
+        def.removed = false;
+
         if(format == 0) 
         {
-            float x = frameDict["x"].asFloat();
-            float y = frameDict["y"].asFloat();
-            float w = frameDict["width"].asFloat();
-            float h = frameDict["height"].asFloat();
-            float ox = frameDict["offsetX"].asFloat();
-            float oy = frameDict["offsetY"].asFloat();
-            int ow = frameDict["originalWidth"].asInt();
-            int oh = frameDict["originalHeight"].asInt();
             // check ow/oh
-            if(!ow || !oh)
+            if(!frame.originalWidth || !frame.originalHeight)
             {
                 CCLOGWARN("cocos2d: WARNING: originalWidth/Height not found on the SpriteFrame. AnchorPoint won't work as expected. Regenerate the .plist");
             }
-            // abs ow/oh
-            ow = std::abs(ow);
-            oh = std::abs(oh);
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(x, y, w, h),
-                                                         false,
-                                                         Vec2(ox, oy),
-                                                         Size((float)ow, (float)oh)
-                                                         );
+            def.rect.setRect(frame.x, frame.y, frame.width, frame.height);
+            def.rotated = false;
+            def.offset.set(frame.offsetX, frame.offsetY);
+            def.originalSize.setSize((float)std::abs(frame.originalWidth), (float)std::abs(frame.originalHeight));
         } 
         else if(format == 1 || format == 2) 
         {
-            Rect frame = RectFromString(frameDict["frame"].asString());
-            bool rotated = false;
-
+            def.rect = frame.frame;
             // rotation
-            if (format == 2)
-            {
-                rotated = frameDict["rotated"].asBool();
-            }
-
-            Vec2 offset = PointFromString(frameDict["offset"].asString());
-            Size sourceSize = SizeFromString(frameDict["sourceSize"].asString());
-
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         frame,
-                                                         rotated,
-                                                         offset,
-                                                         sourceSize
-                                                         );
+            def.rotated = format == 2 && frame.rotated;
+            def.offset = frame.offset;
+            def.originalSize = frame.sourceSize;
         } 
-        else if (format == 3)
+        else
         {
-            // get values
-            Size spriteSize = SizeFromString(frameDict["spriteSize"].asString());
-            Vec2 spriteOffset = PointFromString(frameDict["spriteOffset"].asString());
-            Size spriteSourceSize = SizeFromString(frameDict["spriteSourceSize"].asString());
-            Rect textureRect = RectFromString(frameDict["textureRect"].asString());
-            bool textureRotated = frameDict["textureRotated"].asBool();
+            def.rect.setRect(frame.textureRect.origin.x, frame.textureRect.origin.y, frame.spriteSize.width, frame.spriteSize.height);
+            def.rotated = frame.textureRotated;
+            def.offset = frame.spriteOffset;
+            def.originalSize = frame.spriteSourceSize;
 
             // get aliases
-            ValueVector& aliases = frameDict["aliases"].asValueVector();
+            for (uint32_t i = frame.firstAlias; i < frame.firstAlias + frame.aliasCount; ++i)
+            {
+                const SheetAlias& sheetAlias = sheet.aliases[i];
+                const char* aliasName = atlas->names.data() + sheetAlias.nameOffset;
+                uint32_t aliasHash = hashName(aliasName, sheetAlias.nameLength);
 
-            for(const auto &value : aliases) {
-                std::string oneAlias = value.asString();
-                if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
+                const Slot* previous = findSlot(_aliasSlots, aliasName, sheetAlias.nameLength, aliasHash, true);
+                if (previous)
                 {
-                    CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
+                    CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", std::string(aliasName, sheetAlias.nameLength).c_str());
+                    removeAlias(previous->atlas, previous->index);
                 }
 
-                _spriteFramesAliases[oneAlias] = Value(spriteFrameName);
+                AliasDef alias;
+                alias.hash = aliasHash;
+                alias.nameOffset = sheetAlias.nameOffset;
+                alias.nameLength = sheetAlias.nameLength;
+                alias.frameNameOffset = frame.nameOffset;
+                alias.frameNameLength = frame.nameLength;
+                atlas->aliases.push_back(alias);
+                insertSlot(_aliasSlots, _aliasSlotCount, aliasHash, atlasIndex, static_cast<uint32_t>(atlas->aliases.size() - 1));
             }
+        }
 
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height),
-                                                         textureRotated,
-                                                         spriteOffset,
-                                                         spriteSourceSize);
+        uint32_t frameIndex = static_cast<uint32_t>(atlas->frames.size());
+        atlas->frames.push_back(def);
+        atlas->frameCount++;
+        insertSlot(_frameSlots, _frameSlotCount, hash, atlasIndex, frameIndex);
 
-            if(frameDict.find("vertices") != frameDict.end())
-            {
-                std::vector<int> vertices;
-                parseIntegerList(frameDict["vertices"].asString(), vertices);
-                std::vector<int> verticesUV;
-                parseIntegerList(frameDict["verticesUV"].asString(), verticesUV);
-                std::vector<int> indices;
-                parseIntegerList(frameDict["triangles"].asString(), indices);
-
-                PolygonInfo info;
-                initializePolygonInfo(textureSize, spriteSourceSize, vertices, verticesUV, indices, info);
-                spriteFrame->setPolygonInfo(info);
-            }
-            if (frameDict.find("anchor") != frameDict.end())
-            {
-                spriteFrame->setAnchorPoint(PointFromString(frameDict["anchor"].asString()));
-            }
+        // frames with extra data are created right away, the others when they are first asked for
+        if (format == 3 && frame.polygon >= 0)
+        {
+            const SheetPolygon& polygon = sheet.polygons[frame.polygon];
+            std::vector<int> vertices;
+            parseIntegerList(polygon.vertices, vertices);
+            std::vector<int> verticesUV;
+            parseIntegerList(polygon.verticesUV, verticesUV);
+            std::vector<int> indices;
+            parseIntegerList(polygon.triangles, indices);
+
+            PolygonInfo info;
+            initializePolygonInfo(sheet.textureSize, frame.spriteSourceSize, vertices, verticesUV, indices, info);
+            getSpriteFrame(atlasIndex, frameIndex)->setPolygonInfo(info);
+        }
+        if (format == 3 && frame.hasAnchor)
+        {
+            getSpriteFrame(atlasIndex, frameIndex)->setAnchorPoint(frame.anchor);
         }
 
-        bool flag = NinePatchImageParser::isNinePatchImage(spriteFrameName);
-        if(flag)
+        // same test as NinePatchImageParser::isNinePatchImage(), without making a string of the name
+        if (frame.nameLength >= 7 && hasSuffix(name, frame.nameLength, ".9.png", 6))
         {
+            SpriteFrame* spriteFrame = getSpriteFrame(atlasIndex, frameIndex);
             if (image == nullptr) {
+                textureFileName = Director::getInstance()->getTextureCache()->getTextureFilePath(texture);
                 image = new (std::nothrow) Image();
                 image->initWithImageFile(textureFileName);
             }
             parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
             texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
         }
-        // add sprite frame
-        _spriteFrames.insert(spriteFrameName, spriteFrame);
     }
     CC_SAFE_DELETE(image);
+
+    if (atlas->frameCount == 0)
+    {
+        removeAtlas(atlasIndex);
+    }
 }
 
-void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::string &texturePath)
+void SpriteFrameCache::removeSpriteFramesFromSheet(const SheetData& sheet)
 {
-    std::string pixelFormatName;
-    if (dict.find("metadata") != dict.end())
+    for (const auto& frame : sheet.frames)
     {
-        ValueMap& metadataDict = dict.at("metadata").asValueMap();
-        if (metadataDict.find("pixelFormat") != metadataDict.end())
+        const char* name = sheet.names.data() + frame.nameOffset;
+        const Slot* slot = findSlot(_frameSlots, name, frame.nameLength, hashName(name, frame.nameLength), false);
+        if (slot)
         {
-            pixelFormatName = metadataDict.at("pixelFormat").asString();
+            removeFrame(slot->atlas, slot->index);
         }
     }
-    
-    Texture2D *texture = nullptr;
+}
+
+bool SpriteFrameCache::parseSheetFile(const std::string& fullPath, SheetData& sheet)
+{
+    SheetReader<SheetData> reader(sheet);
+    return PlistParser::parseFile(fullPath, &reader) && sheet.hasFrames;
+}
+
+bool SpriteFrameCache::parseSheetDictionary(const ValueMap& dictionary, SheetData& sheet)
+{
+    SheetReader<SheetData> reader(sheet);
+    visitValueMap(dictionary, &reader);
+    return sheet.hasFrames;
+}
+
+void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
+{
+    SheetData sheet;
+    if (parseSheetDictionary(dictionary, sheet))
+    {
+        addSpriteFramesWithSheet(sheet, texture, "", false);
+    }
+}
+
+void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, const std::string& texturePath)
+{
+    SheetData sheet;
+    if (parseSheetDictionary(dictionary, sheet))
+    {
+        Texture2D* texture = addSheetTexture(sheet, texturePath);
+        if (texture)
+        {
+            addSpriteFramesWithSheet(sheet, texture, "", false);
+        }
+        else
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
+    }
+}
+
+void SpriteFrameCache::removeSpriteFramesFromDictionary(ValueMap& dictionary)
+{
+    SheetData sheet;
+    if (parseSheetDictionary(dictionary, sheet))
+    {
+        removeSpriteFramesFromSheet(sheet);
+    }
+}
+
+void SpriteFrameCache::reloadSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
+{
+    SheetData sheet;
+    if (parseSheetDictionary(dictionary, sheet))
+    {
+        addSpriteFramesWithSheet(sheet, texture, "", true);
+    }
+}
+
+bool SpriteFrameCache::parseSheetContent(const std::string& plist_content, SheetData& sheet)
+{
+    SheetReader<SheetData> reader(sheet);
+    return PlistParser::parse(plist_content.data(), plist_content.size(), &reader) && sheet.hasFrames;
+}
+
+std::string SpriteFrameCache::getSheetTexturePath(const SheetData& sheet, const std::string& plist)
+{
+    // try to read  texture file name from meta data
+    string texturePath = sheet.textureFileName;
+
+    if (!texturePath.empty())
+    {
+        // build texture path relative to plist file
+        texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, plist);
+    }
+    else
+    {
+        // build texture path by replacing file extension
+        texturePath = plist;
+
+        // remove .xxx
+        size_t startPos = texturePath.find_last_of("."); 
+        texturePath = texturePath.erase(startPos);
+
+        // append .png
+        texturePath = texturePath.append(".png");
+
+        CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+    }
+    return texturePath;
+}
+
+Texture2D* SpriteFrameCache::addSheetTexture(const SheetData& sheet, const std::string& texturePath)
+{
     static std::unordered_map<std::string, Texture2D::PixelFormat> pixelFormats = {
         {"RGBA8888", Texture2D::PixelFormat::RGBA8888},
         {"RGBA4444", Texture2D::PixelFormat::RGBA4444},
@@ -325,7 +1042,8 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::
         {"RGB888", Texture2D::PixelFormat::RGB888}
     };
 
-    auto pixelFormatIt = pixelFormats.find(pixelFormatName);
+    Texture2D *texture = nullptr;
+    auto pixelFormatIt = pixelFormats.find(sheet.pixelFormat);
     if (pixelFormatIt != pixelFormats.end())
     {
         const Texture2D::PixelFormat pixelFormat = (*pixelFormatIt).second;
@@ -338,15 +1056,7 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::
     {
         texture = Director::getInstance()->getTextureCache()->addImage(texturePath);
     }
-    
-    if (texture)
-    {
-        addSpriteFramesWithDictionary(dict, texture);
-    }
-    else
-    {
-        CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
-    }
+    return texture;
 }
 
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture2D *texture)
@@ -357,16 +1067,21 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
     }
     
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-
-    addSpriteFramesWithDictionary(dict, texture);
+    SheetData sheet;
+    if (parseSheetFile(fullPath, sheet))
+    {
+        addSpriteFramesWithSheet(sheet, texture, plist, false);
+    }
     _loadedFileNames->insert(plist);
 }
 
 void SpriteFrameCache::addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture)
 {
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromData(plist_content.c_str(), static_cast<int>(plist_content.size()));
-    addSpriteFramesWithDictionary(dict, texture);
+    SheetData sheet;
+    if (parseSheetContent(plist_content, sheet))
+    {
+        addSpriteFramesWithSheet(sheet, texture, "", false);
+    }
 }
 
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const std::string& textureFileName)
@@ -378,8 +1093,19 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const s
     }
     
     const std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-    addSpriteFramesWithDictionary(dict, textureFileName);
+    SheetData sheet;
+    if (parseSheetFile(fullPath, sheet))
+    {
+        Texture2D* texture = addSheetTexture(sheet, textureFileName);
+        if (texture)
+        {
+            addSpriteFramesWithSheet(sheet, texture, plist, false);
+        }
+        else
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
+    }
     _loadedFileNames->insert(plist);
 }
 
@@ -397,37 +1123,19 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 
     if (_loadedFileNames->find(plist) == _loadedFileNames->end())
     {
-        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-
-        string texturePath("");
-
-        if (dict.find("metadata") != dict.end())
-        {
-            ValueMap& metadataDict = dict["metadata"].asValueMap();
-            // try to read  texture file name from meta data
-            texturePath = metadataDict["textureFileName"].asString();
-        }
-
-        if (!texturePath.empty())
-        {
-            // build texture path relative to plist file
-            texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, plist);
-        }
-        else
+        SheetData sheet;
+        if (parseSheetFile(fullPath, sheet))
         {
-            // build texture path by replacing file extension
-            texturePath = plist;
-
-            // remove .xxx
-            size_t startPos = texturePath.find_last_of("."); 
-            texturePath = texturePath.erase(startPos);
-
-            // append .png
-            texturePath = texturePath.append(".png");
-
-            CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+            Texture2D* texture = addSheetTexture(sheet, getSheetTexturePath(sheet, plist));
+            if (texture)
+            {
+                addSpriteFramesWithSheet(sheet, texture, plist, false);
+            }
+            else
+            {
+                CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+            }
         }
-        addSpriteFramesWithDictionary(dict, texturePath);
         _loadedFileNames->insert(plist);
     }
 }
@@ -447,35 +1155,71 @@ bool SpriteFrameCache::isSpriteFramesWithFileLoaded(const std::string& plist) co
 void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& frameName)
 {
     CCASSERT(frame, "frame should not be nil");
-    _spriteFrames.insert(frameName, frame);
+
+    // replaces a frame of the same name
+    removeFrameByName(frameName);
+
+    Atlas* atlas = _atlases[0];
+    // the removed frames are only marked, compact them once they outnumber the frames left
+    const size_t removedCount = atlas->frames.size() - atlas->frameCount;
+    if (removedCount >= 32 && removedCount > atlas->frameCount)
+    {
+        compactManualAtlas();
+    }
+
+    FrameDef def;
+    def.spriteFrame = frame;
+    def.hash = hashName(frameName.c_str(), frameName.size());
+    def.nameOffset = static_cast<uint32_t>(atlas->names.size());
+    def.nameLength = static_cast<uint32_t>(frameName.size());
+    def.rotated = false;
+    def.removed = false;
+    frame->retain();
+
+    atlas->names.append(frameName);
+    atlas->frames.push_back(def);
+    atlas->frameCount++;
+    insertSlot(_frameSlots, _frameSlotCount, def.hash, 0, static_cast<uint32_t>(atlas->frames.size() - 1));
 }
 
 void SpriteFrameCache::removeSpriteFrames()
 {
-    _spriteFrames.clear();
-    _spriteFramesAliases.clear();
+    for (uint32_t i = 0; i < _atlases.size(); ++i)
+    {
+        if (_atlases[i])
+            removeAtlas(i);
+    }
     _loadedFileNames->clear();
 }
 
 void SpriteFrameCache::removeUnusedSpriteFrames()
 {
     bool removed = false;
-    std::vector<std::string> toRemoveFrames;
-    
-    for (auto& iter : _spriteFrames)
+
+    for (uint32_t i = 0; i < _atlases.size(); ++i)
     {
-        SpriteFrame* spriteFrame = iter.second;
-        if( spriteFrame->getReferenceCount() == 1 )
+        // removing the last frame of an atlas removes the atlas
+        for (uint32_t j = 0; _atlases[i] && j < _atlases[i]->frames.size(); ++j)
         {
-            toRemoveFrames.push_back(iter.first);
-            spriteFrame->getTexture()->removeSpriteFrameCapInset(spriteFrame);
-            CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", iter.first.c_str());
-            removed = true;
+            const FrameDef& def = _atlases[i]->frames[j];
+            if (def.removed)
+                continue;
+
+            // a frame that was never asked for is only referenced by the cache
+            SpriteFrame* spriteFrame = def.spriteFrame;
+            if (!spriteFrame || spriteFrame->getReferenceCount() == 1)
+            {
+                if (spriteFrame)
+                {
+                    spriteFrame->getTexture()->removeSpriteFrameCapInset(spriteFrame);
+                }
+                CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", std::string(_atlases[i]->names, def.nameOffset, def.nameLength).c_str());
+                removeFrame(i, j);
+                removed = true;
+            }
         }
     }
 
-    _spriteFrames.erase(toRemoveFrames);
-
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     if( removed )
     {
@@ -491,17 +1235,18 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
         return;
 
     // Is this an alias ?
-    bool foundAlias = _spriteFramesAliases.find(name) != _spriteFramesAliases.end();
-    std::string key = foundAlias ? _spriteFramesAliases[name].asString() : "";
-
-    if (!key.empty())
+    const Slot* alias = findSlot(_aliasSlots, name.c_str(), name.size(), hashName(name.c_str(), name.size()), true);
+    if (alias)
     {
-        _spriteFrames.erase(key);
-        _spriteFramesAliases.erase(key);
+        const Atlas* atlas = _atlases[alias->atlas];
+        const AliasDef& def = atlas->aliases[alias->index];
+        std::string key(atlas->names, def.frameNameOffset, def.frameNameLength);
+        removeAlias(alias->atlas, alias->index);
+        removeFrameByName(key);
     }
     else
     {
-        _spriteFrames.erase(name);
+        removeFrameByName(name);
     }
 
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
@@ -510,14 +1255,28 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
 
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-    if (dict.empty())
+    // the frames registered from the file are dropped without reading it again
+    bool removed = false;
+    for (uint32_t i = 1; i < _atlases.size(); ++i)
     {
-        CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
-        return;
+        if (_atlases[i] && _atlases[i]->plist == plist)
+        {
+            removeAtlas(i);
+            removed = true;
+        }
+    }
+
+    if (!removed)
+    {
+        std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+        SheetData sheet;
+        if (!parseSheetFile(fullPath, sheet))
+        {
+            CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
+            return;
+        }
+        removeSpriteFramesFromSheet(sheet);
     }
-    removeSpriteFramesFromDictionary(dict);
 
     // remove it from the cache
     set<string>::iterator ret = _loadedFileNames->find(plist);
@@ -529,186 +1288,73 @@ void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 
 void SpriteFrameCache::removeSpriteFramesFromFileContent(const std::string& plist_content)
 {
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromData(plist_content.data(), static_cast<int>(plist_content.size()));
-    if (dict.empty())
+    SheetData sheet;
+    if (!parseSheetContent(plist_content, sheet))
     {
         CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFileContent: create dict by fail.");
         return;
     }
-    removeSpriteFramesFromDictionary(dict);
-}
-
-void SpriteFrameCache::removeSpriteFramesFromDictionary(ValueMap& dictionary)
-{
-    if (dictionary["frames"].getType() != cocos2d::Value::Type::MAP)
-        return;
-
-    const ValueMap& framesDict = dictionary["frames"].asValueMap();
-    std::vector<std::string> keysToRemove;
-
-    for (const auto& iter : framesDict)
-    {
-        if (_spriteFrames.at(iter.first))
-        {
-            keysToRemove.push_back(iter.first);
-        }
-    }
-
-    _spriteFrames.erase(keysToRemove);
+    removeSpriteFramesFromSheet(sheet);
 }
 
 void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
 {
-    std::vector<std::string> keysToRemove;
-
-    for (auto& iter : _spriteFrames)
+    for (uint32_t i = 0; i < _atlases.size(); ++i)
     {
-        std::string key = iter.first;
-        SpriteFrame* frame = _spriteFrames.at(key);
-        if (frame && (frame->getTexture() == texture))
+        if (_atlases[i] && _atlases[i]->texture == texture)
         {
-            keysToRemove.push_back(key);
+            // frames that were asked for may have been given another texture since
+            bool retextured = false;
+            for (const auto& def : _atlases[i]->frames)
+            {
+                retextured = retextured || (!def.removed && def.spriteFrame && def.spriteFrame->getTexture() != texture);
+            }
+            if (!retextured)
+            {
+                removeAtlas(i);
+                continue;
+            }
         }
-    }
-
-    _spriteFrames.erase(keysToRemove);
-}
 
-SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
-{
-    SpriteFrame* frame = _spriteFrames.at(name);
-    if (!frame)
-    {
-        // try alias dictionary
-        if (_spriteFramesAliases.find(name) != _spriteFramesAliases.end())
+        for (uint32_t j = 0; _atlases[i] && j < _atlases[i]->frames.size(); ++j)
         {
-            std::string key = _spriteFramesAliases[name].asString();
-            if (!key.empty())
+            const FrameDef& def = _atlases[i]->frames[j];
+            Texture2D* frameTexture = def.spriteFrame ? def.spriteFrame->getTexture() : _atlases[i]->texture;
+            if (!def.removed && frameTexture == texture)
             {
-                frame = _spriteFrames.at(key);
-                if (!frame)
-                {
-                    CCLOG("cocos2d: SpriteFrameCache: Frame aliases '%s' isn't found", key.c_str());
-                }
+                removeFrame(i, j);
             }
         }
-        else
-        {
-            CCLOG("cocos2d: SpriteFrameCache: Frame '%s' isn't found", name.c_str());
-        }
     }
-    return frame;
 }
 
-void SpriteFrameCache::reloadSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture)
+SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
 {
-    ValueMap& framesDict = dictionary["frames"].asValueMap();
-    int format = 0;
-
-    // get the format
-    if (dictionary.find("metadata") != dictionary.end())
+    uint32_t hash = hashName(name.c_str(), name.size());
+    const Slot* slot = findSlot(_frameSlots, name.c_str(), name.size(), hash, false);
+    if (slot)
     {
-        ValueMap& metadataDict = dictionary["metadata"].asValueMap();
-        format = metadataDict["format"].asInt();
+        return getSpriteFrame(slot->atlas, slot->index);
     }
 
-    // check the format
-    CCASSERT(format >= 0 && format <= 3, "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
-
-    for (auto& iter : framesDict)
+    // try alias dictionary
+    const Slot* alias = findSlot(_aliasSlots, name.c_str(), name.size(), hash, true);
+    if (!alias)
     {
-        ValueMap& frameDict = iter.second.asValueMap();
-        std::string spriteFrameName = iter.first;
-
-        auto it = _spriteFrames.find(spriteFrameName);
-        if (it != _spriteFrames.end())
-        {
-            _spriteFrames.erase(it);
-        }
-
-        SpriteFrame* spriteFrame = nullptr;
-
-        if (format == 0)
-        {
-            float x = frameDict["x"].asFloat();
-            float y = frameDict["y"].asFloat();
-            float w = frameDict["width"].asFloat();
-            float h = frameDict["height"].asFloat();
-            float ox = frameDict["offsetX"].asFloat();
-            float oy = frameDict["offsetY"].asFloat();
-            int ow = frameDict["originalWidth"].asInt();
-            int oh = frameDict["originalHeight"].asInt();
-            // check ow/oh
-            if (!ow || !oh)
-            {
-                CCLOGWARN("cocos2d: WARNING: originalWidth/Height not found on the SpriteFrame. AnchorPoint won't work as expected. Regenerate the .plist");
-            }
-            // abs ow/oh
-            ow = std::abs(ow);
-            oh = std::abs(oh);
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                Rect(x, y, w, h),
-                false,
-                Vec2(ox, oy),
-                Size((float)ow, (float)oh)
-                );
-        }
-        else if (format == 1 || format == 2)
-        {
-            Rect frame = RectFromString(frameDict["frame"].asString());
-            bool rotated = false;
-
-            // rotation
-            if (format == 2)
-            {
-                rotated = frameDict["rotated"].asBool();
-            }
-
-            Vec2 offset = PointFromString(frameDict["offset"].asString());
-            Size sourceSize = SizeFromString(frameDict["sourceSize"].asString());
-
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                frame,
-                rotated,
-                offset,
-                sourceSize
-                );
-        }
-        else if (format == 3)
-        {
-            // get values
-            Size spriteSize = SizeFromString(frameDict["spriteSize"].asString());
-            Vec2 spriteOffset = PointFromString(frameDict["spriteOffset"].asString());
-            Size spriteSourceSize = SizeFromString(frameDict["spriteSourceSize"].asString());
-            Rect textureRect = RectFromString(frameDict["textureRect"].asString());
-            bool textureRotated = frameDict["textureRotated"].asBool();
-
-            // get aliases
-            ValueVector& aliases = frameDict["aliases"].asValueVector();
-
-            for (const auto &value : aliases) {
-                std::string oneAlias = value.asString();
-                if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
-                {
-                    CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
-                }
-
-                _spriteFramesAliases[oneAlias] = Value(spriteFrameName);
-            }
-
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height),
-                textureRotated,
-                spriteOffset,
-                spriteSourceSize);
-        }
+        CCLOG("cocos2d: SpriteFrameCache: Frame '%s' isn't found", name.c_str());
+        return nullptr;
+    }
 
-        // add sprite frame
-        _spriteFrames.insert(spriteFrameName, spriteFrame);
+    const Atlas* atlas = _atlases[alias->atlas];
+    const AliasDef& def = atlas->aliases[alias->index];
+    const char* key = atlas->names.data() + def.frameNameOffset;
+    slot = findSlot(_frameSlots, key, def.frameNameLength, hashName(key, def.frameNameLength), false);
+    if (!slot)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: Frame aliases '%s' isn't found", std::string(key, def.frameNameLength).c_str());
+        return nullptr;
     }
+    return getSpriteFrame(slot->atlas, slot->index);
 }
 
 bool SpriteFrameCache::reloadTexture(const std::string& plist)
@@ -726,34 +1372,14 @@ bool SpriteFrameCache::reloadTexture(const std::string& plist)
     }
 
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-
-    string texturePath("");
-
-    if (dict.find("metadata") != dict.end())
+    SheetData sheet;
+    if (!parseSheetFile(fullPath, sheet))
     {
-        ValueMap& metadataDict = dict["metadata"].asValueMap();
-        // try to read  texture file name from meta data
-        texturePath = metadataDict["textureFileName"].asString();
+        CCLOG("cocos2d: SpriteFrameCache: Couldn't load %s", plist.c_str());
+        return true;
     }
 
-    if (!texturePath.empty())
-    {
-        // build texture path relative to plist file
-        texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, plist);
-    }
-    else
-    {
-        // build texture path by replacing file extension
-        texturePath = plist;
-
-        // remove .xxx
-        size_t startPos = texturePath.find_last_of(".");
-        texturePath = texturePath.erase(startPos);
-
-        // append .png
-        texturePath = texturePath.append(".png");
-    }
+    std::string texturePath = getSheetTexturePath(sheet, plist);
 
     Texture2D *texture = nullptr;
     if (Director::getInstance()->getTextureCache()->reloadTexture(texturePath))
@@ -761,7 +1387,13 @@ bool SpriteFrameCache::reloadTexture(const std::string& plist)
 
     if (texture)
     {
-        reloadSpriteFramesWithDictionary(dict, texture);
+        // the frames are created again, replacing the ones of the same name
+        for (uint32_t i = 1; i < _atlases.size(); ++i)
+        {
+            if (_atlases[i] && _atlases[i]->plist == plist)
+                removeAtlas(i);
+        }
+        addSpriteFramesWithSheet(sheet, texture, plist, true);
         _loadedFileNames->insert(plist);
     }
     else
@@ -33,6 +33,8 @@ THE SOFTWARE.
 
 #include <set>
 #include <string>
+#include <vector>
+#include <cstdint>
 #include "2d/CCSpriteFrame.h"
 #include "base/CCRef.h"
 #include "base/CCValue.h"
@@ -81,6 +83,12 @@ class PolygonInfo;
  Use one of the following tools to create the .plist file and sprite sheet:
  - [TexturePacker](https://www.codeandweb.com/texturepacker/cocos2d)
  - [Zwoptex](https://zwopple.com/zwoptex/)
+
+ The .plist file is streamed through a PlistParser once, into a flat table of frame
+ definitions per atlas. A SpriteFrame is only created the first time its name is asked
+ for, and names are found through a hash table of precomputed name hashes, so registering
+ or removing a sheet of thousands of frames doesn't allocate per frame, and looking up a
+ frame that was already created doesn't allocate at all.
  
  @since v0.9
  @js cc.spriteFrameCache
@@ -244,18 +252,96 @@ protected:
     // MARMALADE: Made this protected not private, as deriving from this class is pretty useful
     SpriteFrameCache(){}
 
-    /*Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
+    /** A frame of an atlas, kept as plain data until its SpriteFrame is asked for. */
+    struct FrameDef
+    {
+        Rect rect;
+        Vec2 offset;
+        Size originalSize;
+        SpriteFrame* spriteFrame;   // retained once created
+        uint32_t hash;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        bool rotated;
+        bool removed;
+    };
+
+    /** Another name of a frame. */
+    struct AliasDef
+    {
+        uint32_t hash;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t frameNameOffset;
+        uint32_t frameNameLength;
+    };
+
+    /** The frames registered from one sheet. Atlas 0 holds the frames added one by one. */
+    struct Atlas
+    {
+        std::string plist;
+        Texture2D* texture;         // retained
+        std::string names;          // the names of the frames and aliases, back to back
+        std::vector<FrameDef> frames;
+        std::vector<AliasDef> aliases;
+        size_t frameCount;          // frames not removed
+    };
+
+    /** A slot of a name table, found by linear probing from the name hash. */
+    struct Slot
+    {
+        uint32_t hash;
+        uint32_t atlas;             // EMPTY_SLOT if the slot is free
+        uint32_t index;
+    };
+
+    static const uint32_t EMPTY_SLOT = 0xffffffff;
+
+    /** The contents of a sheet .plist, see SpriteFrameCache.cpp. */
+    struct SheetData;
+
+    bool parseSheetFile(const std::string& fullPath, SheetData& sheet);
+    bool parseSheetContent(const std::string& plist_content, SheetData& sheet);
+    bool parseSheetDictionary(const ValueMap& dictionary, SheetData& sheet);
+    std::string getSheetTexturePath(const SheetData& sheet, const std::string& plist);
+    Texture2D* addSheetTexture(const SheetData& sheet, const std::string& texturePath);
+
+    /** Registers the frames of a sheet. Frames whose name is taken are skipped, or replace it if replace is true. */
+    void addSpriteFramesWithSheet(SheetData& sheet, Texture2D* texture, const std::string& plist, bool replace);
+
+    /** Removes the frames a sheet names. */
+    void removeSpriteFramesFromSheet(const SheetData& sheet);
+
+    SpriteFrame* getSpriteFrame(uint32_t atlasIndex, uint32_t frameIndex);
+    const Slot* findSlot(const std::vector<Slot>& slots, const char* name, size_t length, uint32_t hash, bool alias) const;
+    void insertSlot(std::vector<Slot>& slots, size_t& slotCount, uint32_t hash, uint32_t atlasIndex, uint32_t index);
+    void eraseSlot(std::vector<Slot>& slots, size_t& slotCount, uint32_t hash, uint32_t atlasIndex, uint32_t index);
+    void removeFrame(uint32_t atlasIndex, uint32_t frameIndex);
+    void removeAlias(uint32_t atlasIndex, uint32_t aliasIndex);
+    void removeAtlas(uint32_t atlasIndex);
+    void compactManualAtlas();
+    uint32_t addAtlas(const std::string& plist, Texture2D* texture);
+    bool removeFrameByName(const std::string& name);
+
+    /** Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
+     * @deprecated The sheets are no longer read into a ValueMap, use addSpriteFramesWithFile() or addSpriteFramesWithFileContent().
      */
-    void addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
-    
-    /*Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
+    CC_DEPRECATED_ATTRIBUTE void addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
+
+    /** Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
+     * @deprecated The sheets are no longer read into a ValueMap, use addSpriteFramesWithFile() or addSpriteFramesWithFileContent().
      */
-    void addSpriteFramesWithDictionary(ValueMap& dictionary, const std::string &texturePath);
-    
+    CC_DEPRECATED_ATTRIBUTE void addSpriteFramesWithDictionary(ValueMap& dictionary, const std::string &texturePath);
+
     /** Removes multiple Sprite Frames from Dictionary.
-    * @since v0.99.5
-    */
-    void removeSpriteFramesFromDictionary(ValueMap& dictionary);
+     * @deprecated The sheets are no longer read into a ValueMap, use removeSpriteFramesFromFile() or removeSpriteFramesFromFileContent().
+     */
+    CC_DEPRECATED_ATTRIBUTE void removeSpriteFramesFromDictionary(ValueMap& dictionary);
+
+    /** Replaces the Sprite Frames of a dictionary with ones using texture.
+     * @deprecated The sheets are no longer read into a ValueMap, use reloadTexture().
+     */
+    CC_DEPRECATED_ATTRIBUTE void reloadSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
 
     /** Parses list of space-separated integers */
     void parseIntegerList(const std::string &string, std::vector<int> &res);
@@ -268,10 +354,11 @@ protected:
                                const std::vector<int> &triangleIndices,
                                PolygonInfo &polygonInfo);
 
-    void reloadSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
-
-    Map<std::string, SpriteFrame*> _spriteFrames;
-    ValueMap _spriteFramesAliases;
+    std::vector<Atlas*> _atlases;
+    std::vector<Slot> _frameSlots;
+    std::vector<Slot> _aliasSlots;
+    size_t _frameSlotCount;
+    size_t _aliasSlotCount;
     std::set<std::string>*  _loadedFileNames;
 };
 
@@ -0,0 +1,481 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCTweenSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCNode.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+// the elastic curves with the default period of tweenfunc::tweenTo()
+static float elasticEaseIn(float time)
+{
+    return tweenfunc::elasticEaseIn(time, 0.3f);
+}
+
+static float elasticEaseOut(float time)
+{
+    return tweenfunc::elasticEaseOut(time, 0.3f);
+}
+
+static float elasticEaseInOut(float time)
+{
+    return tweenfunc::elasticEaseInOut(time, 0.3f);
+}
+
+TweenSystem::EasingFunction TweenSystem::getEasingFunction(tweenfunc::TweenType easing)
+{
+    switch (easing)
+    {
+        case tweenfunc::Linear: return nullptr;
+        case tweenfunc::Sine_EaseIn: return tweenfunc::sineEaseIn;
+        case tweenfunc::Sine_EaseOut: return tweenfunc::sineEaseOut;
+        case tweenfunc::Sine_EaseInOut: return tweenfunc::sineEaseInOut;
+        case tweenfunc::Quad_EaseIn: return tweenfunc::quadEaseIn;
+        case tweenfunc::Quad_EaseOut: return tweenfunc::quadEaseOut;
+        case tweenfunc::Quad_EaseInOut: return tweenfunc::quadEaseInOut;
+        case tweenfunc::Cubic_EaseIn: return tweenfunc::cubicEaseIn;
+        case tweenfunc::Cubic_EaseOut: return tweenfunc::cubicEaseOut;
+        case tweenfunc::Cubic_EaseInOut: return tweenfunc::cubicEaseInOut;
+        case tweenfunc::Quart_EaseIn: return tweenfunc::quartEaseIn;
+        case tweenfunc::Quart_EaseOut: return tweenfunc::quartEaseOut;
+        case tweenfunc::Quart_EaseInOut: return tweenfunc::quartEaseInOut;
+        case tweenfunc::Quint_EaseIn: return tweenfunc::quintEaseIn;
+        case tweenfunc::Quint_EaseOut: return tweenfunc::quintEaseOut;
+        case tweenfunc::Quint_EaseInOut: return tweenfunc::quintEaseInOut;
+        case tweenfunc::Expo_EaseIn: return tweenfunc::expoEaseIn;
+        case tweenfunc::Expo_EaseOut: return tweenfunc::expoEaseOut;
+        case tweenfunc::Expo_EaseInOut: return tweenfunc::expoEaseInOut;
+        case tweenfunc::Circ_EaseIn: return tweenfunc::circEaseIn;
+        case tweenfunc::Circ_EaseOut: return tweenfunc::circEaseOut;
+        case tweenfunc::Circ_EaseInOut: return tweenfunc::circEaseInOut;
+        case tweenfunc::Elastic_EaseIn: return elasticEaseIn;
+        case tweenfunc::Elastic_EaseOut: return elasticEaseOut;
+        case tweenfunc::Elastic_EaseInOut: return elasticEaseInOut;
+        case tweenfunc::Back_EaseIn: return tweenfunc::backEaseIn;
+        case tweenfunc::Back_EaseOut: return tweenfunc::backEaseOut;
+        case tweenfunc::Back_EaseInOut: return tweenfunc::backEaseInOut;
+        case tweenfunc::Bounce_EaseIn: return tweenfunc::bounceEaseIn;
+        case tweenfunc::Bounce_EaseOut: return tweenfunc::bounceEaseOut;
+        case tweenfunc::Bounce_EaseInOut: return tweenfunc::bounceEaseInOut;
+        default:
+            CCASSERT(false, "TweenSystem: the easing isn't supported, use an action");
+            return nullptr;
+    }
+}
+
+TweenSystem::TweenSystem()
+: _tweenCount(0)
+, _updating(false)
+{
+}
+
+TweenSystem::~TweenSystem()
+{
+    removeAllTweens();
+    for (auto batch : _batches)
+    {
+        delete batch;
+    }
+}
+
+void TweenSystem::moveTo(Node* target, float duration, const Vec2& position, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    const float from[] = { target->getPositionX(), target->getPositionY() };
+    const float to[] = { position.x, position.y };
+    addTween(Property::POSITION, target, duration, from, to, easing, tag);
+}
+
+void TweenSystem::moveBy(Node* target, float duration, const Vec2& offset, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    moveTo(target, duration, target->getPosition() + offset, easing, tag);
+}
+
+void TweenSystem::scaleTo(Node* target, float duration, float scaleX, float scaleY, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    const float from[] = { target->getScaleX(), target->getScaleY() };
+    const float to[] = { scaleX, scaleY };
+    addTween(Property::SCALE, target, duration, from, to, easing, tag);
+}
+
+void TweenSystem::rotateTo(Node* target, float duration, float angle, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    // like RotateTo, take the shortest way
+    const float from = target->getRotation();
+    float diff = fmodf(angle - from, 360.0f);
+    if (diff > 180)
+    {
+        diff -= 360;
+    }
+    else if (diff < -180)
+    {
+        diff += 360;
+    }
+    rotateBy(target, duration, diff, easing, tag);
+}
+
+void TweenSystem::rotateBy(Node* target, float duration, float angle, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    const float from = target->getRotation();
+    const float to = from + angle;
+    addTween(Property::ROTATION, target, duration, &from, &to, easing, tag);
+}
+
+void TweenSystem::fadeTo(Node* target, float duration, GLubyte opacity, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    const float from = target->getOpacity();
+    const float to = opacity;
+    addTween(Property::OPACITY, target, duration, &from, &to, easing, tag);
+}
+
+void TweenSystem::tintTo(Node* target, float duration, const Color3B& color, tweenfunc::TweenType easing, int tag)
+{
+    CCASSERT(target, "TweenSystem: target can't be nullptr");
+    const Color3B& current = target->getColor();
+    const float from[] = { (float)current.r, (float)current.g, (float)current.b };
+    const float to[] = { (float)color.r, (float)color.g, (float)color.b };
+    addTween(Property::COLOR, target, duration, from, to, easing, tag);
+}
+
+void TweenSystem::addTween(Property property, Node* target, float duration, const float* from, const float* to,
+                           tweenfunc::TweenType easing, int tag)
+{
+    const int key = (int)property * tweenfunc::TWEEN_EASING_MAX + easing;
+    Batch* batch = nullptr;
+    auto iter = _batchIndices.find(key);
+    if (iter != _batchIndices.end())
+    {
+        batch = _batches[iter->second];
+    }
+    else
+    {
+        batch = new (std::nothrow) Batch();
+        batch->property = property;
+        batch->easingFunction = getEasingFunction(easing);
+        _batchIndices[key] = _batches.size();
+        _batches.push_back(batch);
+    }
+
+    const int componentCount = property == Property::COLOR ? 3 : (property == Property::POSITION || property == Property::SCALE ? 2 : 1);
+    for (int c = 0; c < componentCount; ++c)
+    {
+        batch->from[c].push_back(from[c]);
+        batch->deltas[c].push_back(to[c] - from[c]);
+    }
+    batch->targets.push_back(target);
+    batch->tags.push_back(tag);
+    batch->elapsed.push_back(0);
+    // like ActionInterval, prevent the division by 0
+    batch->invDurations.push_back(1.0f / std::max(duration, FLT_EPSILON));
+    // like the actions, the tweens of a node that isn't running start paused
+    batch->speeds.push_back(target->isRunning() ? 1.0f : 0.0f);
+
+    target->retain();
+    ++_targetTweenCounts[target];
+    ++_tweenCount;
+}
+
+void TweenSystem::removeTween(Batch* batch, size_t index)
+{
+    Node* target = batch->targets[index];
+    auto iter = _targetTweenCounts.find(target);
+    if (--iter->second == 0)
+    {
+        _targetTweenCounts.erase(iter);
+    }
+    --_tweenCount;
+
+    if (_updating)
+    {
+        // erased and released at the end of the update
+        batch->targets[index] = nullptr;
+        _releasedTargets.push_back(target);
+    }
+    else
+    {
+        eraseTween(batch, index);
+        target->release();
+    }
+}
+
+void TweenSystem::eraseTween(Batch* batch, size_t index)
+{
+    const size_t last = batch->targets.size() - 1;
+    batch->targets[index] = batch->targets[last];
+    batch->targets.pop_back();
+    batch->tags[index] = batch->tags[last];
+    batch->tags.pop_back();
+    batch->elapsed[index] = batch->elapsed[last];
+    batch->elapsed.pop_back();
+    batch->invDurations[index] = batch->invDurations[last];
+    batch->invDurations.pop_back();
+    batch->speeds[index] = batch->speeds[last];
+    batch->speeds.pop_back();
+    for (int c = 0; c < 3 && !batch->from[c].empty(); ++c)
+    {
+        batch->from[c][index] = batch->from[c][last];
+        batch->from[c].pop_back();
+        batch->deltas[c][index] = batch->deltas[c][last];
+        batch->deltas[c].pop_back();
+    }
+}
+
+void TweenSystem::removeAllTweensFromTarget(Node* target)
+{
+    if (_targetTweenCounts.find(target) == _targetTweenCounts.end())
+    {
+        return;
+    }
+
+    for (auto batch : _batches)
+    {
+        for (size_t i = batch->targets.size(); i-- > 0;)
+        {
+            if (batch->targets[i] == target)
+            {
+                removeTween(batch, i);
+            }
+        }
+    }
+}
+
+void TweenSystem::removeTweensByTag(int tag, Node* target)
+{
+    CCASSERT(tag != Action::INVALID_TAG, "Invalid tag value!");
+    if (_targetTweenCounts.find(target) == _targetTweenCounts.end())
+    {
+        return;
+    }
+
+    for (auto batch : _batches)
+    {
+        for (size_t i = batch->targets.size(); i-- > 0;)
+        {
+            if (batch->targets[i] == target && batch->tags[i] == tag)
+            {
+                removeTween(batch, i);
+            }
+        }
+    }
+}
+
+void TweenSystem::removeAllTweens()
+{
+    for (auto batch : _batches)
+    {
+        for (size_t i = batch->targets.size(); i-- > 0;)
+        {
+            if (batch->targets[i])
+            {
+                removeTween(batch, i);
+            }
+        }
+    }
+}
+
+void TweenSystem::pauseTarget(Node* target)
+{
+    if (_targetTweenCounts.find(target) == _targetTweenCounts.end())
+    {
+        return;
+    }
+
+    for (auto batch : _batches)
+    {
+        for (size_t i = 0, count = batch->targets.size(); i < count; ++i)
+        {
+            if (batch->targets[i] == target)
+            {
+                batch->speeds[i] = 0;
+            }
+        }
+    }
+}
+
+void TweenSystem::resumeTarget(Node* target)
+{
+    if (_targetTweenCounts.find(target) == _targetTweenCounts.end())
+    {
+        return;
+    }
+
+    for (auto batch : _batches)
+    {
+        for (size_t i = 0, count = batch->targets.size(); i < count; ++i)
+        {
+            if (batch->targets[i] == target)
+            {
+                batch->speeds[i] = 1;
+            }
+        }
+    }
+}
+
+ssize_t TweenSystem::getNumberOfRunningTweensInTarget(Node* target) const
+{
+    auto iter = _targetTweenCounts.find(target);
+    return iter != _targetTweenCounts.end() ? iter->second : 0;
+}
+
+void TweenSystem::update(float dt)
+{
+    if (_tweenCount == 0)
+    {
+        return;
+    }
+
+    _updating = true;
+
+    // tweens added by the setters of the nodes are appended to the batches, and start in the next update
+    for (size_t b = 0; b < _batches.size(); ++b)
+    {
+        Batch* batch = _batches[b];
+        const size_t count = batch->targets.size();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        batch->times.resize(count);
+        float* elapsed = batch->elapsed.data();
+        const float* invDurations = batch->invDurations.data();
+        const float* speeds = batch->speeds.data();
+        float* times = batch->times.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            elapsed[i] += dt * speeds[i];
+            times[i] = std::min(elapsed[i] * invDurations[i], 1.0f);
+        }
+
+        const EasingFunction easingFunction = batch->easingFunction;
+        if (easingFunction)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                times[i] = easingFunction(times[i]);
+            }
+        }
+
+        applyBatch(batch, count);
+    }
+
+    _updating = false;
+
+    // remove the finished tweens, and the ones removed by the setters
+    for (auto batch : _batches)
+    {
+        for (size_t i = batch->targets.size(); i-- > 0;)
+        {
+            if (batch->targets[i] == nullptr)
+            {
+                eraseTween(batch, i);
+            }
+            else if (batch->elapsed[i] * batch->invDurations[i] >= 1.0f)
+            {
+                removeTween(batch, i);
+            }
+        }
+    }
+
+    for (auto target : _releasedTargets)
+    {
+        target->release();
+    }
+    _releasedTargets.clear();
+}
+
+void TweenSystem::applyBatch(Batch* batch, size_t count)
+{
+    // the setters may add or remove tweens: access the arrays by index
+    const auto& targets = batch->targets;
+    const auto& speeds = batch->speeds;
+    const auto& times = batch->times;
+    const auto& from = batch->from;
+    const auto& deltas = batch->deltas;
+
+    switch (batch->property)
+    {
+        case Property::POSITION:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (speeds[i] != 0 && targets[i])
+                {
+                    targets[i]->setPosition(from[0][i] + deltas[0][i] * times[i], from[1][i] + deltas[1][i] * times[i]);
+                }
+            }
+            break;
+        case Property::SCALE:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (speeds[i] != 0 && targets[i])
+                {
+                    targets[i]->setScale(from[0][i] + deltas[0][i] * times[i], from[1][i] + deltas[1][i] * times[i]);
+                }
+            }
+            break;
+        case Property::ROTATION:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (speeds[i] != 0 && targets[i])
+                {
+                    targets[i]->setRotation(from[0][i] + deltas[0][i] * times[i]);
+                }
+            }
+            break;
+        case Property::OPACITY:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (speeds[i] != 0 && targets[i])
+                {
+                    // the easing curves can overshoot
+                    targets[i]->setOpacity((GLubyte)clampf(from[0][i] + deltas[0][i] * times[i], 0, 255));
+                }
+            }
+            break;
+        case Property::COLOR:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (speeds[i] != 0 && targets[i])
+                {
+                    targets[i]->setColor(Color3B((GLubyte)clampf(from[0][i] + deltas[0][i] * times[i], 0, 255),
+                                                 (GLubyte)clampf(from[1][i] + deltas[1][i] * times[i], 0, 255),
+                                                 (GLubyte)clampf(from[2][i] + deltas[2][i] * times[i], 0, 255)));
+                }
+            }
+            break;
+    }
+}
+
+NS_CC_END
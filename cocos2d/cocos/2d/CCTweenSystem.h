@@ -0,0 +1,158 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCTWEENSYSTEM_H__
+#define __CCTWEENSYSTEM_H__
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/CCRef.h"
+#include "base/ccTypes.h"
+#include "math/Vec2.h"
+#include "2d/CCAction.h"
+#include "2d/CCTweenFunction.h"
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** @class TweenSystem
+ * @brief Animates the position, scale, rotation, opacity and color of many nodes, faster than the equivalent actions.
+ *
+ * Each tween is like a MoveTo, ScaleTo, RotateTo, FadeTo or TintTo wrapped in an ease action, but instead of being
+ * an object stepped by a virtual call, it is a row in arrays grouped by property and easing curve. The time and the
+ * easing of a group are computed in tight loops, and the values are written to the nodes in a single pass.
+ *
+ * The tweens are owned by the system: they can't be sequenced or repeated, they only run until their end or until
+ * they are removed. Like the actions, they retain their target, are paused with it, and are removed when it is
+ * cleaned up.
+ * @code
+ * auto tweens = Director::getInstance()->getTweenSystem();
+ * tweens->moveTo(sprite, 0.5f, Vec2(100, 100), tweenfunc::Quad_EaseOut);
+ * tweens->fadeTo(sprite, 0.5f, 0);
+ * @endcode
+ * @since v3.17
+ */
+class CC_DLL TweenSystem : public Ref
+{
+public:
+    /** The animated properties. */
+    enum class Property
+    {
+        POSITION,
+        SCALE,
+        ROTATION,
+        OPACITY,
+        COLOR,
+    };
+
+    TweenSystem();
+    virtual ~TweenSystem();
+
+    /** Moves a node to a position. */
+    void moveTo(Node* target, float duration, const Vec2& position, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Moves a node by an offset from its current position. */
+    void moveBy(Node* target, float duration, const Vec2& offset, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Scales a node to a scale. */
+    void scaleTo(Node* target, float duration, float scaleX, float scaleY, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Rotates a node to an angle in degrees, in the shortest direction like RotateTo. */
+    void rotateTo(Node* target, float duration, float angle, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Rotates a node by an angle in degrees from its current rotation. */
+    void rotateBy(Node* target, float duration, float angle, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Fades a node to an opacity. */
+    void fadeTo(Node* target, float duration, GLubyte opacity, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+    /** Tints a node to a color. */
+    void tintTo(Node* target, float duration, const Color3B& color, tweenfunc::TweenType easing = tweenfunc::Linear, int tag = Action::INVALID_TAG);
+
+    /** Removes all the tweens of a target. */
+    void removeAllTweensFromTarget(Node* target);
+    /** Removes the tweens of a target that have a tag. */
+    void removeTweensByTag(int tag, Node* target);
+    /** Removes all the tweens. */
+    void removeAllTweens();
+
+    /** Pauses the tweens of a target. */
+    void pauseTarget(Node* target);
+    /** Resumes the tweens of a target. */
+    void resumeTarget(Node* target);
+
+    /** Returns the number of tweens of a target. */
+    ssize_t getNumberOfRunningTweensInTarget(Node* target) const;
+    /** Returns the number of tweens. */
+    ssize_t getNumberOfRunningTweens() const { return _tweenCount; }
+
+    /** Advances the tweens. Called by the Scheduler every frame. */
+    void update(float dt);
+
+protected:
+    typedef float (*EasingFunction)(float);
+
+    // the tweens of a property with an easing curve, as a structure of arrays
+    struct Batch
+    {
+        Property property;
+        EasingFunction easingFunction;    // nullptr for linear
+        std::vector<Node*> targets;       // nullptr once removed during the update
+        std::vector<int> tags;
+        std::vector<float> elapsed;
+        std::vector<float> invDurations;
+        std::vector<float> speeds;        // 1 while running, 0 while paused
+        std::vector<float> from[3];
+        std::vector<float> deltas[3];
+        std::vector<float> times;         // eased times of the current update
+    };
+
+    static EasingFunction getEasingFunction(tweenfunc::TweenType easing);
+
+    void addTween(Property property, Node* target, float duration, const float* from, const float* to,
+                  tweenfunc::TweenType easing, int tag);
+    void removeTween(Batch* batch, size_t index);
+    void eraseTween(Batch* batch, size_t index);
+    void applyBatch(Batch* batch, size_t count);
+
+    std::vector<Batch*> _batches;
+    // batch index by property and easing
+    std::unordered_map<int, size_t> _batchIndices;
+    // number of tweens by target, to skip the targets without tweens quickly
+    std::unordered_map<Node*, int> _targetTweenCounts;
+    ssize_t _tweenCount;
+    bool _updating;
+    // the targets of the tweens removed during the update, released at its end like
+    // ActionManager does with the salvaged targets, since their setters may still be running
+    std::vector<Node*> _releasedTargets;
+};
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#endif // __CCTWEENSYSTEM_H__
@@ -10,8 +10,10 @@ LOCAL_ARM_MODE := arm
 
 ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
 MATHNEONFILE := math/MathUtil.cpp.neon
+PIXELNEONFILE := renderer/ccPixelConversion.cpp.neon
 else
 MATHNEONFILE := math/MathUtil.cpp
+PIXELNEONFILE := renderer/ccPixelConversion.cpp
 endif
 
 LOCAL_SRC_FILES := \
@@ -34,6 +36,7 @@ cocos2d.cpp \
 2d/CCAtlasNode.cpp \
 2d/CCCamera.cpp \
 2d/CCCameraBackgroundBrush.cpp \
+2d/CCSpatialIndex.cpp \
 2d/CCClippingNode.cpp \
 2d/CCClippingRectangleNode.cpp \
 2d/CCComponent.cpp \
@@ -86,10 +89,14 @@ cocos2d.cpp \
 2d/CCTransitionPageTurn.cpp \
 2d/CCTransitionProgress.cpp \
 2d/CCTweenFunction.cpp \
+2d/CCTweenSystem.cpp \
 2d/CCAutoPolygon.cpp \
 3d/CCFrustum.cpp \
 3d/CCPlane.cpp \
 platform/CCFileUtils.cpp \
+platform/CCFileArchive.cpp \
+platform/CCDecodedImageCache.cpp \
+platform/CCPlistParser.cpp \
 platform/CCGLView.cpp \
 platform/CCImage.cpp \
 platform/CCSAXParser.cpp \
@@ -107,6 +114,7 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCJobSystem.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -135,9 +143,13 @@ base/CCEventTouch.cpp \
 base/CCIMEDispatcher.cpp \
 base/CCNS.cpp \
 base/CCProfiling.cpp \
+base/CCFrameTracer.cpp \
+base/CCFrameArena.cpp \
+base/CCRefTracker.cpp \
 base/CCProperties.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
+base/CCFunctionQueue.cpp \
 base/CCScriptSupport.cpp \
 base/CCTouch.cpp \
 base/CCUserDefault-android.cpp \
@@ -180,12 +192,14 @@ renderer/CCTechnique.cpp \
 renderer/CCTexture2D.cpp \
 renderer/CCTextureAtlas.cpp \
 renderer/CCTextureCache.cpp \
+renderer/CCDynamicAtlas.cpp \
 renderer/CCTextureCube.cpp \
 renderer/CCTrianglesCommand.cpp \
 renderer/CCVertexAttribBinding.cpp \
 renderer/CCVertexIndexBuffer.cpp \
 renderer/CCVertexIndexData.cpp \
 renderer/ccGLStateCache.cpp \
+$(PIXELNEONFILE) \
 renderer/CCFrameBuffer.cpp \
 renderer/ccShaders.cpp \
 vr/CCVRDistortion.cpp \
@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCFrameTracer.h"
 
 NS_CC_BEGIN
 
@@ -45,12 +46,198 @@ void AsyncTaskPool::destroyInstance()
     s_asyncTaskPool = nullptr;
 }
 
+class AsyncTaskPool::ThreadTasks
+{
+    struct AsyncTaskCallBack
+    {
+        TaskCallBack          callback;
+        void*                 callbackParam;
+    };
+public:
+    explicit ThreadTasks(const std::string& name)
+    : _stop(false)
+    {
+        _thread = std::thread([this, name]
+        {
+#if CC_ENABLE_FRAME_TRACER
+            FrameTracer::getInstance()->setCurrentThreadName(name);
+#endif
+            for (;;)
+            {
+                std::function<void()> task;
+                AsyncTaskCallBack callback;
+                {
+                    std::unique_lock<std::mutex> lock(_queueMutex);
+                    _condition.wait(lock, [this]{ return _stop || !_tasks.empty(); });
+                    if (_stop && _tasks.empty())
+                        return;
+                    task = std::move(_tasks.front());
+                    callback = std::move(_taskCallBacks.front());
+                    _tasks.pop();
+                    _taskCallBacks.pop();
+                }
+
+                {
+                    CC_TRACE_SCOPE("AsyncTaskPool::task");
+                    task();
+                }
+                Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(callback.callback, callback.callbackParam));
+            }
+        });
+    }
+
+    ~ThreadTasks()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _stop = true;
+            clearLocked();
+        }
+        _condition.notify_all();
+        _thread.join();
+    }
+
+    void clear()
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        clearLocked();
+    }
+
+    void enqueue(TaskCallBack callback, void* callbackParam, std::function<void()> task)
+    {
+        AsyncTaskCallBack taskCallBack;
+        taskCallBack.callback = std::move(callback);
+        taskCallBack.callbackParam = callbackParam;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+
+            // don't allow enqueueing after stopping the pool
+            if (_stop)
+            {
+                CC_ASSERT(0 && "already stop");
+                return;
+            }
+
+            _tasks.push(std::move(task));
+            _taskCallBacks.push(std::move(taskCallBack));
+        }
+        _condition.notify_one();
+    }
+
+private:
+    void clearLocked()
+    {
+        while (_tasks.size())
+            _tasks.pop();
+        while (_taskCallBacks.size())
+            _taskCallBacks.pop();
+    }
+
+    // need to keep track of thread so we can join them
+    std::thread _thread;
+    // the task queue
+    std::queue< std::function<void()> > _tasks;
+    std::queue<AsyncTaskCallBack> _taskCallBacks;
+
+    // synchronization
+    std::mutex _queueMutex;
+    std::condition_variable _condition;
+    bool _stop;
+};
+
+struct AsyncTaskPool::TaskState
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    // incremented by stopTasks(), the tasks queued before are discarded
+    unsigned int generations[int(TaskType::TASK_MAX_TYPE)];
+    int runningTaskCount;
+    bool stopped;
+};
+
 AsyncTaskPool::AsyncTaskPool()
+: _state(std::make_shared<TaskState>())
 {
+    _threadTasks[int(TaskType::TASK_IO)] = new (std::nothrow) ThreadTasks("AsyncTaskPool IO");
+    _threadTasks[int(TaskType::TASK_NETWORK)] = new (std::nothrow) ThreadTasks("AsyncTaskPool network");
+    for (auto& generation : _state->generations)
+    {
+        generation = 0;
+    }
+    _state->runningTaskCount = 0;
+    _state->stopped = false;
 }
 
 AsyncTaskPool::~AsyncTaskPool()
 {
+    for (auto threadTasks : _threadTasks)
+    {
+        delete threadTasks;
+    }
+
+    // discard the tasks that are not started, and wait for the running ones
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->stopped = true;
+    _state->condition.wait(lock, [this]{ return _state->runningTaskCount == 0; });
+}
+
+void AsyncTaskPool::stopTasks(TaskType type)
+{
+    if (type < TaskType::TASK_OTHER)
+    {
+        _threadTasks[(int)type]->clear();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    ++_state->generations[(int)type];
+}
+
+void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, TaskCallBack callback, void* callbackParam, std::function<void()> task)
+{
+    if (type < TaskType::TASK_OTHER)
+    {
+        _threadTasks[(int)type]->enqueue(std::move(callback), callbackParam, std::move(task));
+        return;
+    }
+
+    auto state = _state;
+    unsigned int generation;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->stopped)
+        {
+            CC_ASSERT(0 && "already stop");
+            return;
+        }
+        generation = state->generations[(int)type];
+    }
+
+    // C++11 lambdas can't capture by move, share the task and the callback instead of copying them
+    auto work = std::make_shared<std::pair<std::function<void()>, TaskCallBack>>(std::move(task), std::move(callback));
+    JobSystem::getInstance()->enqueue([state, type, generation, work, callbackParam]() {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->stopped || state->generations[(int)type] != generation)
+                return;
+            ++state->runningTaskCount;
+        }
+
+        {
+            CC_TRACE_SCOPE("AsyncTaskPool::task");
+            work->first();
+        }
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(work->second, callbackParam));
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->runningTaskCount;
+        state->condition.notify_all();
+    });
+}
+
+void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, std::function<void()> task)
+{
+    enqueue(type, [](void*) {}, nullptr, std::move(task));
 }
 
 NS_CC_END
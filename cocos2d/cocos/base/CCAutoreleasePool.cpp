@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
+#include "base/CCRefTracker.h"
 
 NS_CC_BEGIN
 
@@ -68,10 +69,17 @@ void AutoreleasePool::clear()
 #endif
     std::vector<Ref*> releasings;
     releasings.swap(_managedObjectArray);
+#if CC_ENABLE_REF_TRACKING
+    RefTracker::trackPoolClear(releasings.size());
+#endif
+    // reuse the buffer of the previous clear, instead of growing a new one
+    _managedObjectArray.swap(_releasingObjectArray);
     for (const auto &obj : releasings)
     {
         obj->release();
     }
+    releasings.clear();
+    _releasingObjectArray.swap(releasings);
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
@@ -134,6 +134,8 @@ private:
      * is in the pool.
      */
     std::vector<Ref*> _managedObjectArray;
+    /** The buffer of the objects released by the last clear, reused by the next one. */
+    std::vector<Ref*> _releasingObjectArray;
     std::string _name;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
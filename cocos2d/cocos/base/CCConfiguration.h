@@ -171,6 +171,24 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not glMapBufferRange() is supported.
+     *
+     * Checks for the extensions `GL_ARB_map_buffer_range` or `GL_EXT_map_buffer_range`.
+     *
+     * @return Whether or not `glMapBufferRange()` is supported.
+     * @since v3.17
+     */
+    bool supportsMapBufferRange() const;
+
+    /** Whether or not sync objects (glFenceSync(), glClientWaitSync()) are supported.
+     *
+     * Checks for the extension `GL_ARB_sync`.
+     *
+     * @return Whether or not sync objects are supported.
+     * @since v3.17
+     */
+    bool supportsSyncObjects() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -259,6 +277,8 @@ protected:
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
     bool            _supportsOESMapBuffer;
+    bool            _supportsMapBufferRange;
+    bool            _supportsSyncObjects;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
     
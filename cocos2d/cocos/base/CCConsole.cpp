@@ -26,6 +26,8 @@
 #include "base/CCConsole.h"
 
 #include <thread>
+#include <chrono>
+#include <vector>
 #include <algorithm>
 #include <functional>
 #include <cctype>
@@ -69,6 +71,10 @@
 #include "base/base64.h"
 #include "base/ccUtils.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
+#include "base/CCFrameTracer.h"
+#include "base/CCFrameArena.h"
+#include "base/CCRefTracker.h"
+#include "renderer/ccPixelConversion.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion(void);
@@ -500,12 +506,16 @@ Console::Console()
     createCommandExit();
     createCommandFileUtils();
     createCommandFps();
+    createCommandFrame();
     createCommandHelp();
+    createCommandPixels();
     createCommandProjection();
+    createCommandRefs();
     createCommandResolution();
     createCommandSceneGraph();
     createCommandTexture();
     createCommandTouch();
+    createCommandTrace();
     createCommandUpload();
     createCommandVersion();
 }
@@ -1076,11 +1086,23 @@ void Console::createCommandFps()
     addSubCommand("fps", {"off", "Hide the FPS on the bottom-left corner.", CC_CALLBACK_2(Console::commandFpsSubCommandOnOff, this)});
 }
 
+void Console::createCommandFrame()
+{
+    addCommand({"frame", "Display the allocation counters of the last frame. Args: [-h | help | ]",
+        CC_CALLBACK_2(Console::commandFrame, this)});
+}
+
 void Console::createCommandHelp()
 {
     addCommand({"help", "Print this message. Args: [ ]", CC_CALLBACK_2(Console::commandHelp, this)});
 }
 
+void Console::createCommandPixels()
+{
+    addCommand({"pixels", "Compare the SIMD pixel conversions to the scalar code and print their speed. Args: [-h | help | ]",
+        CC_CALLBACK_2(Console::commandPixels, this)});
+}
+
 void Console::createCommandProjection()
 {
     addCommand({"projection", "Change or print the current projection. Args: [-h | help | 2d | 3d | ]",
@@ -1091,6 +1113,14 @@ void Console::createCommandProjection()
         CC_CALLBACK_2(Console::commandProjectionSubCommand3d, this)});
 }
 
+void Console::createCommandRefs()
+{
+    addCommand({"refs", "Display the allocations of the Ref objects by class. Args: [-h | help | save filename | ]",
+        CC_CALLBACK_2(Console::commandRefs, this)});
+    addSubCommand("refs", {"save", "refs save filename: save the report of the Ref allocations in the writable path.",
+        CC_CALLBACK_2(Console::commandRefsSubCommandSave, this)});
+}
+
 void Console::createCommandResolution()
 {
     addCommand({"resolution", "Change or print the window resolution. Args: [-h | help | width height resolution_policy | ]",
@@ -1120,6 +1150,18 @@ void Console::createCommandTouch()
         CC_CALLBACK_2(Console::commandTouchSubCommandSwipe, this)});
 }
 
+void Console::createCommandTrace()
+{
+    addCommand({"trace", "Record the frame timeline. Args: [-h | help | start | stop | save filename | ]",
+        CC_CALLBACK_2(Console::commandTrace, this)});
+    addSubCommand("trace", {"start", "Start recording the frame timeline.",
+        CC_CALLBACK_2(Console::commandTraceSubCommandStartStop, this)});
+    addSubCommand("trace", {"stop", "Stop recording the frame timeline.",
+        CC_CALLBACK_2(Console::commandTraceSubCommandStartStop, this)});
+    addSubCommand("trace", {"save", "trace save filename: save the frame timeline in the writable path, in Chrome trace event format.",
+        CC_CALLBACK_2(Console::commandTraceSubCommandSave, this)});
+}
+
 void Console::createCommandUpload()
 {
     addCommand({"upload", "upload file. Args: [filename base64_encoded_data]", CC_CALLBACK_1(Console::commandUpload, this)});
@@ -1234,11 +1276,120 @@ void Console::commandFpsSubCommandOnOff(int /*fd*/, const std::string& args)
     sched->performFunctionInCocosThread( std::bind(&Director::setDisplayStats, dir, state));
 }
 
+void Console::commandFrame(int fd, const std::string& /*args*/)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto& stats = FrameArena::getInstance()->getLastFrameStats();
+        Console::Utility::mydprintf(fd, "frame arena: %d allocations, %d bytes, %d chunks allocated, capacity %d bytes\n",
+                                    (int)stats.allocationCount, (int)stats.bytesAllocated, (int)stats.chunkAllocationCount, (int)stats.capacity);
+#if CC_ENABLE_HEAP_COUNTERS
+        Console::Utility::mydprintf(fd, "heap: %d allocations, %d deallocations, %d bytes\n",
+                                    (int)stats.heapAllocationCount, (int)stats.heapDeallocationCount, (int)stats.heapBytesAllocated);
+#else
+        Console::Utility::mydprintf(fd, "heap counters not available. CC_ENABLE_HEAP_COUNTERS must be set to 1 in ccConfig.h\n");
+#endif
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandHelp(int fd, const std::string& /*args*/)
 {
     sendHelp(fd, _commands, "\nAvailable commands:\n");
 }
 
+namespace
+{
+    struct PixelKernel
+    {
+        const char* name;
+        int inBytesPerPixel;
+        int outBytesPerPixel;
+        void (*convert)(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    };
+
+    // premultiplyAlpha() works in place, the copy is timed with it
+    void premultiplyAlphaCopy(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        memcpy(outData, data, dataLen);
+        PixelConversion::premultiplyAlpha(outData, dataLen / 4);
+    }
+
+    const PixelKernel s_pixelKernels[] = {
+        { "premultiply RGBA8888", 4, 4, premultiplyAlphaCopy },
+        { "RGBA8888 -> RGB565", 4, 2, PixelConversion::convertRGBA8888ToRGB565 },
+        { "RGBA8888 -> RGBA4444", 4, 2, PixelConversion::convertRGBA8888ToRGBA4444 },
+        { "RGBA8888 -> RGB5A1", 4, 2, PixelConversion::convertRGBA8888ToRGB5A1 },
+        { "RGBA8888 -> RGB888", 4, 3, PixelConversion::convertRGBA8888ToRGB888 },
+        { "RGBA8888 -> A8", 4, 1, PixelConversion::convertRGBA8888ToA8 },
+        { "RGB888 -> RGBA8888", 3, 4, PixelConversion::convertRGB888ToRGBA8888 },
+        { "RGB888 -> RGB565", 3, 2, PixelConversion::convertRGB888ToRGB565 },
+        { "RGB888 -> RGBA4444", 3, 2, PixelConversion::convertRGB888ToRGBA4444 },
+        { "RGB888 -> RGB5A1", 3, 2, PixelConversion::convertRGB888ToRGB5A1 },
+    };
+
+    // Returns the speed of a conversion in MB/s of input
+    double timePixelKernel(const PixelKernel& kernel, const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        const int iterations = 8;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            kernel.convert(data, dataLen, outData);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() > 0 ? iterations * dataLen / (elapsed.count() * 1024 * 1024) : 0;
+    }
+}
+
+void Console::commandPixels(int fd, const std::string& /*args*/)
+{
+    // An odd count, so the scalar code converts the pixels the SIMD kernels leave
+    const ssize_t pixelCount = 1024 * 1024 + 7;
+
+    if (!PixelConversion::isSIMDAvailable())
+    {
+        Console::Utility::mydprintf(fd, "SIMD pixel conversions not available, only the scalar code is used\n");
+        return;
+    }
+
+    // Every byte value, alpha 0 and 255 included
+    std::vector<unsigned char> data(pixelCount * 4);
+    uint32_t seed = 0x12345678;
+    for (auto& byte : data)
+    {
+        seed = seed * 1664525 + 1013904223;
+        byte = static_cast<unsigned char>(seed >> 24);
+    }
+    std::vector<unsigned char> scalarData(pixelCount * 4);
+    std::vector<unsigned char> simdData(pixelCount * 4);
+
+    // The setting is global, the other threads convert with the scalar code while it runs
+    bool simdEnabled = PixelConversion::isSIMDEnabled();
+    bool allExact = true;
+    for (const auto& kernel : s_pixelKernels)
+    {
+        ssize_t dataLen = pixelCount * kernel.inBytesPerPixel;
+        ssize_t outLen = pixelCount * kernel.outBytesPerPixel;
+        memset(scalarData.data(), 0, outLen);
+        memset(simdData.data(), 0xff, outLen);
+
+        PixelConversion::setSIMDEnabled(false);
+        double scalarSpeed = timePixelKernel(kernel, data.data(), dataLen, scalarData.data());
+        PixelConversion::setSIMDEnabled(true);
+        double simdSpeed = timePixelKernel(kernel, data.data(), dataLen, simdData.data());
+
+        bool exact = memcmp(scalarData.data(), simdData.data(), outLen) == 0;
+        allExact = allExact && exact;
+        Console::Utility::mydprintf(fd, "%-22s scalar %8.1f MB/s, SIMD %8.1f MB/s (x%.2f), %s\n",
+                                    kernel.name, scalarSpeed, simdSpeed, scalarSpeed > 0 ? simdSpeed / scalarSpeed : 0.0,
+                                    exact ? "bit-exact" : "MISMATCH");
+    }
+    PixelConversion::setSIMDEnabled(simdEnabled);
+
+    Console::Utility::mydprintf(fd, "%s\n", allExact ? "all the conversions match the scalar code" : "some conversions don't match the scalar code");
+}
+
 void Console::commandProjection(int fd, const std::string& /*args*/)
 {
     auto director = Director::getInstance();
@@ -1280,6 +1431,39 @@ void Console::commandProjectionSubCommand3d(int /*fd*/, const std::string& /*arg
     } );
 }
 
+void Console::commandRefs(int fd, const std::string& /*args*/)
+{
+#if CC_ENABLE_REF_TRACKING
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        Console::Utility::mydprintf(fd, "%s", RefTracker::getReport().c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+#else
+    Console::Utility::mydprintf(fd, "Ref tracking not available. CC_ENABLE_REF_TRACKING must be set to 1 in ccConfig.h\n");
+#endif
+}
+
+void Console::commandRefsSubCommandSave(int fd, const std::string& args)
+{
+#if CC_ENABLE_REF_TRACKING
+    auto argv = Console::Utility::split(args, ' ');
+    std::string filename = argv.size() >= 2 ? argv[1] : "refs.txt";
+
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        std::string fullPath = RefTracker::saveReport(filename);
+        if (fullPath.empty())
+            Console::Utility::mydprintf(fd, "refs: couldn't save %s\n", filename.c_str());
+        else
+            Console::Utility::mydprintf(fd, "refs saved to %s\n", fullPath.c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+#else
+    Console::Utility::mydprintf(fd, "Ref tracking not available. CC_ENABLE_REF_TRACKING must be set to 1 in ccConfig.h\n");
+#endif
+}
+
 void Console::commandResolution(int /*fd*/, const std::string& args)
 {
     int width, height, policy;
@@ -1343,6 +1527,39 @@ void Console::commandTexturesSubCommandFlush(int /*fd*/, const std::string& /*ar
     });
 }
 
+void Console::commandTrace(int fd, const std::string& /*args*/)
+{
+#if CC_ENABLE_FRAME_TRACER
+    Console::Utility::mydprintf(fd, "Frame tracer is: %s\n", FrameTracer::isRecording() ? "recording" : "stopped");
+#else
+    Console::Utility::mydprintf(fd, "frame tracer not available. CC_ENABLE_FRAME_TRACER must be set to 1 in ccConfig.h\n");
+#endif
+}
+
+void Console::commandTraceSubCommandStartStop(int /*fd*/, const std::string& args)
+{
+    if (args.compare("start") == 0)
+        FrameTracer::getInstance()->start();
+    else
+        FrameTracer::getInstance()->stop();
+}
+
+void Console::commandTraceSubCommandSave(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+    std::string filename = argv.size() >= 2 ? argv[1] : "trace.json";
+
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        std::string fullPath = FrameTracer::getInstance()->saveChromeTrace(filename);
+        if (fullPath.empty())
+            Console::Utility::mydprintf(fd, "trace: couldn't save %s\n", filename.c_str());
+        else
+            Console::Utility::mydprintf(fd, "trace saved to %s\n", fullPath.c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandTouchSubCommandTap(int fd, const std::string& args)
 {
     auto argv = Console::Utility::split(args,' ');
@@ -1594,7 +1811,7 @@ void Console::printFileUtils(int fd)
     Console::Utility::mydprintf(fd, "%s\n", fu->getWritablePath().c_str());
     
     Console::Utility::mydprintf(fd, "\nFull Path Cache:\n");
-    auto& cache = fu->getFullPathCache();
+    auto cache = fu->getFullPathCache();
     for( const auto &item : cache) {
         Console::Utility::mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.c_str());
     }
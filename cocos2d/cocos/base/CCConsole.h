@@ -233,12 +233,16 @@ protected:
     void createCommandExit();
     void createCommandFileUtils();
     void createCommandFps();
+    void createCommandFrame();
     void createCommandHelp();
+    void createCommandPixels();
     void createCommandProjection();
+    void createCommandRefs();
     void createCommandResolution();
     void createCommandSceneGraph();
     void createCommandTexture();
     void createCommandTouch();
+    void createCommandTrace();
     void createCommandUpload();
     void createCommandVersion();
 
@@ -257,10 +261,14 @@ protected:
     void commandFileUtilsSubCommandFlush(int fd, const std::string& args);
     void commandFps(int fd, const std::string& args);
     void commandFpsSubCommandOnOff(int fd, const std::string& args);
+    void commandFrame(int fd, const std::string& args);
     void commandHelp(int fd, const std::string& args);
+    void commandPixels(int fd, const std::string& args);
     void commandProjection(int fd, const std::string& args);
     void commandProjectionSubCommand2d(int fd, const std::string& args);
     void commandProjectionSubCommand3d(int fd, const std::string& args);
+    void commandRefs(int fd, const std::string& args);
+    void commandRefsSubCommandSave(int fd, const std::string& args);
     void commandResolution(int fd, const std::string& args);
     void commandResolutionSubCommandEmpty(int fd, const std::string& args);
     void commandSceneGraph(int fd, const std::string& args);
@@ -268,6 +276,9 @@ protected:
     void commandTexturesSubCommandFlush(int fd, const std::string& args);
     void commandTouchSubCommandTap(int fd, const std::string& args);
     void commandTouchSubCommandSwipe(int fd, const std::string& args);
+    void commandTrace(int fd, const std::string& args);
+    void commandTraceSubCommandStartStop(int fd, const std::string& args);
+    void commandTraceSubCommandSave(int fd, const std::string& args);
     void commandUpload(int fd);
     void commandVersion(int fd, const std::string& args);
     // file descriptor: socket, console, etc.
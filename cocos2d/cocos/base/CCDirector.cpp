@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 
 #include "2d/CCActionManager.h"
+#include "2d/CCTweenSystem.h"
 #include "2d/CCFontFNT.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCAnimationCache.h"
@@ -61,6 +62,10 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameTracer.h"
+#include "base/CCFrameArena.h"
+#include "base/CCRefTracker.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -125,6 +130,10 @@ bool Director::init(void)
 {
     setDefaultValues();
 
+#if CC_ENABLE_FRAME_TRACER
+    FrameTracer::getInstance()->setCurrentThreadName("Main");
+#endif
+
     // scenes
     _runningScene = nullptr;
     _nextScene = nullptr;
@@ -169,6 +178,9 @@ bool Director::init(void)
     // action manager
     _actionManager = new (std::nothrow) ActionManager();
     _scheduler->scheduleUpdate(_actionManager, Scheduler::PRIORITY_SYSTEM, false);
+    // tween system
+    _tweenSystem = new (std::nothrow) TweenSystem();
+    _scheduler->scheduleUpdate(_tweenSystem, Scheduler::PRIORITY_SYSTEM, false);
 
     _eventDispatcher = new (std::nothrow) EventDispatcher();
     
@@ -214,6 +226,7 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_notificationNode);
     CC_SAFE_RELEASE(_scheduler);
     CC_SAFE_RELEASE(_actionManager);
+    CC_SAFE_RELEASE(_tweenSystem);
     CC_SAFE_DELETE(_defaultFBO);
 
     CC_SAFE_RELEASE(_beforeSetNextScene);
@@ -286,6 +299,8 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_TRACE_SCOPE("Director::drawScene");
+
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -302,6 +317,7 @@ void Director::drawScene()
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
     }
 
+    _renderer->beginFrame();
     _renderer->clear();
     experimental::FrameBuffer::clearAllFBOs();
     
@@ -327,7 +343,10 @@ void Director::drawScene()
         
         //render the scene
         if(_openGLView)
+        {
+            CC_TRACE_SCOPE("Director::visit");
             _openGLView->renderScene(_runningScene, _renderer);
+        }
         
         _eventDispatcher->dispatchEvent(_eventAfterVisit);
     }
@@ -348,6 +367,7 @@ void Director::drawScene()
     }
     
     _renderer->render();
+    _renderer->endFrame();
 
     _eventDispatcher->dispatchEvent(_eventAfterDraw);
 
@@ -358,6 +378,7 @@ void Director::drawScene()
     // swap buffers
     if (_openGLView)
     {
+        CC_TRACE_SCOPE("GLView::swapBuffers");
         _openGLView->swapBuffers();
     }
 
@@ -734,7 +755,15 @@ void Director::purgeCachedData(void)
     if (s_SharedDirector->getOpenGLView())
     {
         SpriteFrameCache::getInstance()->removeUnusedSpriteFrames();
-        _textureCache->removeUnusedTextures();
+        if (_textureCache->getMemoryBudget() > 0)
+        {
+            // keep the most recently used textures, within half of the budget
+            _textureCache->removeUnusedTextures(_textureCache->getMemoryBudget() / 2);
+        }
+        else
+        {
+            _textureCache->removeUnusedTextures();
+        }
 
         // Note: some tests such as ActionsTest are leaking refcounted textures
         // There should be no test textures left in the cache
@@ -1147,6 +1176,9 @@ void Director::reset()
     RenderState::finalize();
     
     destroyTextureCache();
+
+    // after the texture cache, that waits for its jobs
+    JobSystem::destroyInstance();
 }
 
 void Director::purgeDirector()
@@ -1181,6 +1213,7 @@ void Director::restartDirector()
     
     // Reschedule for action manager
     getScheduler()->scheduleUpdate(getActionManager(), Scheduler::PRIORITY_SYSTEM, false);
+    getScheduler()->scheduleUpdate(getTweenSystem(), Scheduler::PRIORITY_SYSTEM, false);
     
     // release the objects
     PoolManager::getInstance()->getCurrentPool()->clear();
@@ -1518,6 +1551,13 @@ void Director::mainLoop()
      
         // release the objects
         PoolManager::getInstance()->getCurrentPool()->clear();
+
+        // the temporary data of the frame
+        FrameArena::getInstance()->reset();
+
+#if CC_ENABLE_REF_TRACKING
+        RefTracker::endFrame();
+#endif
     }
 }
 
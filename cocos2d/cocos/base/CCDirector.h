@@ -55,6 +55,7 @@ class DirectorDelegate;
 class Node;
 class Scheduler;
 class ActionManager;
+class TweenSystem;
 class EventDispatcher;
 class EventCustom;
 class EventListenerCustom;
@@ -436,6 +437,11 @@ public:
      * @since v2.0
      */
     void setActionManager(ActionManager* actionManager);
+
+    /** Gets the TweenSystem associated with this director.
+     * @since v3.17
+     */
+    TweenSystem* getTweenSystem() const { return _tweenSystem; }
     
     /** Gets the EventDispatcher associated with this director.
      * @since v3.0
@@ -631,6 +637,11 @@ protected:
      @since v2.0
      */
     ActionManager *_actionManager;
+
+    /** TweenSystem associated with this director
+     @since v3.17
+     */
+    TweenSystem *_tweenSystem;
     
     /** EventDispatcher associated with this director
      @since v3.0
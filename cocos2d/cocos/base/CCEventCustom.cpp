@@ -25,13 +25,18 @@
 
 #include "base/CCEventCustom.h"
 #include "base/CCEvent.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_OBJECT_POOL(EventCustom, 32, locking_semantics)
+
 EventCustom::EventCustom(const std::string& eventName)
 : Event(Type::CUSTOM)
 , _userData(nullptr)
 , _eventName(eventName)
+, _listenerKey(-1)
+, _listenerKeyGeneration(0)
 {
 }
 
@@ -28,6 +28,7 @@
 
 #include <string>
 #include "base/CCEvent.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 /**
  * @addtogroup base
@@ -42,6 +43,8 @@ NS_CC_BEGIN
 class CC_DLL EventCustom : public Event
 {
 public:
+    CC_DECLARE_OBJECT_POOL(EventCustom)
+
     /** Constructor.
      *
      * @param eventName A given name of the custom event.
@@ -69,6 +72,11 @@ public:
 protected:
     void* _userData;       ///< User data
     std::string _eventName;
+    // the key of the listeners of the event name, valid while the generation is the one of the dispatcher
+    int _listenerKey;
+    unsigned int _listenerKeyGeneration;
+
+    friend class EventDispatcher;
 };
 
 NS_CC_END
@@ -32,6 +32,7 @@
 #include "base/CCEventListenerKeyboard.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventListenerFocus.h"
+#include "base/CCFrameArena.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
 #include "base/CCEventListenerController.h"
 #endif
@@ -67,28 +68,49 @@ private:
 
 NS_CC_BEGIN
 
-static EventListener::ListenerID __getListenerID(Event* event)
+// the last generation of the listener keys of all the dispatchers
+static unsigned int __listenerKeysGeneration = 0;
+
+static EventListener::ListenerKey __getTouchOneByOneListenerKey()
+{
+    static const EventListener::ListenerKey key = EventListener::getListenerKey(EventListenerTouchOneByOne::LISTENER_ID);
+    return key;
+}
+
+static EventListener::ListenerKey __getTouchAllAtOnceListenerKey()
+{
+    static const EventListener::ListenerKey key = EventListener::getListenerKey(EventListenerTouchAllAtOnce::LISTENER_ID);
+    return key;
+}
+
+static EventListener::ListenerKey __getListenerKey(Event* event)
 {
-    EventListener::ListenerID ret;
+    static const EventListener::ListenerKey accelerationKey = EventListener::getListenerKey(EventListenerAcceleration::LISTENER_ID);
+    static const EventListener::ListenerKey keyboardKey = EventListener::getListenerKey(EventListenerKeyboard::LISTENER_ID);
+    static const EventListener::ListenerKey mouseKey = EventListener::getListenerKey(EventListenerMouse::LISTENER_ID);
+    static const EventListener::ListenerKey focusKey = EventListener::getListenerKey(EventListenerFocus::LISTENER_ID);
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    static const EventListener::ListenerKey controllerKey = EventListener::getListenerKey(EventListenerController::LISTENER_ID);
+#endif
+
+    EventListener::ListenerKey ret = -1;
     switch (event->getType())
     {
         case Event::Type::ACCELERATION:
-            ret = EventListenerAcceleration::LISTENER_ID;
+            ret = accelerationKey;
             break;
         case Event::Type::CUSTOM:
-            {
-                auto customEvent = static_cast<EventCustom*>(event);
-                ret = customEvent->getEventName();
-            }
+            // Resolved by EventDispatcher::findListenerKey(), without interning the name
+            CCASSERT(false, "Don't call this method if the event is a custom event.");
             break;
         case Event::Type::KEYBOARD:
-            ret = EventListenerKeyboard::LISTENER_ID;
+            ret = keyboardKey;
             break;
         case Event::Type::MOUSE:
-            ret = EventListenerMouse::LISTENER_ID;
+            ret = mouseKey;
             break;
         case Event::Type::FOCUS:
-            ret = EventListenerFocus::LISTENER_ID;
+            ret = focusKey;
             break;
         case Event::Type::TOUCH:
             // Touch listener is very special, it contains two kinds of listeners, EventListenerTouchOneByOne and EventListenerTouchAllAtOnce.
@@ -97,7 +119,7 @@ static EventListener::ListenerID __getListenerID(Event* event)
             break;
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
         case Event::Type::GAME_CONTROLLER:
-            ret = EventListenerController::LISTENER_ID;
+            ret = controllerKey;
             break;
 #endif
         default:
@@ -200,7 +222,8 @@ void EventDispatcher::EventListenerVector::clear()
 
 
 EventDispatcher::EventDispatcher()
-: _inDispatch(0)
+: _listenerKeysGeneration(++__listenerKeysGeneration)
+, _inDispatch(0)
 , _isEnabled(false)
 , _nodePriorityIndex(0)
 {
@@ -209,9 +232,9 @@ EventDispatcher::EventDispatcher()
     
     // fixed #4129: Mark the following listener IDs for internal use.
     // Therefore, internal listeners would not be cleaned when removeAllEventListeners is invoked.
-    _internalCustomListenerIDs.insert(EVENT_COME_TO_FOREGROUND);
-    _internalCustomListenerIDs.insert(EVENT_COME_TO_BACKGROUND);
-    _internalCustomListenerIDs.insert(EVENT_RENDERER_RECREATED);
+    _internalCustomListenerIDs.insert(EventListener::getListenerKey(EVENT_COME_TO_FOREGROUND));
+    _internalCustomListenerIDs.insert(EventListener::getListenerKey(EVENT_COME_TO_BACKGROUND));
+    _internalCustomListenerIDs.insert(EventListener::getListenerKey(EVENT_RENDERER_RECREATED));
 }
 
 EventDispatcher::~EventDispatcher()
@@ -267,7 +290,7 @@ void EventDispatcher::visitTarget(Node* node, bool isRootNode)
     
     if (isRootNode)
     {
-        std::vector<float> globalZOrders;
+        FrameVector<float> globalZOrders;
         globalZOrders.reserve(_globalZOrderNodeMap.size());
         
         for (const auto& e : _globalZOrderNodeMap)
@@ -443,6 +466,11 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
 
 void EventDispatcher::addEventListener(EventListener* listener)
 {
+    if (_listenerKeys.emplace(listener->getListenerID(), listener->getListenerKey()).second)
+    {
+        _listenerKeysGeneration = ++__listenerKeysGeneration;
+    }
+    
     if (_inDispatch == 0)
     {
         forceAddEventListener(listener);
@@ -464,13 +492,12 @@ void EventDispatcher::addEventListener(EventListener* listener)
 void EventDispatcher::forceAddEventListener(EventListener* listener)
 {
     EventListenerVector* listeners = nullptr;
-    EventListener::ListenerID listenerID = listener->getListenerID();
-    auto itr = _listenerMap.find(listenerID);
+    EventListener::ListenerKey listenerKey = listener->getListenerKey();
+    auto itr = _listenerMap.find(listenerKey);
     if (itr == _listenerMap.end())
     {
-        
         listeners = new (std::nothrow) EventListenerVector();
-        _listenerMap.emplace(listenerID, listeners);
+        _listenerMap.emplace(listenerKey, listeners);
     }
     else
     {
@@ -481,7 +508,7 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     
     if (listener->getFixedPriority() == 0)
     {
-        setDirty(listenerID, DirtyFlag::SCENE_GRAPH_PRIORITY);
+        setDirty(listenerKey, DirtyFlag::SCENE_GRAPH_PRIORITY);
         
         auto node = listener->getAssociatedNode();
         CCASSERT(node != nullptr, "Invalid scene graph priority!");
@@ -495,7 +522,7 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     }
     else
     {
-        setDirty(listenerID, DirtyFlag::FIXED_PRIORITY);
+        setDirty(listenerKey, DirtyFlag::FIXED_PRIORITY);
     }
 }
 
@@ -645,7 +672,9 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         }
     };
     
-    for (auto iter = _listenerMap.begin(); iter != _listenerMap.end();)
+    // The listener can only be in the list of its own listener ID
+    auto iter = _listenerMap.find(listener->getListenerKey());
+    if (iter != _listenerMap.end())
     {
         auto listeners = iter->second;
         auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -655,14 +684,14 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         if (isFound)
         {
             // fixed #4160: Dirty flag need to be updated after listeners were removed.
-            setDirty(listener->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+            setDirty(listener->getListenerKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
         }
         else
         {
             removeListenerInVector(fixedPriorityListeners);
             if (isFound)
             {
-                setDirty(listener->getListenerID(), DirtyFlag::FIXED_PRIORITY);
+                setDirty(listener->getListenerKey(), DirtyFlag::FIXED_PRIORITY);
             }
         }
         
@@ -680,18 +709,11 @@ void EventDispatcher::removeEventListener(EventListener* listener)
 
         if (iter->second->empty())
         {
-            _priorityDirtyFlagMap.erase(listener->getListenerID());
+            _priorityDirtyFlagMap.erase(listener->getListenerKey());
             auto list = iter->second;
-            iter = _listenerMap.erase(iter);
+            _listenerMap.erase(iter);
             CC_SAFE_DELETE(list);
         }
-        else
-        {
-            ++iter;
-        }
-        
-        if (isFound)
-            break;
     }
 
     if (isFound)
@@ -718,9 +740,10 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
     if (listener == nullptr)
         return;
     
-    for (auto& iter : _listenerMap)
+    auto iter = _listenerMap.find(listener->getListenerKey());
+    if (iter != _listenerMap.end())
     {
-        auto fixedPriorityListeners = iter.second->getFixedPriorityListeners();
+        auto fixedPriorityListeners = iter->second->getFixedPriorityListeners();
         if (fixedPriorityListeners)
         {
             auto found = std::find(fixedPriorityListeners->begin(), fixedPriorityListeners->end(), listener);
@@ -731,7 +754,7 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
                 if (listener->getFixedPriority() != fixedPriority)
                 {
                     listener->setFixedPriority(fixedPriority);
-                    setDirty(listener->getListenerID(), DirtyFlag::FIXED_PRIORITY);
+                    setDirty(listener->getListenerKey(), DirtyFlag::FIXED_PRIORITY);
                 }
                 return;
             }
@@ -739,7 +762,8 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
     }
 }
 
-void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+template <typename OnEvent>
+void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -801,7 +825,8 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, c
     }
 }
 
-void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+template <typename OnEvent>
+void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -835,21 +860,25 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
             // priority == 0, scene graph priority
             
             // first, get all enabled, unPaused and registered listeners
-            std::vector<EventListener*> sceneListeners;
+            // The scratch vectors are only appended to, a dispatch from a listener callback uses the part after this one
+            const size_t listenersBegin = _sceneListenersScratch.size();
             for (auto& l : *sceneGraphPriorityListeners)
             {
                 if (l->isEnabled() && !l->isPaused() && l->isRegistered())
                 {
-                    sceneListeners.push_back(l);
+                    _sceneListenersScratch.push_back(l);
                 }
             }
+            const size_t listenersEnd = _sceneListenersScratch.size();
             // second, for all camera call all listeners
             // get a copy of cameras, prevent it's been modified in listener callback
             // if camera's depth is greater, process it earlier
-            auto cameras = scene->getCameras();
-            for (auto rit = cameras.rbegin(), ritRend = cameras.rend(); rit != ritRend; ++rit)
+            const size_t camerasBegin = _camerasScratch.size();
+            const auto& cameras = scene->getCameras();
+            _camerasScratch.insert(_camerasScratch.end(), cameras.begin(), cameras.end());
+            for (size_t c = _camerasScratch.size(); c > camerasBegin; --c)
             {
-                Camera* camera = *rit;
+                Camera* camera = _camerasScratch[c - 1];
                 if (camera->isVisible() == false)
                 {
                     continue;
@@ -857,8 +886,9 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
                 
                 Camera::_visitingCamera = camera;
                 auto cameraFlag = (unsigned short)camera->getCameraFlag();
-                for (auto& l : sceneListeners)
+                for (size_t j = listenersBegin; j < listenersEnd; ++j)
                 {
+                    auto l = _sceneListenersScratch[j];
                     if (nullptr == l->getAssociatedNode() || 0 == (l->getAssociatedNode()->getCameraMask() & cameraFlag))
                     {
                         continue;
@@ -875,6 +905,8 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
                 }
             }
             Camera::_visitingCamera = nullptr;
+            _camerasScratch.resize(camerasBegin);
+            _sceneListenersScratch.resize(listenersBegin);
         }
     }
     
@@ -898,6 +930,10 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
     }
 }
 
+// The callbacks used to be passed as std::function, keep these versions available
+template void EventDispatcher::dispatchEventToListeners(EventListenerVector*, const std::function<bool(EventListener*)>&);
+template void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector*, const std::function<bool(EventListener*)>&);
+
 void EventDispatcher::dispatchEvent(Event* event)
 {
     if (!_isEnabled)
@@ -914,15 +950,11 @@ void EventDispatcher::dispatchEvent(Event* event)
         return;
     }
     
-    auto listenerID = __getListenerID(event);
+    auto listenerKey = getListenerKey(event);
     
-    sortEventListeners(listenerID);
+    sortEventListeners(listenerKey);
     
-    auto pfnDispatchEventToListeners = &EventDispatcher::dispatchEventToListeners;
-    if (event->getType() == Event::Type::MOUSE) {
-        pfnDispatchEventToListeners = &EventDispatcher::dispatchTouchEventToListeners;
-    }
-    auto iter = _listenerMap.find(listenerID);
+    auto iter = _listenerMap.find(listenerKey);
     if (iter != _listenerMap.end())
     {
         auto listeners = iter->second;
@@ -933,7 +965,14 @@ void EventDispatcher::dispatchEvent(Event* event)
             return event->isStopped();
         };
         
-        (this->*pfnDispatchEventToListeners)(listeners, onEvent);
+        if (event->getType() == Event::Type::MOUSE)
+        {
+            dispatchTouchEventToListeners(listeners, onEvent);
+        }
+        else
+        {
+            dispatchEventToListeners(listeners, onEvent);
+        }
     }
     
     updateListeners(event);
@@ -948,16 +987,19 @@ void EventDispatcher::dispatchCustomEvent(const std::string &eventName, void *op
 
 bool EventDispatcher::hasEventListener(const EventListener::ListenerID& listenerID) const
 {
-    return getListeners(listenerID) != nullptr;
+    return getListeners(findListenerKey(listenerID)) != nullptr;
 }
 
 void EventDispatcher::dispatchTouchEvent(EventTouch* event)
 {
-    sortEventListeners(EventListenerTouchOneByOne::LISTENER_ID);
-    sortEventListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+    const auto oneByOneKey = __getTouchOneByOneListenerKey();
+    const auto allAtOnceKey = __getTouchAllAtOnceListenerKey();
+
+    sortEventListeners(oneByOneKey);
+    sortEventListeners(allAtOnceKey);
     
-    auto oneByOneListeners = getListeners(EventListenerTouchOneByOne::LISTENER_ID);
-    auto allAtOnceListeners = getListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+    auto oneByOneListeners = getListeners(oneByOneKey);
+    auto allAtOnceListeners = getListeners(allAtOnceKey);
     
     // If there aren't any touch listeners, return directly.
     if (nullptr == oneByOneListeners && nullptr == allAtOnceListeners)
@@ -966,8 +1008,13 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
     bool isNeedsMutableSet = (oneByOneListeners && allAtOnceListeners);
     
     const std::vector<Touch*>& originalTouches = event->getTouches();
-    std::vector<Touch*> mutableTouches(originalTouches.size());
-    std::copy(originalTouches.begin(), originalTouches.end(), mutableTouches.begin());
+    // Reuse the storage of this dispatch depth, a listener callback may dispatch another touch event
+    while (_mutableTouchesScratch.size() < static_cast<size_t>(_inDispatch))
+    {
+        _mutableTouchesScratch.emplace_back();
+    }
+    std::vector<Touch*>& mutableTouches = _mutableTouchesScratch[_inDispatch - 1];
+    mutableTouches.assign(originalTouches.begin(), originalTouches.end());
 
     //
     // process the target handlers 1st
@@ -1151,9 +1198,9 @@ void EventDispatcher::updateListeners(Event* event)
     if (_inDispatch > 1)
         return;
 
-    auto onUpdateListeners = [this](const EventListener::ListenerID& listenerID)
+    auto onUpdateListeners = [this](EventListener::ListenerKey listenerKey)
     {
-        auto listenersIter = _listenerMap.find(listenerID);
+        auto listenersIter = _listenerMap.find(listenerKey);
         if (listenersIter == _listenerMap.end())
             return;
 
@@ -1217,12 +1264,12 @@ void EventDispatcher::updateListeners(Event* event)
 
     if (event->getType() == Event::Type::TOUCH)
     {
-        onUpdateListeners(EventListenerTouchOneByOne::LISTENER_ID);
-        onUpdateListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+        onUpdateListeners(__getTouchOneByOneListenerKey());
+        onUpdateListeners(__getTouchAllAtOnceListenerKey());
     }
     else
     {
-        onUpdateListeners(__getListenerID(event));
+        onUpdateListeners(getListenerKey(event));
     }
     
     CCASSERT(_inDispatch == 1, "_inDispatch should be 1 here.");
@@ -1267,7 +1314,7 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
             {
                 for (auto& l : *iter->second)
                 {
-                    setDirty(l->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+                    setDirty(l->getListenerKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
                 }
             }
         }
@@ -1276,11 +1323,11 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
     }
 }
 
-void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listenerID)
+void EventDispatcher::sortEventListeners(EventListener::ListenerKey listenerKey)
 {
     DirtyFlag dirtyFlag = DirtyFlag::NONE;
     
-    auto dirtyIter = _priorityDirtyFlagMap.find(listenerID);
+    auto dirtyIter = _priorityDirtyFlagMap.find(listenerKey);
     if (dirtyIter != _priorityDirtyFlagMap.end())
     {
         dirtyFlag = dirtyIter->second;
@@ -1293,7 +1340,7 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
 
         if ((int)dirtyFlag & (int)DirtyFlag::FIXED_PRIORITY)
         {
-            sortEventListenersOfFixedPriority(listenerID);
+            sortEventListenersOfFixedPriority(listenerKey);
         }
         
         if ((int)dirtyFlag & (int)DirtyFlag::SCENE_GRAPH_PRIORITY)
@@ -1301,7 +1348,7 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
             auto rootNode = Director::getInstance()->getRunningScene();
             if (rootNode)
             {
-                sortEventListenersOfSceneGraphPriority(listenerID, rootNode);
+                sortEventListenersOfSceneGraphPriority(listenerKey, rootNode);
             }
             else
             {
@@ -1311,9 +1358,9 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
     }
 }
 
-void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode)
+void EventDispatcher::sortEventListenersOfSceneGraphPriority(EventListener::ListenerKey listenerKey, Node* rootNode)
 {
-    auto listeners = getListeners(listenerID);
+    auto listeners = getListeners(listenerKey);
     
     if (listeners == nullptr)
         return;
@@ -1342,9 +1389,9 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
 #endif
 }
 
-void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID)
+void EventDispatcher::sortEventListenersOfFixedPriority(EventListener::ListenerKey listenerKey)
 {
-    auto listeners = getListeners(listenerID);
+    auto listeners = getListeners(listenerKey);
 
     if (listeners == nullptr)
         return;
@@ -1379,9 +1426,31 @@ void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::Lis
     
 }
 
-EventDispatcher::EventListenerVector* EventDispatcher::getListeners(const EventListener::ListenerID& listenerID) const
+EventListener::ListenerKey EventDispatcher::findListenerKey(const EventListener::ListenerID& listenerID) const
 {
-    auto iter = _listenerMap.find(listenerID);
+    auto iter = _listenerKeys.find(listenerID);
+    return iter != _listenerKeys.end() ? iter->second : -1;
+}
+
+EventListener::ListenerKey EventDispatcher::getListenerKey(Event* event) const
+{
+    if (event->getType() == Event::Type::CUSTOM)
+    {
+        // The events reused every frame, like the ones of the Director, don't hash their name again
+        auto customEvent = static_cast<EventCustom*>(event);
+        if (customEvent->_listenerKeyGeneration != _listenerKeysGeneration)
+        {
+            customEvent->_listenerKey = findListenerKey(customEvent->getEventName());
+            customEvent->_listenerKeyGeneration = _listenerKeysGeneration;
+        }
+        return customEvent->_listenerKey;
+    }
+    return __getListenerKey(event);
+}
+
+EventDispatcher::EventListenerVector* EventDispatcher::getListeners(EventListener::ListenerKey listenerKey) const
+{
+    auto iter = _listenerMap.find(listenerKey);
     if (iter != _listenerMap.end())
     {
         return iter->second;
@@ -1390,9 +1459,9 @@ EventDispatcher::EventListenerVector* EventDispatcher::getListeners(const EventL
     return nullptr;
 }
 
-void EventDispatcher::removeEventListenersForListenerID(const EventListener::ListenerID& listenerID)
+void EventDispatcher::removeEventListenersForListenerID(EventListener::ListenerKey listenerKey)
 {
-    auto listenerItemIter = _listenerMap.find(listenerID);
+    auto listenerItemIter = _listenerMap.find(listenerKey);
     if (listenerItemIter != _listenerMap.end())
     {
         auto listeners = listenerItemIter->second;
@@ -1430,7 +1499,7 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
         
         // Remove the dirty flag according the 'listenerID'.
         // No need to check whether the dispatcher is dispatching event.
-        _priorityDirtyFlagMap.erase(listenerID);
+        _priorityDirtyFlagMap.erase(listenerKey);
         
         if (!_inDispatch)
         {
@@ -1442,7 +1511,7 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
     
     for (auto iter = _toAddedListeners.begin(); iter != _toAddedListeners.end();)
     {
-        if ((*iter)->getListenerID() == listenerID)
+        if ((*iter)->getListenerKey() == listenerKey)
         {
             (*iter)->setRegistered(false);
             releaseListener(*iter);
@@ -1459,23 +1528,23 @@ void EventDispatcher::removeEventListenersForType(EventListener::Type listenerTy
 {
     if (listenerType == EventListener::Type::TOUCH_ONE_BY_ONE)
     {
-        removeEventListenersForListenerID(EventListenerTouchOneByOne::LISTENER_ID);
+        removeEventListenersForListenerID(__getTouchOneByOneListenerKey());
     }
     else if (listenerType == EventListener::Type::TOUCH_ALL_AT_ONCE)
     {
-        removeEventListenersForListenerID(EventListenerTouchAllAtOnce::LISTENER_ID);
+        removeEventListenersForListenerID(__getTouchAllAtOnceListenerKey());
     }
     else if (listenerType == EventListener::Type::MOUSE)
     {
-        removeEventListenersForListenerID(EventListenerMouse::LISTENER_ID);
+        removeEventListenersForListenerID(EventListener::getListenerKey(EventListenerMouse::LISTENER_ID));
     }
     else if (listenerType == EventListener::Type::ACCELERATION)
     {
-        removeEventListenersForListenerID(EventListenerAcceleration::LISTENER_ID);
+        removeEventListenersForListenerID(EventListener::getListenerKey(EventListenerAcceleration::LISTENER_ID));
     }
     else if (listenerType == EventListener::Type::KEYBOARD)
     {
-        removeEventListenersForListenerID(EventListenerKeyboard::LISTENER_ID);
+        removeEventListenersForListenerID(EventListener::getListenerKey(EventListenerKeyboard::LISTENER_ID));
     }
     else
     {
@@ -1485,13 +1554,17 @@ void EventDispatcher::removeEventListenersForType(EventListener::Type listenerTy
 
 void EventDispatcher::removeCustomEventListeners(const std::string& customEventName)
 {
-    removeEventListenersForListenerID(customEventName);
+    auto listenerKey = findListenerKey(customEventName);
+    if (listenerKey >= 0)
+    {
+        removeEventListenersForListenerID(listenerKey);
+    }
 }
 
 void EventDispatcher::removeAllEventListeners()
 {
     bool cleanMap = true;
-    std::vector<EventListener::ListenerID> types;
+    std::vector<EventListener::ListenerKey> types;
     types.reserve(_listenerMap.size());
     
     for (const auto& e : _listenerMap)
@@ -1543,12 +1616,12 @@ void EventDispatcher::setDirtyForNode(Node* node)
     }
 }
 
-void EventDispatcher::setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag)
+void EventDispatcher::setDirty(EventListener::ListenerKey listenerKey, DirtyFlag flag)
 {    
-    auto iter = _priorityDirtyFlagMap.find(listenerID);
+    auto iter = _priorityDirtyFlagMap.find(listenerKey);
     if (iter == _priorityDirtyFlagMap.end())
     {
-        _priorityDirtyFlagMap.emplace(listenerID, flag);
+        _priorityDirtyFlagMap.emplace(listenerKey, flag);
     }
     else
     {
@@ -1561,7 +1634,7 @@ void EventDispatcher::cleanToRemovedListeners()
 {
     for (auto& l : _toRemovedListeners)
     {
-        auto listenersIter = _listenerMap.find(l->getListenerID());
+        auto listenersIter = _listenerMap.find(l->getListenerKey());
         if (listenersIter == _listenerMap.end())
         {
             releaseListener(l);
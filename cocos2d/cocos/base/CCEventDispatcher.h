@@ -30,6 +30,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <set>
 
 #include "platform/CCPlatformMacros.h"
@@ -47,6 +48,8 @@ NS_CC_BEGIN
 class Event;
 class EventTouch;
 class Node;
+class Camera;
+class Touch;
 class EventCustom;
 class EventListenerCustom;
 
@@ -58,6 +61,11 @@ The EventListener list is managed in such a way that
 event listeners can be added and removed even
 from within an EventListener, while events are being
 dispatched.
+
+The listeners are stored by the interned key of their listener ID
+(see EventListener::getListenerKey()), and their lists are only sorted
+again when their dirty flag is set, so dispatching an event neither
+hashes strings nor allocates memory.
 @js NA
 */
 class CC_DLL EventDispatcher : public Ref
@@ -249,23 +257,31 @@ protected:
      */
     void forceAddEventListener(EventListener* listener);
     
+    /** Gets the key of a listener ID that has been registered to this dispatcher, -1 if none was.
+     *  Unlike EventListener::getListenerKey(), it neither locks nor interns the ID.
+     */
+    EventListener::ListenerKey findListenerKey(const EventListener::ListenerID& listenerID) const;
+    
+    /** Gets the key of the listeners of a non-touch event, cached by the custom events. */
+    EventListener::ListenerKey getListenerKey(Event* event) const;
+    
     /** Gets event the listener list for the event listener type. */
-    EventListenerVector* getListeners(const EventListener::ListenerID& listenerID) const;
+    EventListenerVector* getListeners(EventListener::ListenerKey listenerKey) const;
     
     /** Update dirty flag */
     void updateDirtyFlagForSceneGraph();
     
     /** Removes all listeners with the same event listener ID */
-    void removeEventListenersForListenerID(const EventListener::ListenerID& listenerID);
+    void removeEventListenersForListenerID(EventListener::ListenerKey listenerKey);
     
     /** Sort event listener */
-    void sortEventListeners(const EventListener::ListenerID& listenerID);
+    void sortEventListeners(EventListener::ListenerKey listenerKey);
     
     /** Sorts the listeners of specified type by scene graph priority */
-    void sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode);
+    void sortEventListenersOfSceneGraphPriority(EventListener::ListenerKey listenerKey, Node* rootNode);
     
     /** Sorts the listeners of specified type by fixed priority */
-    void sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID);
+    void sortEventListenersOfFixedPriority(EventListener::ListenerKey listenerKey);
     
     /** Updates all listeners
      *  1) Removes all listener items that have been marked as 'removed' when dispatching event.
@@ -282,8 +298,12 @@ protected:
     /** Dissociates node with event listener */
     void dissociateNodeAndEventListener(Node* node, EventListener* listener);
     
-    /** Dispatches event to listeners with a specified listener type */
-    void dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    /** Dispatches event to listeners with a specified listener type
+     *  @note `onEvent` is any callable taking an EventListener* and returning true to stop the propagation,
+     *        it's a template so that the callbacks are not copied into a std::function for each event.
+     */
+    template <typename OnEvent>
+    void dispatchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent);
     
     /** Special version dispatchEventToListeners for touch/mouse event.
      *
@@ -293,7 +313,8 @@ protected:
      *      to 3D world space is different by different camera.
      *  When listener process touch event, can get current camera by Camera::getVisitingCamera().
      */
-    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    template <typename OnEvent>
+    void dispatchTouchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent);
     
     void releaseListener(EventListener* listener);
     
@@ -307,7 +328,7 @@ protected:
     };
     
     /** Sets the dirty flag for a specified listener ID */
-    void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
+    void setDirty(EventListener::ListenerKey listenerKey, DirtyFlag flag);
     
     /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
     void visitTarget(Node* node, bool isRootNode);
@@ -316,10 +337,18 @@ protected:
     void cleanToRemovedListeners();
 
     /** Listeners map */
-    std::unordered_map<EventListener::ListenerID, EventListenerVector*> _listenerMap;
+    std::unordered_map<EventListener::ListenerKey, EventListenerVector*> _listenerMap;
+    
+    /** The keys of the listener IDs ever registered, so dispatching by name doesn't touch the global intern table */
+    std::unordered_map<EventListener::ListenerID, EventListener::ListenerKey> _listenerKeys;
+    
+    /** Changed when a listener ID is added to _listenerKeys, the custom events cache their key until it changes.
+     *  The generations are unique across the dispatchers.
+     */
+    unsigned int _listenerKeysGeneration;
     
     /** The map of dirty flag */
-    std::unordered_map<EventListener::ListenerID, DirtyFlag> _priorityDirtyFlagMap;
+    std::unordered_map<EventListener::ListenerKey, DirtyFlag> _priorityDirtyFlagMap;
     
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
@@ -347,7 +376,13 @@ protected:
     
     int _nodePriorityIndex;
     
-    std::set<std::string> _internalCustomListenerIDs;
+    std::set<EventListener::ListenerKey> _internalCustomListenerIDs;
+
+    /** Scratch storage reused by the touch dispatch, a nested dispatch uses the part after the one of its caller */
+    std::vector<EventListener*> _sceneListenersScratch;
+    std::vector<Camera*> _camerasScratch;
+    /** The touches of each dispatch depth that are not swallowed yet */
+    std::deque<std::vector<Touch*>> _mutableTouchesScratch;
 };
 
 
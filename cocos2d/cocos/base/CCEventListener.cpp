@@ -24,11 +24,14 @@
  ****************************************************************************/
 
 #include "base/CCEventListener.h"
+#include <mutex>
+#include <unordered_map>
 #include "base/CCConsole.h"
 
 NS_CC_BEGIN
 
 EventListener::EventListener()
+: _listenerKey(-1)
 {}
     
 EventListener::~EventListener() 
@@ -41,6 +44,7 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     _onEvent = callback;
     _type = t;
     _listenerID = listenerID;
+    _listenerKey = getListenerKey(listenerID);
     _isRegistered = false;
     _paused = false;
     _isEnabled = true;
@@ -48,6 +52,24 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     return true;
 }
 
+EventListener::ListenerKey EventListener::getListenerKey(const ListenerID& listenerID)
+{
+    // Never destroyed, listeners and events may be created by static objects
+    static std::mutex* s_mutex = new std::mutex();
+    static std::unordered_map<ListenerID, ListenerKey>* s_keys = new std::unordered_map<ListenerID, ListenerKey>();
+
+    std::lock_guard<std::mutex> lock(*s_mutex);
+    auto iter = s_keys->find(listenerID);
+    if (iter != s_keys->end())
+    {
+        return iter->second;
+    }
+
+    ListenerKey key = static_cast<ListenerKey>(s_keys->size());
+    s_keys->emplace(listenerID, key);
+    return key;
+}
+
 bool EventListener::checkAvailable()
 { 
 	return (_onEvent != nullptr);
@@ -66,6 +66,15 @@ public:
     };
 
     typedef std::string ListenerID;
+    /** The interned form of a ListenerID, used by EventDispatcher to find the listeners without hashing strings. */
+    typedef int ListenerKey;
+
+    /** Returns the key interned for a listener ID.
+     * The same ID always gives the same key, the keys are small non-negative integers.
+     * It is thread safe.
+     * @since v3.17
+     */
+    static ListenerKey getListenerKey(const ListenerID& listenerID);
 
 CC_CONSTRUCTOR_ACCESS:
     /**
@@ -142,6 +151,9 @@ protected:
      */
     const ListenerID& getListenerID() const { return _listenerID; }
 
+    /** Gets the interned key of the listener ID of this listener */
+    ListenerKey getListenerKey() const { return _listenerKey; }
+
     /** Sets the fixed priority for this listener
      *  @note This method is only used for `fixed priority listeners`, it needs to access a non-zero value.
      *  0 is reserved for scene graph priority listeners
@@ -168,6 +180,7 @@ protected:
 
     Type _type;                             /// Event listener type
     ListenerID _listenerID;                 /// Event listener ID
+    ListenerKey _listenerKey;               /// Interned listener ID
     bool _isRegistered;                     /// Whether the listener has been added to dispatcher.
 
     int   _fixedPriority;   // The higher the number, the higher the priority, 0 is for scene graph base priority.
@@ -0,0 +1,217 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+NS_CC_BEGIN
+
+#if CC_ENABLE_HEAP_COUNTERS
+
+#if CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
+#error "CC_ENABLE_HEAP_COUNTERS can't be used with CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE"
+#endif
+
+static std::atomic<size_t> s_heapAllocationCount(0);
+static std::atomic<size_t> s_heapDeallocationCount(0);
+static std::atomic<size_t> s_heapBytesAllocated(0);
+// the counters at the end of the last frame
+static size_t s_lastHeapAllocationCount = 0;
+static size_t s_lastHeapDeallocationCount = 0;
+static size_t s_lastHeapBytesAllocated = 0;
+
+static void* countedAllocate(std::size_t size)
+{
+    s_heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_heapBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+static void countedDeallocate(void* p)
+{
+    if (p)
+    {
+        s_heapDeallocationCount.fetch_add(1, std::memory_order_relaxed);
+        free(p);
+    }
+}
+
+#endif // CC_ENABLE_HEAP_COUNTERS
+
+// The chunks are sized in multiples of the maximum alignment, so that their end is aligned
+static size_t alignChunkSize(size_t size)
+{
+    const size_t alignment = alignof(std::max_align_t);
+    return (size + (alignment - 1)) & ~(alignment - 1);
+}
+
+FrameArena* FrameArena::getInstance()
+{
+    static FrameArena s_sharedArena;
+    return &s_sharedArena;
+}
+
+FrameArena::FrameArena()
+: _frame(0)
+#if COCOS2D_DEBUG > 0
+, _liveAllocations(0)
+#endif
+{
+    memset(&_stats, 0, sizeof(_stats));
+    memset(&_lastFrameStats, 0, sizeof(_lastFrameStats));
+
+    const size_t capacity = alignChunkSize(CC_FRAME_ARENA_SIZE);
+    _chunks.reserve(8);
+    _chunks.push_back({ static_cast<char*>(::operator new(capacity)), capacity });
+    _current = _chunks[0].data;
+    _end = _current + capacity;
+}
+
+FrameArena::~FrameArena()
+{
+    for (auto& chunk : _chunks)
+    {
+        ::operator delete(chunk.data);
+    }
+}
+
+char* FrameArena::allocateChunk(size_t size, size_t alignment)
+{
+    const size_t chunkSize = alignChunkSize(std::max(_chunks.back().size * 2, size + alignment));
+    char* data = static_cast<char*>(::operator new(chunkSize));
+    _chunks.push_back({ data, chunkSize });
+    _end = data + chunkSize;
+    ++_stats.chunkAllocationCount;
+
+    return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(data) + (alignment - 1)) & ~(uintptr_t)(alignment - 1));
+}
+
+void FrameArena::reset()
+{
+#if COCOS2D_DEBUG > 0
+    CCASSERT(_liveAllocations == 0, "FrameArena: some memory of the frame is still used at the end of the frame");
+    _liveAllocations = 0;
+    _ownerThread = std::this_thread::get_id();
+#endif
+
+    size_t capacity = 0;
+    for (auto& chunk : _chunks)
+    {
+        capacity += chunk.size;
+    }
+
+    if (_chunks.size() > 1)
+    {
+        // merge the chunks, so that the next frames fit in the first one
+        for (auto& chunk : _chunks)
+        {
+            ::operator delete(chunk.data);
+        }
+        _chunks.clear();
+        capacity = alignChunkSize(capacity);
+        _chunks.push_back({ static_cast<char*>(::operator new(capacity)), capacity });
+    }
+#if COCOS2D_DEBUG > 0
+    else
+    {
+        // make the use of stale memory visible
+        memset(_chunks[0].data, 0xCD, _current - _chunks[0].data);
+    }
+#endif
+
+    _current = _chunks[0].data;
+    _end = _current + _chunks[0].size;
+
+    _stats.capacity = capacity;
+#if CC_ENABLE_HEAP_COUNTERS
+    const size_t allocationCount = s_heapAllocationCount.load(std::memory_order_relaxed);
+    const size_t deallocationCount = s_heapDeallocationCount.load(std::memory_order_relaxed);
+    const size_t bytesAllocated = s_heapBytesAllocated.load(std::memory_order_relaxed);
+    _stats.heapAllocationCount = allocationCount - s_lastHeapAllocationCount;
+    _stats.heapDeallocationCount = deallocationCount - s_lastHeapDeallocationCount;
+    _stats.heapBytesAllocated = bytesAllocated - s_lastHeapBytesAllocated;
+    s_lastHeapAllocationCount = allocationCount;
+    s_lastHeapDeallocationCount = deallocationCount;
+    s_lastHeapBytesAllocated = bytesAllocated;
+#endif
+    _lastFrameStats = _stats;
+    memset(&_stats, 0, sizeof(_stats));
+
+    ++_frame;
+}
+
+NS_CC_END
+
+#if CC_ENABLE_HEAP_COUNTERS
+
+void* operator new(std::size_t size)
+{
+    void* ptr = cocos2d::countedAllocate(size);
+    CCASSERT(ptr, "No memory");
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* ptr = cocos2d::countedAllocate(size);
+    CCASSERT(ptr, "No memory");
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return cocos2d::countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return cocos2d::countedAllocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    cocos2d::countedDeallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    cocos2d::countedDeallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    cocos2d::countedDeallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    cocos2d::countedDeallocate(p);
+}
+
+#endif // CC_ENABLE_HEAP_COUNTERS
@@ -0,0 +1,201 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCFRAMEARENA_H__
+#define __CCFRAMEARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "base/ccConfig.h"
+#include "base/ccMacros.h"
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class FrameArena
+ * @brief A linear allocator for the temporary data of a frame.
+ *
+ * An allocation only bumps a pointer, and all the memory is reclaimed at once when Director::mainLoop() resets the
+ * arena at the end of the frame. Deallocating the last allocation gives its memory back, so a growing vector
+ * doesn't waste the space of its previous buffer when nothing was allocated after it.
+ * If a frame needs more than the capacity of the arena, new chunks are allocated from the heap, and at the end of
+ * the frame they are merged into a single chunk: a steady-state frame doesn't touch the heap.
+ *
+ * The arena can only be used by the cocos thread, and its memory mustn't be kept after the frame. Standard
+ * containers use it through FrameAllocator:
+ * @code
+ * FrameVector<Node*> visible;
+ * for (auto child : getChildren())
+ *     if (child->isVisible())
+ *         visible.push_back(child);
+ * @endcode
+ * @since v3.17
+ */
+class CC_DLL FrameArena
+{
+public:
+    /** Allocation counters of a frame. */
+    struct Stats
+    {
+        /** Number of allocations and bytes allocated from the arena. */
+        size_t allocationCount;
+        size_t bytesAllocated;
+        /** Number of chunks allocated from the heap because the arena was full. */
+        size_t chunkAllocationCount;
+        /** Capacity of the arena at the end of the frame, in bytes. */
+        size_t capacity;
+        /** Number of heap allocations and deallocations, and bytes allocated from the heap, by all the threads.
+         * Only counted if CC_ENABLE_HEAP_COUNTERS is enabled.
+         */
+        size_t heapAllocationCount;
+        size_t heapDeallocationCount;
+        size_t heapBytesAllocated;
+    };
+
+    /** Returns the arena of the cocos thread. */
+    static FrameArena* getInstance();
+
+    /** Allocates `size` bytes aligned to `alignment`, that must be a power of 2. The memory is valid until the
+     * end of the frame.
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        CCASSERT(_ownerThread == std::thread::id() || _ownerThread == std::this_thread::get_id(), "FrameArena can only be used by the cocos thread");
+        char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(_current) + (alignment - 1)) & ~(uintptr_t)(alignment - 1));
+        // the alignment may move p past the end of the chunk
+        if (p > _end || size > static_cast<size_t>(_end - p))
+        {
+            p = allocateChunk(size, alignment);
+        }
+        _current = p + size;
+        ++_stats.allocationCount;
+        _stats.bytesAllocated += size;
+#if COCOS2D_DEBUG > 0
+        ++_liveAllocations;
+#endif
+        return p;
+    }
+
+    /** Deallocates memory returned by allocate(). It is only reclaimed if it is the last allocation, otherwise at
+     * the end of the frame.
+     */
+    void deallocate(void* p, size_t size)
+    {
+        if (static_cast<char*>(p) + size == _current)
+        {
+            _current = static_cast<char*>(p);
+        }
+#if COCOS2D_DEBUG > 0
+        --_liveAllocations;
+#endif
+    }
+
+    /** Reclaims all the memory of the frame and collects its counters. Called by Director::mainLoop(), at the end
+     * of each frame.
+     */
+    void reset();
+
+    /** Returns the counters of the last completed frame. */
+    const Stats& getLastFrameStats() const { return _lastFrameStats; }
+
+    /** Returns the number of the current frame, incremented by reset(). */
+    unsigned int getFrame() const { return _frame; }
+
+protected:
+    struct Chunk
+    {
+        char* data;
+        size_t size;
+    };
+
+    FrameArena();
+    ~FrameArena();
+
+    char* allocateChunk(size_t size, size_t alignment);
+
+    std::vector<Chunk> _chunks;
+    // unused part of the last chunk
+    char* _current;
+    char* _end;
+    Stats _stats;
+    Stats _lastFrameStats;
+    unsigned int _frame;
+#if COCOS2D_DEBUG > 0
+    int _liveAllocations;
+    // the thread that resets the arena, unknown until the first frame ends
+    std::thread::id _ownerThread;
+#endif
+};
+
+/** @class FrameAllocator
+ * @brief An STL allocator that allocates from the FrameArena. A container that uses it must be destroyed before
+ * the end of the frame.
+ * @since v3.17
+ */
+template <typename T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    FrameAllocator() {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(FrameArena::getInstance()->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        FrameArena::getInstance()->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+/** A std::vector of the current frame. */
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CCFRAMEARENA_H__
@@ -0,0 +1,207 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameTracer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "platform/CCFileUtils.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+std::atomic<bool> FrameTracer::s_recording(false);
+
+// the ThreadBuffer of the calling thread. Not a class member: thread_local data can't be exported from a DLL
+static thread_local void* s_currentThreadBuffer = nullptr;
+
+static uint64_t getTimeNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameTracer* FrameTracer::getInstance()
+{
+    static FrameTracer s_sharedTracer;
+    return &s_sharedTracer;
+}
+
+FrameTracer::FrameTracer()
+: _epoch(getTimeNanoseconds())
+{
+}
+
+FrameTracer::~FrameTracer()
+{
+    s_recording = false;
+    for (auto buffer : _threadBuffers)
+    {
+        delete buffer;
+    }
+}
+
+void FrameTracer::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(_threadBuffersMutex);
+        for (auto buffer : _threadBuffers)
+        {
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+    s_recording = true;
+}
+
+void FrameTracer::stop()
+{
+    s_recording = false;
+}
+
+uint64_t FrameTracer::now() const
+{
+    // never 0, that is used by FrameTraceScope as "not recording"
+    return getTimeNanoseconds() - _epoch + 1;
+}
+
+FrameTracer::ThreadBuffer* FrameTracer::getCurrentThreadBuffer()
+{
+    if (!s_currentThreadBuffer)
+    {
+        auto buffer = new (std::nothrow) ThreadBuffer();
+        buffer->head = 0;
+        buffer->tail = 0;
+
+        std::lock_guard<std::mutex> lock(_threadBuffersMutex);
+        buffer->tid = (int)_threadBuffers.size() + 1;
+        _threadBuffers.push_back(buffer);
+        s_currentThreadBuffer = buffer;
+    }
+    return static_cast<ThreadBuffer*>(s_currentThreadBuffer);
+}
+
+void FrameTracer::setCurrentThreadName(const std::string& name)
+{
+    auto buffer = getCurrentThreadBuffer();
+    std::lock_guard<std::mutex> lock(_threadBuffersMutex);
+    buffer->name = name;
+}
+
+void FrameTracer::addEvent(const char* name, uint64_t start, uint64_t duration)
+{
+    auto buffer = getCurrentThreadBuffer();
+    // allocated by the owner thread before the first event is published, so the readers never see it resize
+    if (buffer->events.empty())
+    {
+        buffer->events.resize(EVENTS_PER_THREAD);
+    }
+
+    const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[head % EVENTS_PER_THREAD];
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+static void appendJsonString(std::string& json, const char* str)
+{
+    json += '"';
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            json += '\\';
+        if ((unsigned char)*c >= 0x20)
+            json += *c;
+    }
+    json += '"';
+}
+
+std::string FrameTracer::exportChromeTrace()
+{
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<Event> events;
+    char buf[128];
+
+    std::lock_guard<std::mutex> lock(_threadBuffersMutex);
+    for (auto buffer : _threadBuffers)
+    {
+        if (!buffer->name.empty())
+        {
+            if (!first)
+                json += ',';
+            first = false;
+            snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", buffer->tid);
+            json += buf;
+            appendJsonString(json, buffer->name.c_str());
+            json += "}}";
+        }
+
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        if (head == 0)
+            continue;
+
+        uint64_t begin = std::max(buffer->tail.load(std::memory_order_relaxed), head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0);
+        events.clear();
+        for (uint64_t i = begin; i < head; ++i)
+        {
+            events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+        }
+
+        // the owner thread may have overwritten the oldest events while they were copied, drop them
+        const uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+        const uint64_t firstValid = newHead >= EVENTS_PER_THREAD ? newHead - EVENTS_PER_THREAD + 1 : 0;
+        for (uint64_t i = std::max(begin, firstValid); i < head; ++i)
+        {
+            const Event& event = events[i - begin];
+            if (!first)
+                json += ',';
+            first = false;
+            json += "{\"ph\":\"X\",\"cat\":\"cocos2d\",\"name\":";
+            appendJsonString(json, event.name);
+            snprintf(buf, sizeof(buf), ",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     buffer->tid, event.start / 1000.0, event.duration / 1000.0);
+            json += buf;
+        }
+    }
+    json += "]}";
+
+    return json;
+}
+
+std::string FrameTracer::saveChromeTrace(const std::string& filename)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPath = fileUtils->isAbsolutePath(filename) ? filename : fileUtils->getWritablePath() + filename;
+    if (!fileUtils->writeStringToFile(exportChromeTrace(), fullPath))
+    {
+        CCLOG("cocos2d: FrameTracer: couldn't save the trace to %s", fullPath.c_str());
+        return "";
+    }
+    return fullPath;
+}
+
+NS_CC_END
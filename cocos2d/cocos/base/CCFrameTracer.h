@@ -0,0 +1,171 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCFRAMETRACER_H__
+#define __CCFRAMETRACER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class FrameTracer
+ * @brief Records a timeline of what the engine does in each frame, and exports it in the Chrome trace event format.
+ *
+ * Each thread records its events in its own ring buffer without locking, so the overhead of a traced scope is a
+ * couple of clock reads while recording, and a single flag check while not recording. When a buffer is full the
+ * oldest events are overwritten, so the trace always has the last events of each thread.
+ *
+ * The trace can be saved with saveChromeTrace() (or the "trace" console command) and opened with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Scopes are traced with the CC_TRACE_SCOPE() macro, that is compiled only if CC_ENABLE_FRAME_TRACER is enabled:
+ * @code
+ * void MyLayer::update(float dt)
+ * {
+ *     CC_TRACE_SCOPE("MyLayer::update");
+ *     ...
+ * }
+ * @endcode
+ * @since v3.17
+ */
+class CC_DLL FrameTracer
+{
+public:
+    /** A traced scope. */
+    struct Event
+    {
+        /** Name of the scope, must be a string literal (or live as long as the tracer). */
+        const char* name;
+        /** Start and duration, in nanoseconds since the tracer was created. */
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    /** Returns the shared tracer. */
+    static FrameTracer* getInstance();
+
+    /** Starts recording. The events recorded before are discarded. */
+    void start();
+    /** Stops recording. The recorded events are kept until the next start(). */
+    void stop();
+    /** Returns whether the events are being recorded. */
+    static bool isRecording() { return s_recording.load(std::memory_order_relaxed); }
+
+    /** Names the calling thread in the trace. */
+    void setCurrentThreadName(const std::string& name);
+
+    /** Returns the current time of the tracer, in nanoseconds. */
+    uint64_t now() const;
+    /** Records an event of the calling thread. */
+    void addEvent(const char* name, uint64_t start, uint64_t duration);
+
+    /** Returns the recorded events as Chrome trace event JSON. Can be called while recording. */
+    std::string exportChromeTrace();
+    /** Saves the recorded events as Chrome trace event JSON.
+     * @param filename Full path of the file, or a file name relative to the writable path.
+     * @return The full path of the saved file, or an empty string if it couldn't be saved.
+     */
+    std::string saveChromeTrace(const std::string& filename);
+
+    /** Number of events kept per thread. */
+    static const uint32_t EVENTS_PER_THREAD = CC_FRAME_TRACER_EVENTS_PER_THREAD;
+
+protected:
+    struct ThreadBuffer
+    {
+        int tid;
+        std::string name;
+        // written by the owner thread only, published by `head`
+        std::vector<Event> events;
+        std::atomic<uint64_t> head;
+        // events older than this were recorded before the last start()
+        std::atomic<uint64_t> tail;
+    };
+
+    FrameTracer();
+    ~FrameTracer();
+
+    ThreadBuffer* getCurrentThreadBuffer();
+
+    static std::atomic<bool> s_recording;
+
+    uint64_t _epoch;
+    // the buffers are kept after their thread exits, to export its events
+    std::vector<ThreadBuffer*> _threadBuffers;
+    std::mutex _threadBuffersMutex;
+};
+
+#if CC_ENABLE_FRAME_TRACER
+
+/** Records the lifetime of a scope in the FrameTracer. Use CC_TRACE_SCOPE() instead. */
+class FrameTraceScope
+{
+public:
+    explicit FrameTraceScope(const char* name)
+    : _name(name)
+    , _start(FrameTracer::isRecording() ? FrameTracer::getInstance()->now() : 0)
+    {
+    }
+    ~FrameTraceScope()
+    {
+        if (_start && FrameTracer::isRecording())
+        {
+            auto tracer = FrameTracer::getInstance();
+            tracer->addEvent(_name, _start, tracer->now() - _start);
+        }
+    }
+private:
+    const char* _name;
+    uint64_t _start;
+};
+
+#define CC_TRACE_CONCAT_IMPL(__a__, __b__) __a__##__b__
+#define CC_TRACE_CONCAT(__a__, __b__) CC_TRACE_CONCAT_IMPL(__a__, __b__)
+#define CC_TRACE_SCOPE(__name__) NS_CC::FrameTraceScope CC_TRACE_CONCAT(__ccTraceScope, __LINE__)(__name__)
+
+#else
+
+#define CC_TRACE_SCOPE(__name__) do {} while (0)
+
+#endif // CC_ENABLE_FRAME_TRACER
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CCFRAMETRACER_H__
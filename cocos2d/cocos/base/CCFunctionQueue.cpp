@@ -0,0 +1,230 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFunctionQueue.h"
+
+#include <chrono>
+
+NS_CC_BEGIN
+
+/*
+ * The freed nodes are pushed to a shared lock-free stack. A producer that runs out of nodes takes the whole stack at
+ * once into its thread cache, so no node is ever popped from the shared stack alone (that would need ABA protection).
+ */
+struct FunctionQueue::NodePool
+{
+    // max number of nodes alive, the nodes freed above it are deleted
+    static const int MAX_NODES = 16384;
+
+    struct ThreadCache
+    {
+        Node* nodes = nullptr;
+
+        ~ThreadCache()
+        {
+            // give the nodes back when the thread exits
+            if (nodes)
+            {
+                Node* last = nodes;
+                while (Node* next = last->next.load(std::memory_order_relaxed))
+                    last = next;
+                NodePool::push(nodes, last);
+            }
+        }
+    };
+
+    // pushes the chain first..last with a single CAS
+    static void push(Node* first, Node* last)
+    {
+        Node* top = s_freeNodes.load(std::memory_order_relaxed);
+        do
+        {
+            last->next.store(top, std::memory_order_relaxed);
+        } while (!s_freeNodes.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static std::atomic<Node*> s_freeNodes;
+    static std::atomic<int> s_nodeCount;
+    static thread_local ThreadCache s_threadCache;
+};
+
+std::atomic<FunctionQueue::Node*> FunctionQueue::NodePool::s_freeNodes(nullptr);
+std::atomic<int> FunctionQueue::NodePool::s_nodeCount(0);
+thread_local FunctionQueue::NodePool::ThreadCache FunctionQueue::NodePool::s_threadCache;
+
+FunctionQueue::Node* FunctionQueue::allocateNode()
+{
+    auto& cache = NodePool::s_threadCache;
+    if (!cache.nodes)
+    {
+        cache.nodes = NodePool::s_freeNodes.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    Node* node = cache.nodes;
+    if (node)
+    {
+        cache.nodes = node->next.load(std::memory_order_relaxed);
+    }
+    else
+    {
+        node = new Node();
+        NodePool::s_nodeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    node->next.store(nullptr, std::memory_order_relaxed);
+    return node;
+}
+
+void FunctionQueue::freeNodes(Node* first, Node* last)
+{
+    // keep the nodes of a burst only up to a limit
+    while (first && NodePool::s_nodeCount.load(std::memory_order_relaxed) > NodePool::MAX_NODES)
+    {
+        Node* node = first;
+        first = (node == last) ? nullptr : node->next.load(std::memory_order_relaxed);
+        NodePool::s_nodeCount.fetch_sub(1, std::memory_order_relaxed);
+        delete node;
+    }
+    if (first)
+    {
+        NodePool::push(first, last);
+    }
+}
+
+FunctionQueue::FunctionQueue()
+: _head(&_stub)
+, _tail(&_stub)
+, _generation(0)
+{
+    _stub.next.store(nullptr, std::memory_order_relaxed);
+    _stub.invoke = nullptr;
+    _stub.generation = 0;
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    while (Node* node = dequeue())
+    {
+        node->invoke(node, Operation::DESTROY);
+        freeNodes(node, node);
+    }
+}
+
+void FunctionQueue::enqueue(Node* node)
+{
+    node->generation = _generation.load(std::memory_order_relaxed);
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+FunctionQueue::Node* FunctionQueue::dequeue()
+{
+    Node* tail = _tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &_stub)
+    {
+        if (!next)
+            return nullptr;
+        _tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next)
+    {
+        _tail = next;
+        return tail;
+    }
+
+    // a producer exchanged _head but hasn't linked its node yet, it will be dequeued the next time
+    if (tail != _head.load(std::memory_order_acquire))
+        return nullptr;
+
+    // tail is the last node, push the stub behind it so it can be removed
+    _stub.next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = _head.exchange(&_stub, std::memory_order_acq_rel);
+    prev->next.store(&_stub, std::memory_order_release);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        _tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+bool FunctionQueue::empty() const
+{
+    // the tail is the stub when all the nodes were dequeued
+    return _tail == &_stub && !_stub.next.load(std::memory_order_acquire);
+}
+
+size_t FunctionQueue::run(float timeBudget)
+{
+    // the functions queued by the functions that are run wait for the next call, like before
+    Node* last = _head.load(std::memory_order_acquire);
+    const bool stopAtLast = (last != &_stub);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(timeBudget));
+
+    // the nodes are given back to the pool all at once
+    Node* freeFirst = nullptr;
+    Node* freeLast = nullptr;
+
+    size_t count = 0;
+    while (Node* node = dequeue())
+    {
+        const bool cleared = node->generation != _generation.load(std::memory_order_acquire);
+        node->invoke(node, cleared ? Operation::DESTROY : Operation::INVOKE);
+        if (!cleared)
+            ++count;
+
+        node->next.store(freeFirst, std::memory_order_relaxed);
+        freeFirst = node;
+        if (!freeLast)
+            freeLast = node;
+
+        if (stopAtLast && node == last)
+            break;
+        if (timeBudget > 0.0f && std::chrono::steady_clock::now() - start >= budget)
+            break;
+    }
+
+    if (freeFirst)
+    {
+        freeNodes(freeFirst, freeLast);
+    }
+    return count;
+}
+
+void FunctionQueue::clear()
+{
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+NS_CC_END
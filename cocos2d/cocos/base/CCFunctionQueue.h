@@ -0,0 +1,159 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCFUNCTIONQUEUE_H__
+#define __CCFUNCTIONQUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class FunctionQueue
+ * @brief A lock-free queue of functions, pushed from any thread and run by a single thread.
+ *
+ * Used by Scheduler::performFunctionInCocosThread(). The producers never lock: a push is an atomic exchange,
+ * and the nodes come from a pool shared by all the queues, cached per thread, so a steady stream of
+ * functions doesn't allocate. The functions are stored in the nodes, the ones that don't fit in
+ * INLINE_STORAGE_SIZE bytes are moved to the heap.
+ *
+ * run() must always be called from the same thread.
+ * @since v3.17
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    /** Size of the functions that are stored in the nodes without allocating. */
+    static const size_t INLINE_STORAGE_SIZE = 48;
+
+    FunctionQueue();
+    ~FunctionQueue();
+
+    /** Queues a function. Thread safe. */
+    template <typename Function>
+    void push(Function&& function)
+    {
+        typedef typename std::decay<Function>::type Callable;
+        typedef std::integral_constant<bool, sizeof(Callable) <= INLINE_STORAGE_SIZE && alignof(Callable) <= alignof(Storage)> FitsInline;
+
+        Node* node = allocateNode();
+        store<Callable>(node, std::forward<Function>(function), FitsInline());
+        enqueue(node);
+    }
+
+    /** Runs the functions queued before this call, in order.
+     * @param timeBudget Max time to spend, in seconds. The functions left are run by the next call. 0 means no limit.
+     * @return The number of functions run.
+     */
+    size_t run(float timeBudget = 0.0f);
+
+    /** Discards the queued functions without running them. Thread safe. */
+    void clear();
+
+    /** Returns whether there are no queued functions. Must be called from the thread that calls run(). */
+    bool empty() const;
+
+protected:
+    enum class Operation
+    {
+        INVOKE,
+        DESTROY,
+    };
+
+    typedef typename std::aligned_storage<INLINE_STORAGE_SIZE, alignof(std::max_align_t)>::type Storage;
+
+    struct Node
+    {
+        std::atomic<Node*> next;
+        void (*invoke)(Node* node, Operation operation);
+        unsigned int generation;
+        Storage storage;
+    };
+
+    template <typename Callable, typename Function>
+    static void store(Node* node, Function&& function, std::true_type /*fitsInline*/)
+    {
+        new (&node->storage) Callable(std::forward<Function>(function));
+        node->invoke = &invokeInline<Callable>;
+    }
+
+    template <typename Callable, typename Function>
+    static void store(Node* node, Function&& function, std::false_type /*fitsInline*/)
+    {
+        *reinterpret_cast<Callable**>(&node->storage) = new Callable(std::forward<Function>(function));
+        node->invoke = &invokeHeap<Callable>;
+    }
+
+    template <typename Callable>
+    static void invokeInline(Node* node, Operation operation)
+    {
+        Callable* callable = reinterpret_cast<Callable*>(&node->storage);
+        if (operation == Operation::INVOKE)
+            (*callable)();
+        callable->~Callable();
+    }
+
+    template <typename Callable>
+    static void invokeHeap(Node* node, Operation operation)
+    {
+        Callable* callable = *reinterpret_cast<Callable**>(&node->storage);
+        if (operation == Operation::INVOKE)
+            (*callable)();
+        delete callable;
+    }
+
+    // the pool of nodes, shared by all the queues
+    struct NodePool;
+
+    static Node* allocateNode();
+    static void freeNodes(Node* first, Node* last);
+
+    void enqueue(Node* node);
+    Node* dequeue();
+
+    // Vyukov's intrusive MPSC queue: the producers exchange _head, the consumer owns _tail
+    std::atomic<Node*> _head;
+    Node* _tail;
+    Node _stub;
+    // incremented by clear(), the nodes pushed before are discarded
+    std::atomic<unsigned int> _generation;
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CCFUNCTIONQUEUE_H__
@@ -0,0 +1,408 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCFrameTracer.h"
+#include "base/ccMacros.h"
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    enum JobState
+    {
+        JOB_WAITING,    // created, waiting to be scheduled or for its dependencies
+        JOB_RUNNING,
+        JOB_DONE,
+        JOB_CANCELLED,
+    };
+
+    // the job system and the index of the worker running on the current thread
+    thread_local JobSystem* s_currentJobSystem = nullptr;
+    thread_local int s_currentWorkerIndex = -1;
+}
+
+struct JobSystem::Job
+{
+    std::function<void()> work;
+    std::function<void()> mainThreadCallback;
+    // the unfinished dependencies, plus one until the job is scheduled
+    std::atomic<int> pendingCount;
+    std::atomic<int> state;
+    std::atomic<bool> finished;
+
+    // protects dependents, and finished while they are added
+    std::mutex mutex;
+    std::vector<JobHandle> dependents;
+
+    Job()
+    : pendingCount(1)
+    , state(JOB_WAITING)
+    , finished(false)
+    {}
+};
+
+JobSystem* JobSystem::s_sharedJobSystem = nullptr;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_sharedJobSystem == nullptr)
+    {
+        s_sharedJobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_sharedJobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedJobSystem);
+}
+
+JobSystem::JobSystem(int workerCount)
+: _queuedJobCount(0)
+, _stop(false)
+, _waiterCount(0)
+{
+    if (workerCount <= 0)
+    {
+        workerCount = std::max(2, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers.push_back(new Worker());
+    }
+    // start the threads once all the workers exist, they steal from each other
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto worker : _workers)
+    {
+        worker->thread.join();
+    }
+    for (auto worker : _workers)
+    {
+        delete worker;
+    }
+    _workers.clear();
+}
+
+bool JobSystem::isWorkerThread() const
+{
+    return s_currentJobSystem == this;
+}
+
+JobSystem::JobHandle JobSystem::createJob(std::function<void()> work)
+{
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependency)
+{
+    CCASSERT(job->pendingCount.load() > 0, "The job is already scheduled");
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (!dependency->finished.load())
+    {
+        job->pendingCount.fetch_add(1);
+        dependency->dependents.push_back(job);
+    }
+}
+
+void JobSystem::setMainThreadCallback(const JobHandle& job, std::function<void()> callback)
+{
+    job->mainThreadCallback = std::move(callback);
+}
+
+void JobSystem::schedule(const JobHandle& job)
+{
+    release(job);
+}
+
+JobSystem::JobHandle JobSystem::enqueue(std::function<void()> work, std::function<void()> mainThreadCallback)
+{
+    auto job = createJob(std::move(work));
+    job->mainThreadCallback = std::move(mainThreadCallback);
+    schedule(job);
+    return job;
+}
+
+bool JobSystem::cancel(const JobHandle& job)
+{
+    // it still goes through the queue, the worker finishes it without running it
+    int expected = JOB_WAITING;
+    return job->state.compare_exchange_strong(expected, JOB_CANCELLED);
+}
+
+bool JobSystem::isFinished(const JobHandle& job) const
+{
+    return job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    if (isWorkerThread())
+    {
+        // don't block a worker, the job may be queued behind this one
+        while (!job->finished.load(std::memory_order_acquire))
+        {
+            auto other = findJob(s_currentWorkerIndex);
+            if (other)
+                execute(other);
+            else
+                std::this_thread::yield();
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_finishMutex);
+    _waiterCount.fetch_add(1);
+    _finishCondition.wait(lock, [&job]{ return job->finished.load(std::memory_order_acquire); });
+    _waiterCount.fetch_sub(1);
+}
+
+void JobSystem::parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body)
+{
+    if (end <= begin)
+        return;
+
+    grainSize = std::max(1, grainSize);
+    const int count = end - begin;
+    // a few ranges per thread, so the threads that start late still get some
+    const int threadCount = getWorkerCount() + 1;
+    const int rangeSize = std::max(grainSize, (count + threadCount * 4 - 1) / (threadCount * 4));
+    const int rangeCount = (count + rangeSize - 1) / rangeSize;
+    if (rangeCount == 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // shared with the helper jobs, that may start after this call returned
+    struct Ranges
+    {
+        std::atomic<int> next;
+        std::atomic<int> done;
+    };
+    auto ranges = std::make_shared<Ranges>();
+    ranges->next = 0;
+    ranges->done = 0;
+    const std::function<void(int, int)>* bodyPtr = &body;
+
+    auto runRanges = [=](){
+        for (;;)
+        {
+            const int index = ranges->next.fetch_add(1);
+            if (index >= rangeCount)
+                break;
+            const int rangeBegin = begin + index * rangeSize;
+            (*bodyPtr)(rangeBegin, std::min(end, rangeBegin + rangeSize));
+            ranges->done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // the helpers only touch the body while there are ranges left, and this call waits for all the ranges
+    const int helperCount = std::min(rangeCount, threadCount) - 1;
+    for (int i = 0; i < helperCount; ++i)
+    {
+        enqueue(runRanges);
+    }
+    runRanges();
+
+    while (ranges->done.load(std::memory_order_acquire) < rangeCount)
+    {
+        auto other = isWorkerThread() ? findJob(s_currentWorkerIndex) : nullptr;
+        if (other)
+            execute(other);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::release(const JobHandle& job)
+{
+    if (job->pendingCount.fetch_sub(1) == 1)
+    {
+        push(job);
+    }
+}
+
+void JobSystem::push(const JobHandle& job)
+{
+    if (isWorkerThread())
+    {
+        auto worker = _workers[s_currentWorkerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->jobs.push_back(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        _sharedJobs.push_back(job);
+    }
+
+    _queuedJobCount.fetch_add(1);
+    {
+        // taking the lock makes sure a worker that is going to sleep sees the new job
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _sleepCondition.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::findJob(int workerIndex)
+{
+    JobHandle job;
+    if (_queuedJobCount.load() == 0)
+        return job;
+
+    // the newest job of the worker first, its data is likely in the cache
+    if (workerIndex >= 0)
+    {
+        auto worker = _workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!worker->jobs.empty())
+        {
+            job = std::move(worker->jobs.back());
+            worker->jobs.pop_back();
+        }
+    }
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        if (!_sharedJobs.empty())
+        {
+            job = std::move(_sharedJobs.front());
+            _sharedJobs.pop_front();
+        }
+    }
+
+    // then steal the oldest job of another worker
+    const int workerCount = static_cast<int>(_workers.size());
+    for (int i = 1; !job && i <= workerCount; ++i)
+    {
+        const int victimIndex = (workerIndex + i + workerCount) % workerCount;
+        if (victimIndex == workerIndex)
+            continue;
+        auto victim = _workers[victimIndex];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->jobs.empty())
+        {
+            job = std::move(victim->jobs.front());
+            victim->jobs.pop_front();
+        }
+    }
+
+    if (job)
+    {
+        _queuedJobCount.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    int expected = JOB_WAITING;
+    const bool run = job->state.compare_exchange_strong(expected, JOB_RUNNING);
+    if (run)
+    {
+        CC_TRACE_SCOPE("JobSystem::job");
+        job->work();
+        job->work = nullptr;
+        job->state.store(JOB_DONE);
+    }
+    finish(job, run);
+}
+
+void JobSystem::finish(const JobHandle& job, bool ran)
+{
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+
+    for (const auto& dependent : dependents)
+    {
+        release(dependent);
+    }
+
+    if (ran && job->mainThreadCallback)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::move(job->mainThreadCallback));
+    }
+    job->mainThreadCallback = nullptr;
+
+    if (_waiterCount.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(_finishMutex);
+        _finishCondition.notify_all();
+    }
+}
+
+void JobSystem::workerLoop(int index)
+{
+    s_currentJobSystem = this;
+    s_currentWorkerIndex = index;
+#if CC_ENABLE_FRAME_TRACER
+    FrameTracer::getInstance()->setCurrentThreadName(StringUtils::format("JobWorker %d", index));
+#endif
+
+    while (!_stop.load())
+    {
+        auto job = findJob(index);
+        if (job)
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this]{ return _stop.load() || _queuedJobCount.load() > 0; });
+    }
+
+    s_currentJobSystem = nullptr;
+    s_currentWorkerIndex = -1;
+}
+
+NS_CC_END
@@ -0,0 +1,172 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCJOBSYSTEM_H__
+#define __CCJOBSYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class JobSystem
+ * @brief Runs jobs on a pool of worker threads, one per core.
+ *
+ * Each worker has its own deque of jobs: the jobs released by the jobs it runs are pushed to it, and the
+ * idle workers steal the oldest jobs of the others. The jobs queued from the other threads go to a shared queue.
+ *
+ * A job can depend on other jobs, it is queued once all of them are finished, and it can have a callback that
+ * is called in the cocos thread (see Scheduler::performFunctionInCocosThread()) after it ran.
+ * @code
+ * auto jobs = JobSystem::getInstance();
+ * auto decode = jobs->createJob([=]{ image->initWithImageFileThreadSafe(path); });
+ * auto premultiply = jobs->createJob([=]{ ... });
+ * jobs->addDependency(premultiply, decode);
+ * jobs->setMainThreadCallback(premultiply, [=]{ texture->initWithImage(image); });
+ * jobs->schedule(decode);
+ * jobs->schedule(premultiply);
+ * @endcode
+ *
+ * The jobs shouldn't block for a long time, a blocked job keeps its worker busy.
+ * The AsyncTaskPool::TaskType::TASK_OTHER tasks and TextureCache::addImageAsync() run their jobs on the shared instance.
+ * @since v3.17
+ */
+class CC_DLL JobSystem
+{
+public:
+    struct Job;
+    typedef std::shared_ptr<Job> JobHandle;
+
+    /** Returns the shared instance. Its workers are started the first time it is used. */
+    static JobSystem* getInstance();
+
+    /** Stops the workers and destroys the shared instance. The jobs that are not started are discarded. */
+    static void destroyInstance();
+
+    /** Creates a job. It doesn't run until it is scheduled.
+     * @param work The function run by a worker.
+     */
+    JobHandle createJob(std::function<void()> work);
+
+    /** Makes `job` wait for `dependency` to finish. It must be called before `job` is scheduled. */
+    void addDependency(const JobHandle& job, const JobHandle& dependency);
+
+    /** Sets a function called in the cocos thread after the job ran. It isn't called if the job is cancelled.
+     * It must be called before the job is scheduled.
+     */
+    void setMainThreadCallback(const JobHandle& job, std::function<void()> callback);
+
+    /** Queues a job. It runs as soon as a worker is available and all its dependencies are finished. */
+    void schedule(const JobHandle& job);
+
+    /** Creates and queues a job.
+     * @param work The function run by a worker.
+     * @param mainThreadCallback Optional function called in the cocos thread after `work`.
+     * @return The job.
+     */
+    JobHandle enqueue(std::function<void()> work, std::function<void()> mainThreadCallback = nullptr);
+
+    /** Cancels a job that is not started yet.
+     * The jobs that depend on it are still run, as if it was finished.
+     * @return True if the job won't run, false if it is already running or finished.
+     */
+    bool cancel(const JobHandle& job);
+
+    /** Returns whether the job ran, or was cancelled and released its dependents. */
+    bool isFinished(const JobHandle& job) const;
+
+    /** Waits for a scheduled job to finish. A worker that waits runs the other jobs in the meantime. */
+    void wait(const JobHandle& job);
+
+    /** Calls `body(rangeBegin, rangeEnd)` on sub-ranges of [begin, end) in parallel, and returns when all are done.
+     * The calling thread runs some of the ranges too.
+     * @param grainSize The minimum size of the ranges.
+     */
+    void parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+    /** Returns the number of worker threads. */
+    int getWorkerCount() const { return static_cast<int>(_workers.size()); }
+
+    /** Returns whether the current thread is a worker of this job system. */
+    bool isWorkerThread() const;
+
+CC_CONSTRUCTOR_ACCESS:
+    /** Starts `workerCount` workers, 0 starts one per core minus one, and at least two. */
+    explicit JobSystem(int workerCount = 0);
+    ~JobSystem();
+
+protected:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+        std::thread thread;
+    };
+
+    void workerLoop(int index);
+    void push(const JobHandle& job);
+    JobHandle findJob(int workerIndex);
+    void execute(const JobHandle& job);
+    void finish(const JobHandle& job, bool ran);
+    void release(const JobHandle& job);
+
+    std::vector<Worker*> _workers;
+
+    // jobs queued from the threads that are not workers
+    std::mutex _sharedMutex;
+    std::deque<JobHandle> _sharedJobs;
+
+    // the idle workers sleep until a job is queued
+    std::atomic<int> _queuedJobCount;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<bool> _stop;
+
+    // the threads in wait() sleep until a job is finished
+    std::atomic<int> _waiterCount;
+    std::mutex _finishMutex;
+    std::condition_variable _finishCondition;
+
+    static JobSystem* s_sharedJobSystem;
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CCJOBSYSTEM_H__
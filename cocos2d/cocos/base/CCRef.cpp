@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 #include "base/CCScriptSupport.h"
+#include "base/CCRefTracker.h"
 
 #if CC_REF_LEAK_DETECTION
 #include <algorithm>    // std::find
@@ -59,6 +60,10 @@ Ref::Ref()
 #if CC_REF_LEAK_DETECTION
     trackRef(this);
 #endif
+
+#if CC_ENABLE_REF_TRACKING
+    RefTracker::trackConstruction(this);
+#endif
 }
 
 Ref::~Ref()
@@ -86,6 +91,10 @@ Ref::~Ref()
     if (_referenceCount != 0)
         untrackRef(this);
 #endif
+
+#if CC_ENABLE_REF_TRACKING
+    RefTracker::trackDestruction(this);
+#endif
 }
 
 void Ref::retain()
@@ -147,12 +156,20 @@ void Ref::release()
 #if CC_REF_LEAK_DETECTION
         untrackRef(this);
 #endif
+
+#if CC_ENABLE_REF_TRACKING
+        // the last chance to know the class of the object
+        RefTracker::attribute(this);
+#endif
         delete this;
     }
 }
 
 Ref* Ref::autorelease()
 {
+#if CC_ENABLE_REF_TRACKING
+    RefTracker::trackAutorelease(this);
+#endif
     PoolManager::getInstance()->getCurrentPool()->addObject(this);
     return this;
 }
@@ -162,6 +179,32 @@ unsigned int Ref::getReferenceCount() const
     return _referenceCount;
 }
 
+#if CC_ENABLE_REF_TRACKING
+
+void* Ref::operator new(size_t size)
+{
+    RefTracker::willAllocate(size);
+    return ::operator new(size);
+}
+
+void* Ref::operator new(size_t size, const std::nothrow_t& tag) noexcept
+{
+    RefTracker::willAllocate(size);
+    return ::operator new(size, tag);
+}
+
+void Ref::operator delete(void* object)
+{
+    ::operator delete(object);
+}
+
+void Ref::operator delete(void* object, const std::nothrow_t& tag) noexcept
+{
+    ::operator delete(object, tag);
+}
+
+#endif // CC_ENABLE_REF_TRACKING
+
 #if CC_REF_LEAK_DETECTION
 
 static std::vector<Ref*> __refAllocationList;
@@ -30,6 +30,10 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "base/ccConfig.h"
 
+#if CC_ENABLE_REF_TRACKING
+#include <new>
+#endif
+
 #define CC_REF_LEAK_DETECTION 0
 
 /**
@@ -40,6 +44,7 @@ NS_CC_BEGIN
 
 
 class Ref;
+struct RefTypeStats;
 
 /** 
   * Interface that defines how to clone an Ref.
@@ -169,6 +174,25 @@ public:
 public:
     static void printLeaks();
 #endif
+
+    // Allocation tracking data (only included when CC_ENABLE_REF_TRACKING is enabled)
+#if CC_ENABLE_REF_TRACKING
+public:
+    // record the size of the objects for the RefTracker
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, const std::nothrow_t&) noexcept;
+    static void* operator new(size_t /*size*/, void* address) noexcept { return address; }
+    static void operator delete(void* object);
+    static void operator delete(void* object, const std::nothrow_t&) noexcept;
+    static void operator delete(void* /*object*/, void* /*address*/) noexcept {}
+
+private:
+    friend class RefTracker;
+    /// class of the object, once it is known
+    RefTypeStats* _trackedType;
+    /// size of the object, 0 if it isn't allocated with new
+    size_t _trackedSize;
+#endif
 };
 
 class Node;
@@ -0,0 +1,279 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCRefTracker.h"
+
+#if CC_ENABLE_REF_TRACKING
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+#include "base/CCRef.h"
+#include "base/ccMacros.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+// the classes, by address of their type_info. The lookups are lockless, the insertions are done with s_typesMutex.
+static const size_t TYPE_TABLE_SIZE = 4096;
+static std::atomic<const std::type_info*> s_typeKeys[TYPE_TABLE_SIZE];
+static RefTypeStats* s_typeValues[TYPE_TABLE_SIZE];
+static std::mutex s_typesMutex;
+
+static std::atomic<size_t> s_constructions(0);
+static std::atomic<size_t> s_destructions(0);
+// objects deleted without being released or autoreleased: their class is unknown
+static std::atomic<size_t> s_unattributedDestructions(0);
+static std::atomic<size_t> s_frameConstructions(0);
+static std::atomic<size_t> s_framePoolObjects(0);
+static size_t s_lastFrameConstructions = 0;
+static size_t s_lastFramePoolObjects = 0;
+static size_t s_peakFramePoolObjects = 0;
+
+// size of the object being constructed by the thread
+static thread_local size_t s_pendingSize = 0;
+
+// never destroyed: objects can be destroyed by static destructors
+static std::vector<RefTypeStats*>& getTypes()
+{
+    static auto types = new std::vector<RefTypeStats*>();
+    return *types;
+}
+
+static std::string demangle(const char* name)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (demangled)
+    {
+        std::string result(demangled);
+        free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+static RefTypeStats* findType(const std::type_info& type)
+{
+    const size_t mask = TYPE_TABLE_SIZE - 1;
+    size_t slot = std::hash<const void*>()(&type) & mask;
+    for (size_t probe = 0; probe < TYPE_TABLE_SIZE; ++probe, slot = (slot + 1) & mask)
+    {
+        const std::type_info* key = s_typeKeys[slot].load(std::memory_order_acquire);
+        if (key == &type)
+        {
+            return s_typeValues[slot];
+        }
+        if (key == nullptr)
+        {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s_typesMutex);
+    // the same class can have several type_info in different modules, they share the counters
+    std::string name = demangle(type.name());
+    RefTypeStats* stats = nullptr;
+    auto& types = getTypes();
+    for (auto t : types)
+    {
+        if (t->name == name)
+        {
+            stats = t;
+            break;
+        }
+    }
+    if (stats == nullptr)
+    {
+        stats = new RefTypeStats();
+        stats->name = name;
+        types.push_back(stats);
+    }
+
+    slot = std::hash<const void*>()(&type) & mask;
+    for (size_t probe = 0; probe < TYPE_TABLE_SIZE; ++probe, slot = (slot + 1) & mask)
+    {
+        const std::type_info* key = s_typeKeys[slot].load(std::memory_order_relaxed);
+        if (key == &type)
+        {
+            // inserted by another thread
+            return s_typeValues[slot];
+        }
+        if (key == nullptr)
+        {
+            s_typeValues[slot] = stats;
+            s_typeKeys[slot].store(&type, std::memory_order_release);
+            return stats;
+        }
+    }
+
+    CCLOG("cocos2d: RefTracker: too many classes, %s isn't cached", name.c_str());
+    return stats;
+}
+
+void RefTracker::willAllocate(size_t size)
+{
+    s_pendingSize = size;
+}
+
+void RefTracker::trackConstruction(Ref* ref)
+{
+    ref->_trackedType = nullptr;
+    ref->_trackedSize = s_pendingSize;
+    s_pendingSize = 0;
+
+    s_constructions.fetch_add(1, std::memory_order_relaxed);
+    s_frameConstructions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RefTracker::trackDestruction(Ref* ref)
+{
+    s_destructions.fetch_add(1, std::memory_order_relaxed);
+
+    RefTypeStats* stats = ref->_trackedType;
+    if (stats)
+    {
+        stats->live.fetch_sub(1, std::memory_order_relaxed);
+        stats->liveBytes.fetch_sub(ref->_trackedSize, std::memory_order_relaxed);
+    }
+    else
+    {
+        s_unattributedDestructions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RefTracker::attribute(Ref* ref)
+{
+    if (ref->_trackedType)
+    {
+        return;
+    }
+
+    RefTypeStats* stats = findType(typeid(*ref));
+    ref->_trackedType = stats;
+    stats->allocations.fetch_add(1, std::memory_order_relaxed);
+    stats->frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    stats->bytes.fetch_add(ref->_trackedSize, std::memory_order_relaxed);
+    stats->live.fetch_add(1, std::memory_order_relaxed);
+    stats->liveBytes.fetch_add(ref->_trackedSize, std::memory_order_relaxed);
+}
+
+void RefTracker::trackAutorelease(Ref* ref)
+{
+    attribute(ref);
+    ref->_trackedType->autoreleases.fetch_add(1, std::memory_order_relaxed);
+    ref->_trackedType->frameAutoreleases.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RefTracker::trackPoolClear(size_t objectCount)
+{
+    s_framePoolObjects.fetch_add(objectCount, std::memory_order_relaxed);
+}
+
+void RefTracker::endFrame()
+{
+    std::lock_guard<std::mutex> lock(s_typesMutex);
+    for (auto stats : getTypes())
+    {
+        stats->lastFrameAllocations = stats->frameAllocations.exchange(0, std::memory_order_relaxed);
+        stats->lastFrameAutoreleases = stats->frameAutoreleases.exchange(0, std::memory_order_relaxed);
+        stats->peakFrameAllocations = std::max(stats->peakFrameAllocations, stats->lastFrameAllocations);
+    }
+    s_lastFrameConstructions = s_frameConstructions.exchange(0, std::memory_order_relaxed);
+    s_lastFramePoolObjects = s_framePoolObjects.exchange(0, std::memory_order_relaxed);
+    s_peakFramePoolObjects = std::max(s_peakFramePoolObjects, s_lastFramePoolObjects);
+}
+
+std::string RefTracker::getReport()
+{
+    std::lock_guard<std::mutex> lock(s_typesMutex);
+    std::vector<RefTypeStats*> types = getTypes();
+    std::sort(types.begin(), types.end(), [](const RefTypeStats* a, const RefTypeStats* b) {
+        if (a->lastFrameAllocations != b->lastFrameAllocations)
+            return a->lastFrameAllocations > b->lastFrameAllocations;
+        return a->allocations.load(std::memory_order_relaxed) > b->allocations.load(std::memory_order_relaxed);
+    });
+
+    size_t attributedLive = 0;
+    for (auto stats : types)
+    {
+        attributedLive += stats->live.load(std::memory_order_relaxed);
+    }
+    const size_t live = s_constructions.load(std::memory_order_relaxed) - s_destructions.load(std::memory_order_relaxed);
+
+    std::string report;
+    char line[512];
+    snprintf(line, sizeof(line), "Ref objects: %lu alive (%lu not attributed to a class yet), %lu deleted before being attributed\n",
+             (unsigned long)live, (unsigned long)(live - std::min(live, attributedLive)),
+             (unsigned long)s_unattributedDestructions.load(std::memory_order_relaxed));
+    report += line;
+    snprintf(line, sizeof(line), "Last frame: %lu Ref objects created, %lu released by the autorelease pools (peak %lu)\n\n",
+             (unsigned long)s_lastFrameConstructions, (unsigned long)s_lastFramePoolObjects, (unsigned long)s_peakFramePoolObjects);
+    report += line;
+    snprintf(line, sizeof(line), "%-48s %10s %10s %10s %10s %10s %12s %12s %10s\n",
+             "class", "frame", "peak", "total", "autorel.", "autorel./f", "alive", "alive KB", "total KB");
+    report += line;
+    for (auto stats : types)
+    {
+        snprintf(line, sizeof(line), "%-48s %10lu %10lu %10lu %10lu %10lu %12lu %12lu %10lu\n",
+                 stats->name.c_str(),
+                 (unsigned long)stats->lastFrameAllocations,
+                 (unsigned long)stats->peakFrameAllocations,
+                 (unsigned long)stats->allocations.load(std::memory_order_relaxed),
+                 (unsigned long)stats->autoreleases.load(std::memory_order_relaxed),
+                 (unsigned long)stats->lastFrameAutoreleases,
+                 (unsigned long)stats->live.load(std::memory_order_relaxed),
+                 (unsigned long)(stats->liveBytes.load(std::memory_order_relaxed) / 1024),
+                 (unsigned long)(stats->bytes.load(std::memory_order_relaxed) / 1024));
+        report += line;
+    }
+    return report;
+}
+
+std::string RefTracker::saveReport(const std::string& filename)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPath = fileUtils->isAbsolutePath(filename) ? filename : fileUtils->getWritablePath() + filename;
+    if (!fileUtils->writeStringToFile(getReport(), fullPath))
+    {
+        CCLOG("cocos2d: RefTracker: couldn't save the report to %s", fullPath.c_str());
+        return "";
+    }
+    return fullPath;
+}
+
+NS_CC_END
+
+#endif // CC_ENABLE_REF_TRACKING
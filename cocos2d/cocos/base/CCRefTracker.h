@@ -0,0 +1,114 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCREFTRACKER_H__
+#define __CCREFTRACKER_H__
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Ref;
+
+/** Allocation counters of a class derived from Ref. */
+struct CC_DLL RefTypeStats
+{
+    /** Demangled name of the class. */
+    std::string name;
+    /** Total number of objects allocated, and their bytes. */
+    std::atomic<size_t> allocations;
+    std::atomic<size_t> bytes;
+    /** Number of objects alive, and their bytes. */
+    std::atomic<size_t> live;
+    std::atomic<size_t> liveBytes;
+    /** Total number of calls to autorelease(). */
+    std::atomic<size_t> autoreleases;
+    /** Counters of the current frame. */
+    std::atomic<size_t> frameAllocations;
+    std::atomic<size_t> frameAutoreleases;
+    /** Counters of the last frame, and the highest number of allocations in a frame. */
+    size_t lastFrameAllocations;
+    size_t lastFrameAutoreleases;
+    size_t peakFrameAllocations;
+};
+
+/** @class RefTracker
+ * @brief Counts the allocations of the objects derived from Ref, by class, to find the classes that churn the most.
+ *
+ * It is enabled by CC_ENABLE_REF_TRACKING. The constructor, autorelease() and release() of Ref call the tracker.
+ * The class of an object can't be known in the constructor of Ref, so an object is attributed to its class the
+ * first time it is autoreleased, or when it is released for the last time. The objects that aren't autoreleased
+ * and are still alive are reported as unattributed.
+ * The sizes are recorded by operator new of Ref, and by the classes that use CC_DECLARE_OBJECT_POOL.
+ *
+ * The counters are updated with relaxed atomics, so the objects can be allocated by any thread.
+ * @since v3.17
+ */
+class CC_DLL RefTracker
+{
+public:
+    /** Records the size of the object about to be constructed by the calling thread. */
+    static void willAllocate(size_t size);
+    /** Called by the constructor of Ref. */
+    static void trackConstruction(Ref* ref);
+    /** Called by the destructor of Ref. */
+    static void trackDestruction(Ref* ref);
+    /** Called by Ref::autorelease(). */
+    static void trackAutorelease(Ref* ref);
+    /** Attributes an object to its class, if it isn't yet. Must be called while the dynamic type of the object is
+     * valid, ie: not by the constructors or the destructors.
+     */
+    static void attribute(Ref* ref);
+    /** Called by AutoreleasePool::clear(). */
+    static void trackPoolClear(size_t objectCount);
+
+    /** Collects the counters of the frame. Called by Director::mainLoop() at the end of each frame. */
+    static void endFrame();
+
+    /** Returns the report, the classes sorted by allocations in the last frame then in total. */
+    static std::string getReport();
+    /** Saves the report.
+     * @param filename Full path of the file, or a file name relative to the writable path.
+     * @return The full path of the saved file, or an empty string if it couldn't be saved.
+     */
+    static std::string saveReport(const std::string& filename);
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CCREFTRACKER_H__
@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include "base/utlist.h"
 #include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
+#include "base/CCFrameTracer.h"
+
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -62,12 +65,17 @@ typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
     Timer               *currentTimer;
+    unsigned int        order;
     bool                paused;
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// states of a timer that is not in the heap
+static const int TIMER_NOT_SCHEDULED = -1;
+static const int TIMER_DUE = -2;     // being updated in this frame
+static const int TIMER_PAUSED = -3;
+
 // implementation Timer
 
 Timer::Timer()
@@ -80,6 +88,9 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _lastUpdateTime(0.0)
+, _heapIndex(TIMER_NOT_SCHEDULED)
+, _order(0)
 {
 }
 
@@ -259,13 +270,14 @@ Scheduler::Scheduler(void)
 , _hashForTimers(nullptr)
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
+, _timerTime(0.0)
+, _timerOrder(0)
 , _updateHashLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _performFunctionsTimeBudget(0.0f)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
 }
 
 Scheduler::~Scheduler(void)
@@ -275,6 +287,10 @@ Scheduler::~Scheduler(void)
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
 {
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        removeTimerFromHeap(static_cast<Timer*>(element->timers->arr[i]));
+    }
     ccArrayFree(element->timers);
     HASH_DEL(_hashForTimers, element);
     free(element);
@@ -298,6 +314,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
 
+        element->order = _timerOrder++;
         HASH_ADD_PTR(_hashForTimers, target, element);
 
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
@@ -322,6 +339,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                rescheduleTimer(timer);
                 return;
             }
         }
@@ -331,6 +349,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    addTimer(timer, element);
     timer->release();
 }
 
@@ -362,13 +381,9 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     timer->setAborted();
                 }
 
+                removeTimerFromHeap(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
 
                 if (element->timers->num == 0)
                 {
@@ -642,6 +657,11 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimer->setAborted();
         }
+
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            removeTimerFromHeap(static_cast<Timer*>(element->timers->arr[i]));
+        }
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -690,7 +710,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        setTimersPaused(element, false);
     }
 
     // update selector
@@ -712,7 +732,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
     }
 
     // update selector
@@ -761,7 +781,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
         idsWithSelectors.insert(element->target);
     }
 
@@ -809,19 +829,167 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(std::function<void ()> function)
 {
-    std::lock_guard<std::mutex> lock(_performMutex);
-    _functionsToPerform.push_back(std::move(function));
+    _functionsToPerform.push(std::move(function));
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
-    std::unique_lock<std::mutex> lock(_performMutex);
     _functionsToPerform.clear();
 }
 
+void Scheduler::addTimer(Timer* timer, tHashTimerEntry* element)
+{
+    timer->_order = _timerOrder++;
+    if (element->paused)
+    {
+        timer->_heapIndex = TIMER_PAUSED;
+        timer->_lastUpdateTime = 0.0;
+    }
+    else
+    {
+        pushTimerToHeap(timer, element);
+    }
+}
+
+double Scheduler::getTimerDeadline(const Timer* timer) const
+{
+    // a new timer starts in the next update
+    if (timer->_elapsed == -1)
+    {
+        return _timerTime;
+    }
+    const float timeout = timer->_useDelay ? timer->_delay : timer->_interval;
+    return timer->_lastUpdateTime + std::max(timeout - timer->_elapsed, 0.0f);
+}
+
+void Scheduler::pushTimerToHeap(Timer* timer, tHashTimerEntry* element)
+{
+    TimerHeapEntry entry;
+    entry.deadline = getTimerDeadline(timer);
+    entry.order = (static_cast<uint64_t>(element->order) << 32) | timer->_order;
+    entry.timer = timer;
+    entry.element = element;
+
+    timer->_heapIndex = static_cast<int>(_timerHeap.size());
+    _timerHeap.push_back(entry);
+    siftTimerUp(_timerHeap.size() - 1);
+}
+
+void Scheduler::removeTimerFromHeap(Timer* timer)
+{
+    const int index = timer->_heapIndex;
+    timer->_heapIndex = TIMER_NOT_SCHEDULED;
+    if (index < 0)
+    {
+        return;
+    }
+
+    const size_t last = _timerHeap.size() - 1;
+    if (static_cast<size_t>(index) != last)
+    {
+        _timerHeap[index] = _timerHeap[last];
+        _timerHeap[index].timer->_heapIndex = index;
+        _timerHeap.pop_back();
+        siftTimerUp(index);
+        siftTimerDown(_timerHeap[index].timer->_heapIndex);
+    }
+    else
+    {
+        _timerHeap.pop_back();
+    }
+}
+
+void Scheduler::rescheduleTimer(Timer* timer)
+{
+    // the timer was reset, it starts again in the next update
+    const int index = timer->_heapIndex;
+    if (index >= 0)
+    {
+        _timerHeap[index].deadline = getTimerDeadline(timer);
+        siftTimerUp(index);
+    }
+    else if (index == TIMER_PAUSED)
+    {
+        timer->_lastUpdateTime = 0.0;
+    }
+}
+
+void Scheduler::setTimersPaused(tHashTimerEntry* element, bool paused)
+{
+    if (element->paused == paused)
+    {
+        return;
+    }
+    element->paused = paused;
+
+    // the paused timers leave the heap, and keep the time since their last update
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer* timer = static_cast<Timer*>(element->timers->arr[i]);
+        if (paused && timer->_heapIndex != TIMER_NOT_SCHEDULED && timer->_heapIndex != TIMER_PAUSED)
+        {
+            removeTimerFromHeap(timer);
+            timer->_lastUpdateTime = _timerTime - timer->_lastUpdateTime;
+            timer->_heapIndex = TIMER_PAUSED;
+        }
+        else if (!paused && timer->_heapIndex == TIMER_PAUSED)
+        {
+            timer->_lastUpdateTime = _timerTime - timer->_lastUpdateTime;
+            pushTimerToHeap(timer, element);
+        }
+    }
+}
+
+void Scheduler::siftTimerUp(size_t index)
+{
+    TimerHeapEntry entry = _timerHeap[index];
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+        if (_timerHeap[parent].deadline <= entry.deadline)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index].timer->_heapIndex = static_cast<int>(index);
+        index = parent;
+    }
+    _timerHeap[index] = entry;
+    entry.timer->_heapIndex = static_cast<int>(index);
+}
+
+void Scheduler::siftTimerDown(size_t index)
+{
+    const size_t size = _timerHeap.size();
+    TimerHeapEntry entry = _timerHeap[index];
+    for (;;)
+    {
+        size_t child = index * 2 + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && _timerHeap[child + 1].deadline < _timerHeap[child].deadline)
+        {
+            ++child;
+        }
+        if (entry.deadline <= _timerHeap[child].deadline)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index].timer->_heapIndex = static_cast<int>(index);
+        index = child;
+    }
+    _timerHeap[index] = entry;
+    entry.timer->_heapIndex = static_cast<int>(index);
+}
+
 // main loop
 void Scheduler::update(float dt)
 {
+    CC_TRACE_SCOPE("Scheduler::update");
+
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -863,47 +1031,60 @@ void Scheduler::update(float dt)
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    // Update the custom selectors that are due, the others are not visited
+    _timerTime += dt;
+    while (!_timerHeap.empty() && _timerHeap.front().deadline <= _timerTime)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        TimerHeapEntry due = _timerHeap.front();
+        removeTimerFromHeap(due.timer);
+        due.timer->_heapIndex = TIMER_DUE;
+        due.timer->retain();
+        _dueTimers.push_back(due);
+    }
+    // same order as if all the timers were visited: by target, then by timer
+    std::sort(_dueTimers.begin(), _dueTimers.end(), [](const TimerHeapEntry& a, const TimerHeapEntry& b) {
+        return a.order < b.order;
+    });
 
-        if (! _currentTarget->paused)
+    for (const auto& due : _dueTimers)
+    {
+        Timer* timer = due.timer;
+        // the timer may have been unscheduled or paused by a previous callback, then its target may be gone
+        if (timer->_heapIndex == TIMER_DUE)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
+            tHashTimerEntry* elt = due.element;
+            _currentTarget = elt;
+            _currentTargetSalvaged = false;
 
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+            elt->currentTimer = timer;
+            const float elapsed = static_cast<float>(_timerTime - timer->_lastUpdateTime);
+            timer->_lastUpdateTime = _timerTime;
+            timer->update(elapsed);
 
-                elt->currentTimer = nullptr;
+            if (timer->isAborted())
+            {
+                // The currentTimer told the remove itself. To prevent the timer from
+                // accidentally deallocating itself before finishing its step, we retained
+                // it. Now that step is done, it's safe to release it.
+                timer->release();
             }
-        }
+            elt->currentTimer = nullptr;
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+            if (timer->_heapIndex == TIMER_DUE)
+            {
+                pushTimerToHeap(timer, elt);
+            }
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
+            // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+            if (_currentTargetSalvaged && elt->timers->num == 0)
+            {
+                removeHashElement(elt);
+            }
         }
+        timer->release();
     }
- 
+    _dueTimers.clear();
+
     // delete all updates that are removed in update
     for (auto &e : _updateDeleteVector)
         delete e;
@@ -939,17 +1120,9 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
+    // The queue is lock-free, the functions added by these functions are run in the next frame.
     if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
-        _performMutex.unlock();
-        
-        for (const auto &function : temp) {
-            function();
-        }
+        _functionsToPerform.run(_performFunctionsTimeBudget);
     }
 }
 
@@ -965,6 +1138,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
         
+        element->order = _timerOrder++;
         HASH_ADD_PTR(_hashForTimers, target, element);
         
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
@@ -989,6 +1163,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                rescheduleTimer(timer);
                 return;
             }
         }
@@ -998,6 +1173,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    addTimer(timer, element);
     timer->release();
 }
 
@@ -1062,13 +1238,9 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     timer->setAborted();
                 }
                 
+                removeTimerFromHeap(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
-                
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
+
                 
                 if (element->timers->num == 0)
                 {
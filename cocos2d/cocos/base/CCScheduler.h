@@ -29,13 +29,17 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <set>
+#include <type_traits>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
 #include "base/uthash.h"
+#include "base/CCFunctionQueue.h"
 
 NS_CC_BEGIN
 
@@ -63,6 +67,8 @@ public:
     void update(float dt);
     
 protected:
+    friend class Scheduler;
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -72,6 +78,11 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    // used by the Scheduler to update the timer only when it is due
+    double _lastUpdateTime; // time of the scheduler at the last update, or the time since then while the target is paused
+    int _heapIndex;         // index in the scheduler's heap, or a state when the timer is not in the heap
+    unsigned int _order;    // order in which the timers were scheduled
 };
 
 
@@ -428,6 +439,32 @@ public:
      @js NA
      */
     void performFunctionInCocosThread(std::function<void()> function);
+
+    /** Calls a callable object on the cocos2d thread, like performFunctionInCocosThread(std::function<void()>).
+     Small callables (eg: lambdas that capture a few values) are stored without allocating.
+     This function is thread safe.
+     @param function The callable object to be run in cocos2d thread.
+     @since v3.17
+     @js NA
+     @lua NA
+     */
+    template <typename Function, typename = typename std::enable_if<!std::is_same<typename std::decay<Function>::type, std::function<void()>>::value>::type>
+    void performFunctionInCocosThread(Function&& function)
+    {
+        _functionsToPerform.push(std::forward<Function>(function));
+    }
+
+    /** Sets the max time spent each frame running the functions of performFunctionInCocosThread, in seconds.
+     The functions left are run in the next frames, in order. 0, the default, means no limit.
+     @since v3.17
+     @js NA
+     */
+    void setPerformFunctionsTimeBudget(float seconds) { _performFunctionsTimeBudget = seconds; }
+    /** Gets the max time spent each frame running the functions of performFunctionInCocosThread, in seconds.
+     @since v3.17
+     @js NA
+     */
+    float getPerformFunctionsTimeBudget() const { return _performFunctionsTimeBudget; }
     
     /**
      * Remove all pending functions queued to be performed with Scheduler::performFunctionInCocosThread
@@ -508,6 +545,24 @@ protected:
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     
     void removeHashElement(struct _hashSelectorEntry *element);
+
+    // interval timers, sorted by the time of their next update in a binary min-heap
+    struct TimerHeapEntry
+    {
+        double deadline;
+        uint64_t order;
+        Timer* timer;
+        struct _hashSelectorEntry* element;
+    };
+
+    void addTimer(Timer* timer, struct _hashSelectorEntry* element);
+    void pushTimerToHeap(Timer* timer, struct _hashSelectorEntry* element);
+    void removeTimerFromHeap(Timer* timer);
+    void rescheduleTimer(Timer* timer);
+    void setTimersPaused(struct _hashSelectorEntry* element, bool paused);
+    double getTimerDeadline(const Timer* timer) const;
+    void siftTimerUp(size_t index);
+    void siftTimerDown(size_t index);
     void removeUpdateFromHash(struct _listEntry *entry);
 
     // update specific
@@ -531,6 +586,10 @@ protected:
     struct _hashSelectorEntry *_hashForTimers;
     struct _hashSelectorEntry *_currentTarget;
     bool _currentTargetSalvaged;
+    std::vector<TimerHeapEntry> _timerHeap;
+    std::vector<TimerHeapEntry> _dueTimers; // timers being updated in this frame
+    double _timerTime;                      // sum of the scaled delta times
+    unsigned int _timerOrder;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
     
@@ -539,8 +598,8 @@ protected:
 #endif
     
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    FunctionQueue _functionsToPerform;
+    float _performFunctionsTimeBudget;
 };
 
 // end of base group
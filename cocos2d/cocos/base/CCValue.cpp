@@ -27,10 +27,108 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <atomic>
 #include "base/ccUtils.h"
 
 NS_CC_BEGIN
 
+// ValueArena
+
+struct ValueArena::Chunk
+{
+    // The arena holds a reference to its current chunk, and every string in the chunk holds one
+    std::atomic<int> referenceCount;
+    size_t capacity;
+    size_t used;
+
+    char* getData() { return reinterpret_cast<char*>(this + 1); }
+};
+
+// Not a class member: thread_local data can't be exported from a DLL
+static thread_local ValueArena* s_currentValueArena = nullptr;
+
+ValueArena::ValueArena(size_t chunkSize)
+: _previous(s_currentValueArena)
+, _chunk(nullptr)
+, _chunkSize(chunkSize)
+{
+    s_currentValueArena = this;
+}
+
+ValueArena::~ValueArena()
+{
+    CCASSERT(s_currentValueArena == this, "ValueArenas must be destroyed in the reverse order of their creation");
+    s_currentValueArena = _previous;
+
+    if (_chunk)
+        releaseChunk(_chunk);
+}
+
+ValueArena* ValueArena::getCurrent()
+{
+    return s_currentValueArena;
+}
+
+void* ValueArena::allocate(size_t size, Chunk** chunk)
+{
+    const size_t alignment = sizeof(void*);
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    // A large string would waste the end of the chunks, it gets its own allocation
+    if (size > _chunkSize / 4)
+        return nullptr;
+
+    if (_chunk == nullptr || _chunk->used + size > _chunk->capacity)
+    {
+        auto newChunk = static_cast<Chunk*>(malloc(sizeof(Chunk) + _chunkSize));
+        if (newChunk == nullptr)
+            return nullptr;
+
+        new (newChunk) Chunk();
+        newChunk->referenceCount = 1;
+        newChunk->capacity = _chunkSize;
+        newChunk->used = 0;
+
+        if (_chunk)
+            releaseChunk(_chunk);
+        _chunk = newChunk;
+    }
+
+    void* memory = _chunk->getData() + _chunk->used;
+    _chunk->used += size;
+    retainChunk(_chunk);
+    *chunk = _chunk;
+    return memory;
+}
+
+void ValueArena::retainChunk(Chunk* chunk)
+{
+    chunk->referenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ValueArena::releaseChunk(Chunk* chunk)
+{
+    if (chunk->referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        chunk->~Chunk();
+        free(chunk);
+    }
+}
+
+// Value
+
+// A string too long to be stored inline, followed by its null-terminated chars. Values never modify their string,
+// so the copies of a Value share it.
+struct Value::SharedString
+{
+    // nullptr if the string has its own allocation, and counts its references itself
+    ValueArena::Chunk* chunk;
+    std::atomic<int> referenceCount;
+    unsigned int length;
+
+    char* getData() { return reinterpret_cast<char*>(this + 1); }
+};
+
 const ValueVector ValueVectorNull;
 const ValueMap ValueMapNull;
 const ValueMapIntKey ValueMapIntKeyNull;
@@ -39,6 +137,7 @@ const Value Value::Null;
 
 Value::Value()
 : _type(Type::NONE)
+, _smallStringLength(0)
 {
     memset(&_field, 0, sizeof(_field));
 }
@@ -80,20 +179,21 @@ Value::Value(bool v)
 }
 
 Value::Value(const char* v)
-: _type(Type::STRING)
+: _type(Type::NONE)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    if (v)
-    {
-        *_field.strVal = v;
-    }
+    setString(v, v ? strlen(v) : 0);
+}
+
+Value::Value(const char* v, size_t length)
+: _type(Type::NONE)
+{
+    setString(v, length);
 }
 
 Value::Value(const std::string& v)
-: _type(Type::STRING)
+: _type(Type::NONE)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    *_field.strVal = v;
+    setString(v.data(), v.length());
 }
 
 Value::Value(const ValueVector& v)
@@ -180,11 +280,14 @@ Value& Value::operator= (const Value& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                if (_field.strVal == nullptr)
+                clear();
+                _field = other._field;
+                _smallStringLength = other._smallStringLength;
+                if (_smallStringLength == SHARED_STRING)
                 {
-                    _field.strVal = new std::string();
+                    retainString(_field.strVal);
                 }
-                *_field.strVal = *other._field.strVal;
+                _type = Type::STRING;
                 break;
             case Type::VECTOR:
                 if (_field.vectorVal == nullptr)
@@ -240,7 +343,8 @@ Value& Value::operator= (Value&& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                _field.strVal = other._field.strVal;
+                _field = other._field;
+                _smallStringLength = other._smallStringLength;
                 break;
             case Type::VECTOR:
                 _field.vectorVal = other._field.vectorVal;
@@ -307,15 +411,13 @@ Value& Value::operator= (bool v)
 
 Value& Value::operator= (const char* v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    setString(v, v ? strlen(v) : 0);
     return *this;
 }
 
 Value& Value::operator= (const std::string& v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v;
+    setString(v.data(), v.length());
     return *this;
 }
 
@@ -386,7 +488,11 @@ bool Value::operator== (const Value& v) const
         case Type::INTEGER: return v._field.intVal      == this->_field.intVal;
         case Type::UNSIGNED:return v._field.unsignedVal == this->_field.unsignedVal;
         case Type::BOOLEAN: return v._field.boolVal     == this->_field.boolVal;
-        case Type::STRING:  return *v._field.strVal     == *this->_field.strVal;
+        case Type::STRING:
+        {
+            const size_t length = getStringLength();
+            return v.getStringLength() == length && memcmp(v.getStringData(), getStringData(), length) == 0;
+        }
         case Type::FLOAT:   return std::abs(v._field.floatVal  - this->_field.floatVal)  <= FLT_EPSILON;
         case Type::DOUBLE:  return std::abs(v._field.doubleVal - this->_field.doubleVal) <= DBL_EPSILON;
         case Type::VECTOR:
@@ -461,7 +567,7 @@ unsigned char Value::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getStringData()));
     }
 
     if (_type == Type::FLOAT)
@@ -503,7 +609,7 @@ int Value::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getStringData());
     }
 
     if (_type == Type::FLOAT)
@@ -547,7 +653,7 @@ unsigned int Value::asUnsignedInt() const
     if (_type == Type::STRING)
     {
         // NOTE: strtoul is required (need to augment on unsupported platforms)
-        return static_cast<unsigned int>(strtoul(_field.strVal->c_str(), nullptr, 10));
+        return static_cast<unsigned int>(strtoul(getStringData(), nullptr, 10));
     }
 
     if (_type == Type::FLOAT)
@@ -583,7 +689,7 @@ float Value::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return utils::atof(_field.strVal->c_str());
+        return utils::atof(getStringData());
     }
 
     if (_type == Type::INTEGER)
@@ -624,7 +730,7 @@ double Value::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(utils::atof(_field.strVal->c_str()));
+        return static_cast<double>(utils::atof(getStringData()));
     }
 
     if (_type == Type::INTEGER)
@@ -665,7 +771,8 @@ bool Value::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        const char* str = getStringData();
+        return (strcmp(str, "0") == 0 || strcmp(str, "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -697,7 +804,7 @@ std::string Value::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        return std::string(getStringData(), getStringLength());
     }
 
     std::stringstream ret;
@@ -884,7 +991,11 @@ void Value::clear()
             _field.boolVal = false;
             break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (_smallStringLength == SHARED_STRING)
+            {
+                releaseString(_field.strVal);
+            }
+            _field.strVal = nullptr;
             break;
         case Type::VECTOR:
             CC_SAFE_DELETE(_field.vectorVal);
@@ -913,7 +1024,8 @@ void Value::reset(Type type)
     switch (type)
     {
         case Type::STRING:
-            _field.strVal = new (std::nothrow) std::string();
+            _field.smallStrVal[0] = '\0';
+            _smallStringLength = 0;
             break;
         case Type::VECTOR:
             _field.vectorVal = new (std::nothrow) ValueVector();
@@ -931,4 +1043,81 @@ void Value::reset(Type type)
     _type = type;
 }
 
+void Value::setString(const char* v, size_t length)
+{
+    clear();
+    _type = Type::STRING;
+
+    if (length <= SMALL_STRING_CAPACITY)
+    {
+        if (length > 0)
+        {
+            memcpy(_field.smallStrVal, v, length);
+        }
+        _field.smallStrVal[length] = '\0';
+        _smallStringLength = static_cast<unsigned char>(length);
+        return;
+    }
+
+    const size_t size = sizeof(SharedString) + length + 1;
+    ValueArena::Chunk* chunk = nullptr;
+    void* memory = nullptr;
+
+    auto arena = ValueArena::getCurrent();
+    if (arena)
+    {
+        memory = arena->allocate(size, &chunk);
+    }
+    if (memory == nullptr)
+    {
+        memory = malloc(size);
+    }
+
+    auto str = new (memory) SharedString();
+    str->chunk = chunk;
+    str->referenceCount = 1;
+    str->length = static_cast<unsigned int>(length);
+    memcpy(str->getData(), v, length);
+    str->getData()[length] = '\0';
+
+    _field.strVal = str;
+    _smallStringLength = SHARED_STRING;
+}
+
+const char* Value::getStringData() const
+{
+    return _smallStringLength == SHARED_STRING ? _field.strVal->getData() : _field.smallStrVal;
+}
+
+size_t Value::getStringLength() const
+{
+    return _smallStringLength == SHARED_STRING ? _field.strVal->length : _smallStringLength;
+}
+
+void Value::retainString(SharedString* str)
+{
+    if (str->chunk)
+    {
+        ValueArena::retainChunk(str->chunk);
+    }
+    else
+    {
+        str->referenceCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Value::releaseString(SharedString* str)
+{
+    if (str->chunk)
+    {
+        // The string is trivially destructible, its memory goes with the chunk
+        ValueArena::releaseChunk(str->chunk);
+    }
+    else if (str->referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        str->~SharedString();
+        free(str);
+    }
+}
+
 NS_CC_END
@@ -49,8 +49,54 @@ CC_DLL extern const ValueVector ValueVectorNull;
 CC_DLL extern const ValueMap ValueMapNull;
 CC_DLL extern const ValueMapIntKey ValueMapIntKeyNull;
 
+/** @class ValueArena
+ * @brief Shared storage for the long strings of the Values of a document.
+ *
+ * Strings of up to 15 chars are stored inside the Value itself. Longer ones normally get an allocation each, but
+ * while a ValueArena is alive, the Values created on its thread copy them into the arena's chunks instead.
+ * A chunk is reference counted by the strings in it, so Values stay valid after the arena is destroyed, and the
+ * chunk is freed with the last of them. Parsers create one on the stack for the duration of a document:
+ * @code
+ * ValueArena arena;
+ * ValueMap dict = parseDocument(data);
+ * @endcode
+ * Arenas nest: the last one created on a thread is the current one.
+ * @since v3.17
+ */
+class CC_DLL ValueArena
+{
+public:
+    /** The default size of the chunks, in bytes. */
+    static const size_t DEFAULT_CHUNK_SIZE = 16 * 1024;
+
+    /** Makes a new arena the current one of the calling thread. */
+    explicit ValueArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    /** Restores the previous arena of the calling thread. */
+    ~ValueArena();
+
+    /** Gets the current arena of the calling thread, or nullptr. */
+    static ValueArena* getCurrent();
+
+    /** An opaque block of the arena's memory. */
+    struct Chunk;
+
+private:
+    friend class Value;
+
+    void* allocate(size_t size, Chunk** chunk);
+    static void retainChunk(Chunk* chunk);
+    static void releaseChunk(Chunk* chunk);
+
+    ValueArena* _previous;
+    Chunk* _chunk;
+    size_t _chunkSize;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(ValueArena);
+};
+
 /*
  * This class is provide as a wrapper of basic types, such as int and bool.
+ * Strings of up to 15 chars are stored inline, longer ones are shared between copies of the Value.
  */
 class CC_DLL Value
 {
@@ -81,6 +127,9 @@ public:
     
     /** Create a Value by a char pointer. It will copy the chars internally. */
     explicit Value(const char* v);
+
+    /** Create a Value by the first length chars of a char pointer. It will copy the chars internally. */
+    Value(const char* v, size_t length);
     
     /** Create a Value by a string. */
     explicit Value(const std::string& v);
@@ -224,8 +273,21 @@ public:
     std::string getDescription() const;
 
 private:
+    /** The longest string stored inside the Value. */
+    static const size_t SMALL_STRING_CAPACITY = 15;
+    /** The value of _smallStringLength when the string is a SharedString. */
+    static const unsigned char SHARED_STRING = 0xff;
+
+    struct SharedString;
+
     void clear();
     void reset(Type type);
+    void setString(const char* v, size_t length);
+    const char* getStringData() const;
+    size_t getStringLength() const;
+
+    static void retainString(SharedString* str);
+    static void releaseString(SharedString* str);
 
     union
     {
@@ -236,13 +298,16 @@ private:
         double doubleVal;
         bool boolVal;
 
-        std::string* strVal;
+        SharedString* strVal;
         ValueVector* vectorVal;
         ValueMap* mapVal;
         ValueMapIntKey* intKeyMapVal;
+
+        char smallStrVal[SMALL_STRING_CAPACITY + 1];
     }_field;
 
     Type _type;
+    unsigned char _smallStringLength;
 };
 
 /** @} */
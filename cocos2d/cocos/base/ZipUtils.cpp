@@ -36,6 +36,9 @@
 #include <zlib.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
@@ -56,7 +59,8 @@ bool ZipUtils::s_bEncryptionKeyIsValid = false;
 
 // --------------------- ZipUtils ---------------------
 
-inline void ZipUtils::decodeEncodedPvr(unsigned int *data, ssize_t len)
+// first is the index of data[0] among the encrypted ints, so a buffer can be decrypted in chunks
+inline void ZipUtils::decodeEncodedPvr(unsigned int *data, ssize_t len, ssize_t first)
 {
     const int enclen = 1024;
     const int securelen = 512;
@@ -99,21 +103,24 @@ inline void ZipUtils::decodeEncodedPvr(unsigned int *data, ssize_t len)
         s_bEncryptionKeyIsValid = true;
     }
     
-    int b = 0;
-    int i = 0;
+    ssize_t i = 0;
     
     // encrypt first part completely
-    for(; i < len && i < securelen; i++)
+    for(; i < len && first + i < securelen; i++)
     {
-        data[i] ^= s_uEncryptionKey[b++];
-        
-        if(b >= enclen)
-        {
-            b = 0;
-        }
+        data[i] ^= s_uEncryptionKey[first + i];
     }
     
-    // encrypt second section partially
+    if(i >= len)
+    {
+        return;
+    }
+    
+    // encrypt second section partially, every distance-th int past the first part
+    ssize_t index = first + i;
+    i += (distance - (index - securelen) % distance) % distance;
+    int b = static_cast<int>((securelen + (first + i - securelen) / distance) % enclen);
+    
     for(; i < len; i += distance)
     {
         data[i] ^= s_uEncryptionKey[b++];
@@ -371,71 +378,20 @@ bool ZipUtils::isGZipBuffer(const unsigned char *buffer, ssize_t len)
 
 int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, unsigned char **out)
 {
-    struct CCZHeader *header = (struct CCZHeader*) buffer;
-
-    // verify header
-    if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == '!' )
+    if (!isCCZBuffer(buffer, bufferLen))
     {
-        // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
-        if( version > 2 )
-        {
-            CCLOG("cocos2d: Unsupported CCZ header format");
-            return -1;
-        }
-
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
-        {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
-            return -1;
-        }
+        CCLOG("cocos2d: Invalid CCZ file");
+        return -1;
     }
-    else if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == 'p' )
-    {
-        // encrypted ccz file
-        header = (struct CCZHeader*) buffer;
 
-        // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
-        if( version > 0 )
-        {
-            CCLOG("cocos2d: Unsupported CCZ header format");
-            return -1;
-        }
-
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
-        {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
-            return -1;
-        }
-
-        // decrypt
-        unsigned int* ints = (unsigned int*)(buffer+12);
-        ssize_t enclen = (bufferLen-12)/4;
-
-        decodeEncodedPvr(ints, enclen);
-
-#if COCOS2D_DEBUG > 0
-        // verify checksum in debug mode
-        unsigned int calculated = checksumPvr(ints, enclen);
-        unsigned int required = CC_SWAP_INT32_BIG_TO_HOST( header->reserved );
-
-        if(calculated != required)
-        {
-            CCLOG("cocos2d: Can't decrypt image file. Is the decryption key valid?");
-            return -1;
-        }
-#endif
-    }
-    else
+    // The stream checks the header and decrypts a copy of the data, buffer may be read only
+    InflateStream stream;
+    if (!stream.init(buffer, bufferLen))
     {
-        CCLOG("cocos2d: Invalid CCZ file");
         return -1;
     }
 
-    unsigned int len = CC_SWAP_INT32_BIG_TO_HOST( header->len );
+    ssize_t len = stream.getUncompressedSize();
 
     *out = (unsigned char*)malloc( len );
     if(! *out )
@@ -444,11 +400,9 @@ int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, u
         return -1;
     }
 
-    unsigned long destlen = len;
-    size_t source = (size_t) buffer + sizeof(*header);
-    int ret = uncompress(*out, &destlen, (Bytef*)source, bufferLen - sizeof(*header) );
-
-    if( ret != Z_OK )
+    // the stream must end exactly at the recorded length
+    unsigned char extra;
+    if (stream.read(*out, len) != len || stream.read(&extra, 1) != 0)
     {
         CCLOG("cocos2d: CCZ: Failed to uncompress data");
         free( *out );
@@ -456,7 +410,7 @@ int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, u
         return -1;
     }
 
-    return len;
+    return static_cast<int>(len);
 }
 
 int ZipUtils::inflateCCZFile(const char *path, unsigned char **out)
@@ -495,6 +449,205 @@ void ZipUtils::setPvrEncryptionKey(unsigned int keyPart1, unsigned int keyPart2,
     setPvrEncryptionKeyPart(3, keyPart4);
 }
 
+// --------------------- InflateStream ---------------------
+
+InflateStream::InflateStream()
+: _zstream(nullptr)
+, _in(nullptr)
+, _inLength(0)
+, _inOffset(0)
+, _decrypted(nullptr)
+, _encryptedLength(0)
+, _uncompressedSize(-1)
+, _finished(false)
+, _failed(false)
+{
+}
+
+InflateStream::~InflateStream()
+{
+    if (_zstream)
+    {
+        inflateEnd(_zstream);
+        delete _zstream;
+    }
+    free(_decrypted);
+}
+
+bool InflateStream::init(const unsigned char *in, ssize_t inLength)
+{
+    if (_zstream || !in || inLength <= 0)
+    {
+        return false;
+    }
+
+    _in = in;
+    _inLength = static_cast<size_t>(inLength);
+    _inOffset = 0;
+
+    if (ZipUtils::isCCZBuffer(in, inLength))
+    {
+        if (!initCCZ())
+        {
+            return false;
+        }
+    }
+    else if (ZipUtils::isGZipBuffer(in, inLength) && inLength >= 18)
+    {
+        // the last 4 bytes of a gzip member are its inflated size, little endian
+        const unsigned char *size = in + inLength - 4;
+        _uncompressedSize = size[0] | (size[1] << 8) | (size[2] << 16) | (static_cast<ssize_t>(size[3]) << 24);
+    }
+
+    _zstream = new (std::nothrow) z_stream();
+    if (!_zstream)
+    {
+        return false;
+    }
+
+    // 15 + 32 detects zlib and gzip headers
+    if (inflateInit2(_zstream, 15 + 32) != Z_OK)
+    {
+        delete _zstream;
+        _zstream = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool InflateStream::initCCZ()
+{
+    const struct CCZHeader *header = reinterpret_cast<const struct CCZHeader*>(_in);
+    bool encrypted = header->sig[3] == 'p';
+
+    // verify header version
+    unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
+    if( version > (encrypted ? 0u : 2u) )
+    {
+        CCLOG("cocos2d: Unsupported CCZ header format");
+        return false;
+    }
+
+    // verify compression format
+    if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
+    {
+        CCLOG("cocos2d: CCZ Unsupported compression method");
+        return false;
+    }
+
+    unsigned int len = header->len;
+    if (encrypted)
+    {
+        // every int from offset 12 on is encrypted, starting with the length
+        _encryptedLength = static_cast<ssize_t>((_inLength - 12) / 4);
+
+        unsigned int head[128];
+        ssize_t headLength = std::min<ssize_t>(_encryptedLength, 128);
+        memcpy(head, _in + 12, headLength * sizeof(unsigned int));
+        ZipUtils::decodeEncodedPvr(head, headLength, 0);
+
+#if COCOS2D_DEBUG > 0
+        // verify checksum in debug mode
+        unsigned int calculated = ZipUtils::checksumPvr(head, headLength);
+        unsigned int required = CC_SWAP_INT32_BIG_TO_HOST( header->reserved );
+
+        if(calculated != required)
+        {
+            CCLOG("cocos2d: Can't decrypt image file. Is the decryption key valid?");
+            return false;
+        }
+#endif
+
+        len = head[0];
+        _decrypted = static_cast<unsigned char*>(malloc(CHUNK_SIZE));
+        if (!_decrypted)
+        {
+            return false;
+        }
+    }
+
+    _uncompressedSize = CC_SWAP_INT32_BIG_TO_HOST( len );
+    _inOffset = sizeof(*header);
+    return true;
+}
+
+bool InflateStream::refill()
+{
+    if (_inOffset >= _inLength)
+    {
+        return false;
+    }
+
+    size_t length = _inLength - _inOffset;
+    if (_decrypted)
+    {
+        // chunks start on an int boundary of the encrypted data, the ints past the last whole one are plain
+        length = std::min(length, static_cast<size_t>(CHUNK_SIZE));
+        memcpy(_decrypted, _in + _inOffset, length);
+
+        ssize_t first = static_cast<ssize_t>((_inOffset - 12) / 4);
+        ssize_t count = std::min(static_cast<ssize_t>(length / 4), _encryptedLength - first);
+        if (count > 0)
+        {
+            ZipUtils::decodeEncodedPvr(reinterpret_cast<unsigned int*>(_decrypted), count, first);
+        }
+        _zstream->next_in = _decrypted;
+    }
+    else
+    {
+        length = std::min(length, static_cast<size_t>(UINT_MAX));
+        _zstream->next_in = const_cast<Bytef*>(_in + _inOffset);
+    }
+
+    _zstream->avail_in = static_cast<uInt>(length);
+    _inOffset += length;
+    return true;
+}
+
+ssize_t InflateStream::read(unsigned char *out, ssize_t outLength)
+{
+    if (!_zstream || _failed)
+    {
+        return -1;
+    }
+    if (_finished || outLength <= 0)
+    {
+        return 0;
+    }
+
+    ssize_t total = 0;
+    while (total < outLength)
+    {
+        if (_zstream->avail_in == 0)
+        {
+            refill();
+        }
+
+        size_t length = std::min(static_cast<size_t>(outLength - total), static_cast<size_t>(UINT_MAX));
+        _zstream->next_out = out + total;
+        _zstream->avail_out = static_cast<uInt>(length);
+
+        int err = inflate(_zstream, Z_NO_FLUSH);
+        total += length - _zstream->avail_out;
+
+        if (err == Z_STREAM_END)
+        {
+            _finished = true;
+            break;
+        }
+
+        // Z_BUF_ERROR only means no progress was possible, which is an error once the input is exhausted
+        if (err != Z_OK && (err != Z_BUF_ERROR || (_zstream->avail_in == 0 && _inOffset >= _inLength)))
+        {
+            CCLOG("cocos2d: ZipUtils: Incorrect zlib compressed data!");
+            _failed = true;
+            return -1;
+        }
+    }
+
+    return total;
+}
+
 // --------------------- ZipFile ---------------------
 // from unzip.cpp
 #define UNZ_MAXFILENAMEINZIP 256
@@ -511,6 +664,7 @@ class ZipFilePrivate
 {
 public:
     unzFile zipFile;
+    bool fileOpened;
     
     // std::unordered_map is faster if available on the platform
     typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
@@ -532,12 +686,14 @@ ZipFile::ZipFile()
 : _data(new ZipFilePrivate)
 {
     _data->zipFile = nullptr;
+    _data->fileOpened = false;
 }
 
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
     _data->zipFile = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFile).c_str());
+    _data->fileOpened = false;
     setFilter(filter);
 }
 
@@ -620,6 +776,7 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
     {
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
+        closeFile();
         
         ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
@@ -653,6 +810,7 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
     {
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
+        closeFile();
         
         ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
@@ -675,6 +833,68 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
     return res;
 }
 
+bool ZipFile::openFile(const std::string &fileName, ssize_t *size)
+{
+    if (size)
+        *size = 0;
+
+    bool res = false;
+    do
+    {
+        CC_BREAK_IF(!_data->zipFile);
+        CC_BREAK_IF(fileName.empty());
+        closeFile();
+        
+        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+        CC_BREAK_IF(it ==  _data->fileList.end());
+        
+        ZipEntryInfo fileInfo = it->second;
+        
+        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
+        CC_BREAK_IF(UNZ_OK != nRet);
+        
+        nRet = unzOpenCurrentFile(_data->zipFile);
+        CC_BREAK_IF(UNZ_OK != nRet);
+        
+        _data->fileOpened = true;
+        if (size)
+        {
+            *size = fileInfo.uncompressed_size;
+        }
+        res = true;
+    } while (0);
+    
+    return res;
+}
+
+ssize_t ZipFile::readFileData(unsigned char *buffer, ssize_t length)
+{
+    if (!_data->fileOpened)
+        return -1;
+
+    ssize_t total = 0;
+    while (total < length)
+    {
+        unsigned int chunk = static_cast<unsigned int>(std::min(length - total, static_cast<ssize_t>(INT_MAX)));
+        int nRead = unzReadCurrentFile(_data->zipFile, buffer + total, chunk);
+        if (nRead < 0)
+            return -1;
+        if (nRead == 0)
+            break;
+        total += nRead;
+    }
+    return total;
+}
+
+void ZipFile::closeFile()
+{
+    if (_data->fileOpened)
+    {
+        unzCloseCurrentFile(_data->zipFile);
+        _data->fileOpened = false;
+    }
+}
+
 std::string ZipFile::getFirstFilename()
 {
     if (unzGoToFirstFile(_data->zipFile) != UNZ_OK) return emptyFilename;
@@ -210,8 +210,10 @@ typedef struct unz_file_info_s unz_file_info;
         static void setPvrEncryptionKey(unsigned int keyPart1, unsigned int keyPart2, unsigned int keyPart3, unsigned int keyPart4);
 
     private:
+        friend class InflateStream;
+
         static int inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t *outLength, ssize_t outLengthHint);
-        static inline void decodeEncodedPvr (unsigned int *data, ssize_t len);
+        static inline void decodeEncodedPvr (unsigned int *data, ssize_t len, ssize_t first);
         static inline unsigned int checksumPvr(const unsigned int *data, ssize_t len);
 
         static unsigned int s_uEncryptedPvrKeyParts[4];
@@ -219,6 +221,79 @@ typedef struct unz_file_info_s unz_file_info;
         static bool s_bEncryptionKeyIsValid;
     };
 
+    /**
+     * Inflates zlib, gzip or CCZ compressed memory in chunks, into buffers owned by the caller.
+     *
+     * Unlike ZipUtils::inflateMemory(), nothing is allocated for the inflated data, so a decoder
+     * can consume it as it is produced, without the whole file being resident. Encrypted CCZ
+     * buffers are decrypted chunk by chunk, the input is never written to.
+     *
+     * @code
+     * InflateStream stream;
+     * if (stream.init(data, dataLen))
+     * {
+     *     unsigned char chunk[16 * 1024];
+     *     ssize_t length;
+     *     while ((length = stream.read(chunk, sizeof(chunk))) > 0)
+     *         consume(chunk, length);
+     * }
+     * @endcode
+     *
+     * @since v3.17
+     */
+    class CC_DLL InflateStream
+    {
+    public:
+        /** Size of the chunks encrypted CCZ buffers are decrypted in. */
+        static const ssize_t CHUNK_SIZE = 16 * 1024;
+
+        InflateStream();
+        ~InflateStream();
+
+        /**
+         * Starts inflating a buffer. The buffer must outlive the stream.
+         *
+         * @param in A CCZ buffer, or zlib or gzip deflated memory.
+         * @param inLength The length of in.
+         * @return false if the buffer isn't valid, or the stream was already started.
+         */
+        bool init(const unsigned char *in, ssize_t inLength);
+
+        /**
+         * Inflates the next bytes of the stream.
+         *
+         * @param out The buffer to inflate into.
+         * @param outLength The size of out. Less is returned only at the end of the stream.
+         * @return The number of bytes inflated, 0 at the end of the stream, or -1 on error.
+         */
+        ssize_t read(unsigned char *out, ssize_t outLength);
+
+        /** Returns true once the whole stream has been inflated. */
+        bool isFinished() const { return _finished; }
+
+        /**
+         * Returns the size of the inflated data, as recorded by the CCZ header or the gzip trailer,
+         * or -1 if the format doesn't record it.
+         */
+        ssize_t getUncompressedSize() const { return _uncompressedSize; }
+
+    private:
+        bool initCCZ();
+        bool refill();
+
+        struct z_stream_s *_zstream;
+        const unsigned char *_in;
+        size_t _inLength;
+        size_t _inOffset;
+        unsigned char *_decrypted;
+        ssize_t _encryptedLength;
+        ssize_t _uncompressedSize;
+        bool _finished;
+        bool _failed;
+
+        CC_DISALLOW_COPY_AND_ASSIGN(InflateStream);
+    };
+
     // forward declaration
     class ZipFilePrivate;
     struct unz_file_info_s;
@@ -286,6 +361,34 @@ typedef struct unz_file_info_s unz_file_info;
         */
         bool getFileData(const std::string &fileName, ResizableBuffer* buffer);
 
+        /**
+        * Opens a file of the zip file to read it in chunks with readFileData(), without
+        * allocating a buffer for the whole file. Closes the file opened before, if any.
+        * @param fileName File name
+        * @param[out] size If not nullptr, receives the uncompressed size of the file.
+        * @return True if the file was opened.
+        *
+        * @since v3.17
+        */
+        bool openFile(const std::string &fileName, ssize_t *size = nullptr);
+
+        /**
+        * Inflates the next bytes of the file opened by openFile().
+        * @param buffer The buffer to inflate into.
+        * @param length The size of buffer. Less is returned only at the end of the file.
+        * @return The number of bytes read, 0 at the end of the file, or -1 on error.
+        *
+        * @since v3.17
+        */
+        ssize_t readFileData(unsigned char *buffer, ssize_t length);
+
+        /**
+        * Closes the file opened by openFile().
+        *
+        * @since v3.17
+        */
+        void closeFile();
+
         std::string getFirstFilename();
         std::string getNextFilename();
         
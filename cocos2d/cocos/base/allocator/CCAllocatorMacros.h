@@ -109,6 +109,69 @@
 
 #endif
 
+// object pools
+#if CC_ENABLE_OBJECT_POOLS
+
+    #include <new>
+
+    #if CC_ENABLE_REF_TRACKING
+        #include "base/CCRefTracker.h"
+        // @brief tells the RefTracker the size of the instance being allocated
+        #define CC_OBJECT_POOL_TRACK_ALLOCATION(size) NS_CC::RefTracker::willAllocate(size)
+    #else
+        #define CC_OBJECT_POOL_TRACK_ALLOCATION(size)
+    #endif
+
+    // @brief declares the operators new/delete of a class, in a public section of the class.
+    // They use a pool of blocks of the size of the class, defined by CC_DEFINE_OBJECT_POOL.
+    // The instances of the subclasses of another size fall back to the global allocator.
+    #define CC_DECLARE_OBJECT_POOL(T) \
+        static void* operator new (size_t size); \
+        static void* operator new (size_t size, const std::nothrow_t&) noexcept; \
+        static void* operator new (size_t /*size*/, void* address) noexcept { return address; } \
+        static void operator delete (void* object, size_t size); \
+        static void operator delete (void* object, const std::nothrow_t&) noexcept; \
+        static void operator delete (void* /*object*/, void* /*address*/) noexcept {}
+
+    // @brief defines the pool of a class and its operators new/delete, in the implementation file of the class.
+    // @param T the class, declared with CC_DECLARE_OBJECT_POOL.
+    // @param pageSize the number of blocks allocated at once, can be overridden by the "pool.<T>" configuration value.
+    // @param lockTraits locking_semantics if the instances can be created or deleted by several threads, lockless_semantics otherwise.
+    #define CC_DEFINE_OBJECT_POOL(T, pageSize, lockTraits) \
+        static NS_CC_ALLOCATOR::AllocatorStrategyPool<T, NS_CC_ALLOCATOR::RawObjectTraits<T>, NS_CC_ALLOCATOR::lockTraits>& get##T##ObjectPool() \
+        { \
+            /* never destroyed, the instances may be deleted by static destructors */ \
+            static auto pool = new NS_CC_ALLOCATOR::AllocatorStrategyPool<T, NS_CC_ALLOCATOR::RawObjectTraits<T>, NS_CC_ALLOCATOR::lockTraits>("pool." #T, pageSize); \
+            return *pool; \
+        } \
+        void* T::operator new (size_t size) \
+        { \
+            CC_OBJECT_POOL_TRACK_ALLOCATION(size); \
+            return get##T##ObjectPool().allocate(size); \
+        } \
+        void* T::operator new (size_t size, const std::nothrow_t&) noexcept \
+        { \
+            CC_OBJECT_POOL_TRACK_ALLOCATION(size); \
+            return get##T##ObjectPool().allocate(size); \
+        } \
+        void T::operator delete (void* object, size_t size) \
+        { \
+            get##T##ObjectPool().deallocate(object, size); \
+        } \
+        void T::operator delete (void* object, const std::nothrow_t&) noexcept \
+        { \
+            /* only called when a constructor throws, the size is unknown */ \
+            auto& pool = get##T##ObjectPool(); \
+            pool.deallocate(object, pool.owns(object) ? sizeof(T) : 0); \
+        }
+
+#else
+
+    #define CC_DECLARE_OBJECT_POOL(T)
+    #define CC_DEFINE_OBJECT_POOL(T, pageSize, lockTraits)
+
+#endif
+
 // @ brief Quick and dirty macro to dump an area of memory
 // useful for debugging blocks of memory from allocators.
 #define DUMP(a, l, C) \
@@ -79,6 +79,9 @@ public:
     {
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
         _highestCount = 0;
+        _pageCount = 0;
+        _reuseCount = 0;
+        _growCount = 0;
         AllocatorDiagnostics::instance()->trackAllocator(this);
         AllocatorBase::setTag(tag ? tag : typeid(AllocatorStrategyFixedBlock).name());
 #endif
@@ -164,6 +167,10 @@ public:
         return s.str();
     }
     size_t _highestCount;
+    // number of pages, and of allocations served by the free list / that needed a new page
+    size_t _pageCount;
+    size_t _reuseCount;
+    size_t _growCount;
 #endif
     
 protected:
@@ -204,8 +211,17 @@ protected:
     {
         if (nullptr == _list)
         {
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+            ++_growCount;
+#endif
             allocatePage();
         }
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        else
+        {
+            ++_reuseCount;
+        }
+#endif
         auto next = (void*)*(uintptr_t*)_list;
         auto block = _list;
         _list = next;
@@ -245,6 +261,9 @@ protected:
         }
         
         p += AllocatorBase::kDefaultAlignment; // step past the linked list node
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        ++_pageCount;
+#endif
         
         _allocated += _pageSize;
         size_t aligned_size = AllocatorBase::nextPow2BlockSize(block_size);
@@ -28,6 +28,7 @@
 #define CC_ALLOCATOR_STRATEGY_POOL_H
 /// @cond DO_NOT_SHOW
 
+#include <atomic>
 #include <vector>
 #include <typeinfo>
 #include <sstream>
@@ -82,6 +83,24 @@ public:
     }
 };
 
+/**
+ * ObjectTraits of the pools that back the operators new and delete of a class.
+ *
+ * The pool returns raw memory: the new-expression constructs the object and the delete-expression destroys it.
+ * @see CC_DECLARE_OBJECT_POOL
+ */
+template <typename T, size_t _alignment = AllocatorBase::kDefaultAlignment>
+class RawObjectTraits : public ObjectTraits<T, _alignment>
+{
+public:
+    
+    void construct(T* /*address*/)
+    {}
+    
+    void destroy(T* /*address*/)
+    {}
+};
+
 /**
  * Fixed sized pool allocator strategy for objects of type T.
  *
@@ -108,6 +127,9 @@ public:
     
     AllocatorStrategyPool(const char* tag = nullptr, size_t poolSize = 100)
         : tParentStrategy(tag)
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        , _fallbackCount(0)
+#endif
     {
         poolSize = Configuration::getInstance()->getValue(tag, Value((int)poolSize)).asInt();
         tParentStrategy::_pageSize = poolSize;
@@ -128,6 +150,10 @@ public:
         }
         else
         {
+            // a subclass that is bigger than T
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+            ++_fallbackCount;
+#endif
             object = (T*)ccAllocatorGlobal.allocate(size);
         }
         O::construct(object);
@@ -159,10 +185,19 @@ public:
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
     std::string diagnostics() const
     {
+        const size_t capacity = tParentStrategy::_pageCount * tParentStrategy::_pageSize;
+        const size_t fallbacks = _fallbackCount.load();
+        const size_t requests = tParentStrategy::_reuseCount + tParentStrategy::_growCount + fallbacks;
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount << "\n";
+        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount
+          << " capacity:" << capacity << " occupancy:" << (capacity ? tParentStrategy::_allocated * 100 / capacity : 0) << "%"
+          << " hits:" << tParentStrategy::_reuseCount << " grows:" << tParentStrategy::_growCount << " fallbacks:" << fallbacks
+          << " hit rate:" << (requests ? tParentStrategy::_reuseCount * 100 / requests : 0) << "%\n";
         return s.str();
-    }    
+    }
+    
+    // allocations of another size, served by the global allocator
+    std::atomic<size_t> _fallbackCount;
 #endif
 };
 
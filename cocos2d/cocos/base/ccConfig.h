@@ -165,6 +165,16 @@ THE SOFTWARE.
 #define CC_TEXTURE_ATLAS_USE_VAO 1
 #endif
 
+/** @def CC_RENDERER_STREAMING_BUFFER_COUNT
+ * Number of vertex/index buffer pairs the Renderer cycles through, one per frame, when it streams the batched triangles.
+ * While the GPU is still reading the buffers of the previous frames, the CPU fills the next one of the ring.
+ * When the GPU supports sync objects and glMapBufferRange() the buffers are fenced and appended to without synchronization,
+ * otherwise their storage is orphaned on each upload.
+ * Default: 3.
+ */
+#ifndef CC_RENDERER_STREAMING_BUFFER_COUNT
+#define CC_RENDERER_STREAMING_BUFFER_COUNT 3
+#endif
 
 /** @def CC_USE_LA88_LABELS
  * If enabled, it will use LA88 (Luminance Alpha 16-bit textures) for LabelTTF objects.
@@ -247,6 +257,52 @@ THE SOFTWARE.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_TRACER
+ * If enabled, the main stages of the frame (scheduler, physics, visit, render...) and the AsyncTaskPool tasks are
+ * traced with CC_TRACE_SCOPE(), and FrameTracer can record them and export a Chrome trace.
+ * The scopes cost a single flag check while the tracer is not recording.
+ * To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_FRAME_TRACER
+#define CC_ENABLE_FRAME_TRACER 1
+#endif
+
+/** @def CC_FRAME_TRACER_EVENTS_PER_THREAD
+ * Number of events that the FrameTracer keeps per thread. When it is reached, the oldest events are overwritten.
+ */
+#ifndef CC_FRAME_TRACER_EVENTS_PER_THREAD
+#define CC_FRAME_TRACER_EVENTS_PER_THREAD 16384
+#endif
+
+/** @def CC_FRAME_ARENA_SIZE
+ * Initial size in bytes of the FrameArena, the memory of the temporary data of a frame.
+ * If a frame needs more, the arena grows and keeps the new size for the following frames.
+ */
+#ifndef CC_FRAME_ARENA_SIZE
+#define CC_FRAME_ARENA_SIZE 65536
+#endif
+
+/** @def CC_ENABLE_HEAP_COUNTERS
+ * If enabled, the global operators new and delete are replaced to count the heap allocations of each frame,
+ * that are reported by FrameArena::getLastFrameStats() and the "frame" console command.
+ * It can't be used with CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE, or when the engine is built as a DLL.
+ * To enable set it to 1. Disabled by default.
+ */
+#ifndef CC_ENABLE_HEAP_COUNTERS
+#define CC_ENABLE_HEAP_COUNTERS 0
+#endif
+
+/** @def CC_ENABLE_REF_TRACKING
+ * If enabled, RefTracker counts the allocations, the live objects and their bytes, and the autoreleases of each
+ * class derived from Ref, and the number of objects released by the autorelease pools in each frame.
+ * The report is printed by the "refs" console command. It costs a few atomic increments per object, so it can be
+ * enabled in release builds to find the classes that are allocated the most.
+ * To enable set it to 1. Disabled by default.
+ */
+#ifndef CC_ENABLE_REF_TRACKING
+#define CC_ENABLE_REF_TRACKING 0
+#endif
+
 /** Enable Lua engine debug log. */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -356,12 +412,22 @@ THE SOFTWARE.
 # define CC_ENABLE_ALLOCATOR 0
 #endif
 
+/** @def CC_ENABLE_OBJECT_POOLS
+ * Turn on the pools of the classes that use CC_DECLARE_OBJECT_POOL, like Sprite, the common actions,
+ * PhysicsContact and EventCustom: their instances are allocated from fixed size blocks instead of the heap.
+ * It doesn't need CC_ENABLE_ALLOCATOR.
+ */
+#ifndef CC_ENABLE_OBJECT_POOLS
+# define CC_ENABLE_OBJECT_POOLS 1
+#endif
+
 /** @def CC_ENABLE_ALLOCATOR_DIAGNOSTICS
  * Turn on debugging of allocators. This is slower, uses
  * more memory, and should not be used for production builds.
+ * It is enabled by default in debug builds that use the object pools, to report their occupancy and hit rate.
  */
 #ifndef CC_ENABLE_ALLOCATOR_DIAGNOSTICS
-# define CC_ENABLE_ALLOCATOR_DIAGNOSTICS CC_ENABLE_ALLOCATOR
+# define CC_ENABLE_ALLOCATOR_DIAGNOSTICS (CC_ENABLE_ALLOCATOR || (CC_ENABLE_OBJECT_POOLS && COCOS2D_DEBUG > 0))
 #endif
 
 /** @def CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
@@ -40,6 +40,7 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -50,10 +51,14 @@ THE SOFTWARE.
 #include "base/CCMap.h"
 #include "base/CCNS.h"
 #include "base/CCProfiling.h"
+#include "base/CCFrameTracer.h"
+#include "base/CCFrameArena.h"
+#include "base/CCRefTracker.h"
 #include "base/CCProperties.h"
 #include "base/CCRef.h"
 #include "base/CCRefPtr.h"
 #include "base/CCScheduler.h"
+#include "base/CCFunctionQueue.h"
 #include "base/CCUserDefault.h"
 #include "base/CCValue.h"
 #include "base/CCVector.h"
@@ -110,6 +115,7 @@ THE SOFTWARE.
 #include "2d/CCActionTiledGrid.h"
 #include "2d/CCActionTween.h"
 #include "2d/CCTweenFunction.h"
+#include "2d/CCTweenSystem.h"
 
 // 2d nodes
 #include "2d/CCAtlasNode.h"
@@ -170,12 +176,14 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCTextureCube.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCVertexAttribBinding.h"
 #include "renderer/CCVertexIndexBuffer.h"
 #include "renderer/CCVertexIndexData.h"
 #include "renderer/CCFrameBuffer.h"
 #include "renderer/ccGLStateCache.h"
+#include "renderer/ccPixelConversion.h"
 #include "renderer/ccShaders.h"
 
 // physics
@@ -189,7 +197,10 @@ THE SOFTWARE.
 #include "platform/CCCommon.h"
 #include "platform/CCDevice.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCFileArchive.h"
+#include "platform/CCPlistParser.h"
 #include "platform/CCImage.h"
+#include "platform/CCDecodedImageCache.h"
 #include "platform/CCPlatformConfig.h"
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCSAXParser.h"
@@ -540,6 +540,26 @@ public:
      */
     static void multiply(const Mat4& m1, const Mat4& m2, Mat4* dst);
 
+    /**
+     * Determines if this matrix only holds a 2D affine transform, that is rotation, scale,
+     * skew and translation in the XY plane with the Z axis left untouched.
+     *
+     * @return true if the matrix is a 2D affine transform, false otherwise.
+     */
+    inline bool isAffine2D() const;
+
+    /**
+     * Multiplies m1 by m2 and stores the result in dst, using only the six meaningful
+     * components of a 2D affine transform.
+     *
+     * Both m1 and m2 must be 2D affine transforms, see isAffine2D().
+     *
+     * @param m1 The first matrix to multiply.
+     * @param m2 The second matrix to multiply.
+     * @param dst A matrix to store the result in. It may be m1 or m2.
+     */
+    static inline void multiplyAffine2D(const Mat4& m1, const Mat4& m2, Mat4* dst);
+
     /**
      * Negates this matrix.
      */
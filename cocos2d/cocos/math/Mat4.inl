@@ -55,6 +55,32 @@ inline Mat4 Mat4::operator-() const
     return mat;
 }
 
+inline bool Mat4::isAffine2D() const
+{
+    return m[2] == 0.0f && m[3] == 0.0f && m[6] == 0.0f && m[7] == 0.0f
+        && m[8] == 0.0f && m[9] == 0.0f && m[10] == 1.0f && m[11] == 0.0f
+        && m[14] == 0.0f && m[15] == 1.0f;
+}
+
+inline void Mat4::multiplyAffine2D(const Mat4& m1, const Mat4& m2, Mat4* dst)
+{
+    GP_ASSERT(dst);
+    GP_ASSERT(m1.isAffine2D() && m2.isAffine2D());
+
+    const float a = m1.m[0] * m2.m[0] + m1.m[4] * m2.m[1];
+    const float b = m1.m[1] * m2.m[0] + m1.m[5] * m2.m[1];
+    const float c = m1.m[0] * m2.m[4] + m1.m[4] * m2.m[5];
+    const float d = m1.m[1] * m2.m[4] + m1.m[5] * m2.m[5];
+    const float tx = m1.m[0] * m2.m[12] + m1.m[4] * m2.m[13] + m1.m[12];
+    const float ty = m1.m[1] * m2.m[12] + m1.m[5] * m2.m[13] + m1.m[13];
+
+    float* out = dst->m;
+    out[0] = a;     out[1] = b;     out[2] = 0.0f;  out[3] = 0.0f;
+    out[4] = c;     out[5] = d;     out[6] = 0.0f;  out[7] = 0.0f;
+    out[8] = 0.0f;  out[9] = 0.0f;  out[10] = 1.0f; out[11] = 0.0f;
+    out[12] = tx;   out[13] = ty;   out[14] = 0.0f; out[15] = 1.0f;
+}
+
 inline Mat4 Mat4::operator*(const Mat4& mat) const
 {
     Mat4 result(*this);
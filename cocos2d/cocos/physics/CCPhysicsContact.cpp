@@ -29,9 +29,12 @@
 #include "physics/CCPhysicsBody.h"
 #include "physics/CCPhysicsHelper.h"
 #include "base/CCEventCustom.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_OBJECT_POOL(PhysicsContact, 64, lockless_semantics)
+
 const char* PHYSICSCONTACT_EVENT_NAME = "PhysicsContactEvent";
 
 PhysicsContact::PhysicsContact()
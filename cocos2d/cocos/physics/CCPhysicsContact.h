@@ -68,6 +68,8 @@ typedef struct CC_DLL PhysicsContactData
 class CC_DLL PhysicsContact : public EventCustom
 {
 public:
+    CC_DECLARE_OBJECT_POOL(PhysicsContact)
+
     
     enum class EventCode
     {
@@ -27,6 +27,7 @@
 #if CC_USE_PHYSICS
 #include <algorithm>
 #include <climits>
+#include <cstring>
 
 #include "chipmunk/chipmunk_private.h"
 #include "physics/CCPhysicsBody.h"
@@ -40,6 +41,7 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCFrameTracer.h"
 
 NS_CC_BEGIN
 const float PHYSICS_INFINITY = FLT_MAX;
@@ -304,7 +306,7 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     PhysicsShape* shapeB = contact.getShapeB();
     PhysicsBody* bodyA = shapeA->getBody();
     PhysicsBody* bodyB = shapeB->getBody();
-    std::vector<PhysicsJoint*> jointsA = bodyA->getJoints();
+    const std::vector<PhysicsJoint*>& jointsA = bodyA->getJoints();
     
     // check the joint is collision enable or not
     for (PhysicsJoint* joint : jointsA)
@@ -871,6 +873,8 @@ void PhysicsWorld::step(float delta)
 
 void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 {
+    CC_TRACE_SCOPE("PhysicsWorld::update");
+
     if(!_delayAddBodies.empty())
     {
         updateBodies();
@@ -881,7 +885,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
     }
     
     auto sceneToWorldTransform = _scene->getNodeToParentTransform();
-    beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    beforeSimulation(_scene, sceneToWorldTransform);
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -890,6 +894,8 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
     
     if (delta < FLT_EPSILON)
     {
+        _simulationBodies.clear();
+        _simulationNodeRefs.clear();
         return;
     }
     
@@ -948,7 +954,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 
     // Update physics position, should loop as the same sequence as node tree.
     // PhysicsWorld::afterSimulation() will depend on the sequence.
-    afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    afterSimulation();
 }
 
 PhysicsWorld* PhysicsWorld::construct(Scene* scene)
@@ -986,6 +992,8 @@ PhysicsWorld::PhysicsWorld()
 
 PhysicsWorld::~PhysicsWorld()
 {
+    _simulationBodies.clear();
+    _simulationNodeRefs.clear();
     removeAllJoints(true);
     removeAllBodies();
     if (_cpSpace)
@@ -999,37 +1007,179 @@ PhysicsWorld::~PhysicsWorld()
     CC_SAFE_RELEASE_NULL(_debugDraw);
 }
 
-void PhysicsWorld::beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation)
+void PhysicsWorld::beforeSimulation(Node* scene, const Mat4& sceneToWorldTransform)
 {
-    auto scaleX = nodeParentScaleX * node->getScaleX();
-    auto scaleY = nodeParentScaleY * node->getScaleY();
-    auto rotation = parentRotation + node->getRotation();
+    _simulationBodies.clear();
+    _simulationBodySlots.clear();
+    _simulationNodeRefs.clear();
+
+    if (_simulationNodes.empty())
+    {
+        _simulationNodes.emplace_back();
+    }
+    auto& root = _simulationNodes[0];
+    root.node = nullptr;
+    root.parent = 0;
+    root.nodeToWorldTransform = sceneToWorldTransform;
+    root.scaleX = root.scaleY = 1.f;
+    root.rotation = 0.f;
+    // A change of the scene transform marks the scene slot
+    root.updated = false;
+
+    // Walk the scene in the same pre-order as the node tree. The slot of a node keeps its transform from
+    // the previous step if it holds the same node under the same parent, and nothing changed it since.
+    size_t count = 1;
+    _simulationStack.clear();
+    _simulationStack.emplace_back(scene, 0);
+    while (!_simulationStack.empty())
+    {
+        auto node = _simulationStack.back().first;
+        auto parent = _simulationStack.back().second;
+        _simulationStack.pop_back();
+
+        auto physicsBody = node->getPhysicsBody();
+        auto& children = node->getChildren();
+
+        // Leaf nodes without a body don't contribute a transform to anything
+        if (physicsBody == nullptr && children.empty())
+            continue;
 
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
+        auto slot = static_cast<int>(count++);
+        bool reusable = slot < static_cast<int>(_simulationNodes.size());
+        if (!reusable)
+        {
+            _simulationNodes.emplace_back();
+        }
+
+        auto& entry = _simulationNodes[slot];
+        reusable = reusable
+            && entry.node == node
+            && entry.parent == parent
+            && !entry.dirty
+            && !_simulationNodes[parent].updated
+            && !isSimulationNodeChanged(slot);
+
+        entry.node = node;
+        entry.parent = parent;
+        entry.dirty = false;
+        entry.updated = !reusable;
+        if (!reusable)
+        {
+            updateSimulationNode(slot);
+        }
+        _simulationNodeRefs.pushBack(node);
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+        if (physicsBody)
+        {
+            const auto& parentEntry = _simulationNodes[parent];
+            physicsBody->beforeSimulation(parentEntry.nodeToWorldTransform, entry.nodeToWorldTransform, entry.scaleX, entry.scaleY, entry.rotation);
+            _simulationBodies.pushBack(physicsBody);
+            _simulationBodySlots.push_back(slot);
+        }
+
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+            _simulationStack.emplace_back(*it, slot);
+    }
+
+    _simulationNodes.resize(count);
+}
+
+void PhysicsWorld::updateSimulationNode(int slot)
+{
+    auto& entry = _simulationNodes[slot];
+    const auto& parentEntry = _simulationNodes[entry.parent];
+    auto node = entry.node;
+
+    entry.nodeScaleX = node->getScaleX();
+    entry.nodeScaleY = node->getScaleY();
+    entry.nodeRotation = node->getRotation();
+    entry.nodeToParentTransform = node->getNodeToParentTransform();
+
+    entry.scaleX = parentEntry.scaleX * entry.nodeScaleX;
+    entry.scaleY = parentEntry.scaleY * entry.nodeScaleY;
+    entry.rotation = parentEntry.rotation + entry.nodeRotation;
+
+    const Mat4& parentToWorldTransform = parentEntry.nodeToWorldTransform;
+    const Mat4& nodeToParentTransform = entry.nodeToParentTransform;
+    if (parentToWorldTransform.isAffine2D() && nodeToParentTransform.isAffine2D())
+        Mat4::multiplyAffine2D(parentToWorldTransform, nodeToParentTransform, &entry.nodeToWorldTransform);
+    else
+        Mat4::multiply(parentToWorldTransform, nodeToParentTransform, &entry.nodeToWorldTransform);
+}
+
+bool PhysicsWorld::isSimulationNodeChanged(int slot) const
+{
+    const auto& entry = _simulationNodes[slot];
+    auto node = entry.node;
+    return entry.nodeScaleX != node->getScaleX()
+        || entry.nodeScaleY != node->getScaleY()
+        || entry.nodeRotation != node->getRotation()
+        || memcmp(entry.nodeToParentTransform.m, node->getNodeToParentTransform().m, sizeof(entry.nodeToParentTransform.m)) != 0;
+}
+
+void PhysicsWorld::checkSimulationNode(int slot)
+{
+    auto& entry = _simulationNodes[slot];
+    if (entry.checked)
+        return;
+    entry.checked = true;
+
+    auto node = entry.node;
+    if (node->getParent() != _simulationNodes[entry.parent].node)
     {
-        physicsBody->beforeSimulation(parentToWorldTransform, nodeToWorldTransform, scaleX, scaleY, rotation);
+        // Moved to another parent from a contact callback, compute its transform from the scene
+        const auto& root = _simulationNodes[0];
+        Mat4::multiply(root.nodeToWorldTransform, node->getNodeToParentTransform(nullptr), &entry.nodeToWorldTransform);
+        entry.scaleX = entry.scaleY = 1.f;
+        entry.rotation = 0.f;
+        for (auto p = node; p != nullptr; p = p->getParent())
+        {
+            entry.scaleX *= p->getScaleX();
+            entry.scaleY *= p->getScaleY();
+            entry.rotation += p->getRotation();
+        }
+        entry.updated = true;
+        entry.dirty = true;
+        return;
     }
 
-    for (auto child : node->getChildren())
-        beforeSimulation(child, nodeToWorldTransform, scaleX, scaleY, rotation);
+    checkSimulationNode(entry.parent);
+    if (_simulationNodes[entry.parent].updated || isSimulationNodeChanged(slot))
+    {
+        updateSimulationNode(slot);
+        entry.updated = true;
+    }
 }
 
-void PhysicsWorld::afterSimulation(Node *node, const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsWorld::afterSimulation()
 {
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
-    auto nodeRotation = parentRotation + node->getRotation();
+    for (auto& entry : _simulationNodes)
+    {
+        entry.updated = false;
+        entry.checked = false;
+    }
+    _simulationNodes[0].checked = true;
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+    // The bodies are in tree order, so the body of a node moves it before its children are placed.
+    // The parent transforms are checked again, they change when a parent moves or is moved from a contact callback.
+    for (ssize_t i = 0, count = _simulationBodies.size(); i < count; ++i)
     {
-        physicsBody->afterSimulation(parentToWorldTransform, parentRotation);
+        auto physicsBody = _simulationBodies.at(i);
+        auto slot = _simulationBodySlots[i];
+
+        // The owner may have left the scene from a contact callback during the step
+        if (physicsBody->getWorld() != this || physicsBody->getNode() != _simulationNodes[slot].node)
+            continue;
+
+        auto parent = _simulationNodes[slot].parent;
+        checkSimulationNode(parent);
+        physicsBody->afterSimulation(_simulationNodes[parent].nodeToWorldTransform, _simulationNodes[parent].rotation);
     }
 
-    for (auto child : node->getChildren())
-        afterSimulation(child, nodeToWorldTransform, nodeRotation);
+    // What was changed after its transform was computed, e.g. by its body, differs from the local
+    // transform of its slot and is computed again at the next step
+    _simulationBodies.clear();
+    _simulationNodeRefs.clear();
 }
 
 NS_CC_END
@@ -393,13 +393,44 @@ protected:
     Vector<PhysicsBody*> _delayRemoveBodies;
     std::vector<PhysicsJoint*> _delayAddJoints;
     std::vector<PhysicsJoint*> _delayRemoveJoints;
+
+    // A node of the hierarchy flattened by beforeSimulation(), in the pre-order of the node tree.
+    // Slot 0 is the space the scene is placed in. The slots are kept from one step to the next, and a
+    // node to world transform is only computed again if the node or its parent changed. The node is
+    // compared with the local transform the slot was computed from, since Node::visit() clears the
+    // dirty flags of the node between two steps.
+    struct SimulationNode
+    {
+        Node* node;
+        int parent;
+        Mat4 nodeToWorldTransform;
+        float scaleX;
+        float scaleY;
+        float rotation;
+        Mat4 nodeToParentTransform;
+        float nodeScaleX;
+        float nodeScaleY;
+        float nodeRotation;
+        bool updated;   // computed again by the current pass, so are the transforms of the children
+        bool checked;   // checked against the node by afterSimulation()
+        bool dirty;     // the transform of the slot wasn't computed from its parent
+    };
+    std::vector<SimulationNode> _simulationNodes;
+    // The nodes of the slots are retained during the step, contact callbacks may remove them
+    Vector<Node*> _simulationNodeRefs;
+    std::vector<std::pair<Node*, int>> _simulationStack;
+    Vector<PhysicsBody*> _simulationBodies;
+    std::vector<int> _simulationBodySlots;
     
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
     
-    void beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation);
-    void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
+    void beforeSimulation(Node* scene, const Mat4& sceneToWorldTransform);
+    void afterSimulation();
+    void updateSimulationNode(int slot);
+    bool isSimulationNodeChanged(int slot) const;
+    void checkSimulationNode(int slot);
 
     friend class Node;
     friend class Sprite;
@@ -0,0 +1,463 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "platform/CCDecodedImageCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <xxhash.h>
+
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    struct EntryFooter
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint64_t encodedSize;
+        uint64_t pixelSize;
+        uint32_t width;
+        uint32_t height;
+        uint32_t renderFormat;
+        uint32_t fileType;
+        uint32_t premultipliedAlpha;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(EntryFooter) == 56, "decoded image footer layout");
+
+    const char ENTRY_MAGIC[4] = { 'C', 'C', 'D', 'I' };
+    const char ENTRY_EXTENSION[] = ".img";
+    const char TEMP_EXTENSION[] = ".tmp";
+
+    std::atomic<bool> s_enabled(false);
+    std::atomic<size_t> s_size(0);
+    std::atomic<size_t> s_maxSize(DecodedImageCache::DEFAULT_MAX_SIZE);
+
+    // Guards s_path, which decode workers read while the main thread may enable the cache
+    std::mutex s_pathMutex;
+    std::string s_path;
+
+    // The entries on disk, least recently used first. s_size is only changed with s_indexMutex held,
+    // it includes the entries being written, which are in s_writing until they are renamed.
+    typedef std::list<std::pair<uint64_t, size_t>> EntryList;
+    std::mutex s_indexMutex;
+    EntryList s_entryList;
+    std::unordered_map<uint64_t, EntryList::iterator> s_entries;
+    std::unordered_map<uint64_t, size_t> s_writing;
+
+    bool hasSuffix(const std::string& str, const char* suffix)
+    {
+        size_t length = strlen(suffix);
+        return str.size() >= length && str.compare(str.size() - length, length, suffix) == 0;
+    }
+
+    bool getFileInfo(const std::string& fullPath, size_t* size, time_t* mtime)
+    {
+        struct stat info;
+        if (stat(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), &info) != 0 || info.st_size <= 0)
+            return false;
+
+        *size = static_cast<size_t>(info.st_size);
+        *mtime = info.st_mtime;
+        return true;
+    }
+
+    std::string entryName(uint64_t key)
+    {
+        char name[17];
+        snprintf(name, sizeof(name), "%08x%08x", static_cast<unsigned int>(key >> 32), static_cast<unsigned int>(key));
+        return name;
+    }
+
+    bool parseEntryName(const std::string& fullPath, uint64_t* key)
+    {
+        size_t length = sizeof(ENTRY_EXTENSION) - 1;
+        size_t slash = fullPath.find_last_of('/');
+        size_t start = slash == std::string::npos ? 0 : slash + 1;
+        if (fullPath.size() - start != 16 + length)
+            return false;
+
+        uint64_t value = 0;
+        for (size_t i = start; i < start + 16; ++i)
+        {
+            char c = fullPath[i];
+            int digit = c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1);
+            if (digit < 0)
+                return false;
+            value = (value << 4) | static_cast<uint64_t>(digit);
+        }
+        *key = value;
+        return value != 0;
+    }
+
+    std::string cachePath()
+    {
+        std::lock_guard<std::mutex> lock(s_pathMutex);
+        return s_path;
+    }
+
+    // Call it with s_indexMutex held
+    size_t reservedSizeLocked()
+    {
+        size_t size = 0;
+        for (const auto& writing : s_writing)
+        {
+            size += writing.second;
+        }
+        return size;
+    }
+
+    // Drops least recently used entries until extraSize more bytes fit in the budget.
+    // Call it with s_indexMutex held, the keys to delete are appended to evicted.
+    bool evictLocked(size_t extraSize, std::vector<uint64_t>& evicted)
+    {
+        size_t maxSize = s_maxSize;
+        if (extraSize > maxSize)
+            return false;
+
+        while (s_size + extraSize > maxSize && !s_entryList.empty())
+        {
+            const auto& oldest = s_entryList.front();
+            evicted.push_back(oldest.first);
+            s_size -= oldest.second;
+            s_entries.erase(oldest.first);
+            s_entryList.pop_front();
+        }
+        // The rest of the budget may be reserved by entries being written
+        return s_size + extraSize <= maxSize;
+    }
+
+    void removeEntryFiles(const std::string& path, const std::vector<uint64_t>& keys)
+    {
+        auto fileUtils = FileUtils::getInstance();
+        for (auto key : keys)
+        {
+            fileUtils->removeFile(path + entryName(key) + ENTRY_EXTENSION);
+        }
+    }
+
+    bool isCachedFormat(Image::Format format)
+    {
+        switch (format)
+        {
+        case Image::Format::PNG:
+        case Image::Format::JPG:
+        case Image::Format::TIFF:
+        case Image::Format::WEBP:
+        case Image::Format::TGA:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+void DecodedImageCache::setEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        s_enabled = false;
+        return;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = fileUtils->getWritablePath() + "decoded-images/";
+    if (!fileUtils->isDirectoryExist(path) && !fileUtils->createDirectory(path))
+    {
+        CCLOG("cocos2d: DecodedImageCache: can't create %s", path.c_str());
+        return;
+    }
+
+    // Files of an interrupted write are left behind when the app is killed
+    struct DiskEntry
+    {
+        time_t mtime;
+        uint64_t key;
+        size_t size;
+    };
+    std::vector<DiskEntry> diskEntries;
+    for (const auto& file : fileUtils->listFiles(path))
+    {
+        DiskEntry entry;
+        if (hasSuffix(file, TEMP_EXTENSION))
+        {
+            fileUtils->removeFile(file);
+        }
+        else if (hasSuffix(file, ENTRY_EXTENSION)
+            && parseEntryName(file, &entry.key)
+            && getFileInfo(file, &entry.size, &entry.mtime))
+        {
+            diskEntries.push_back(entry);
+        }
+    }
+
+    // Nothing tells which entries were used last, so the oldest written ones go first
+    std::stable_sort(diskEntries.begin(), diskEntries.end(), [](const DiskEntry& a, const DiskEntry& b) {
+        return a.mtime < b.mtime;
+    });
+
+    std::vector<uint64_t> evicted;
+    {
+        std::lock_guard<std::mutex> lock(s_indexMutex);
+        s_entryList.clear();
+        s_entries.clear();
+        s_size = reservedSizeLocked();
+        for (const auto& entry : diskEntries)
+        {
+            s_entryList.emplace_back(entry.key, entry.size);
+            s_entries[entry.key] = std::prev(s_entryList.end());
+            s_size += entry.size;
+        }
+        evictLocked(0, evicted);
+        removeEntryFiles(path, evicted);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_pathMutex);
+        s_path = path;
+    }
+    s_enabled = true;
+}
+
+bool DecodedImageCache::isEnabled()
+{
+    return s_enabled;
+}
+
+void DecodedImageCache::setMaxSize(size_t maxSize)
+{
+    s_maxSize = maxSize;
+}
+
+size_t DecodedImageCache::getMaxSize()
+{
+    return s_maxSize;
+}
+
+size_t DecodedImageCache::getSize()
+{
+    return s_size;
+}
+
+std::string DecodedImageCache::getCachePath()
+{
+    return cachePath();
+}
+
+void DecodedImageCache::removeAllFiles()
+{
+    std::string path = cachePath();
+    if (path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(s_indexMutex);
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->removeDirectory(path);
+    fileUtils->createDirectory(path);
+    s_entryList.clear();
+    s_entries.clear();
+    // The entries being written keep their reservation
+    s_size = reservedSizeLocked();
+}
+
+uint64_t DecodedImageCache::computeKey(const unsigned char* data, ssize_t dataLen)
+{
+    if (!data || dataLen <= 0 || dataLen > INT_MAX)
+        return 0;
+
+    // The decoders premultiply PNG files or not depending on this setting, so it is part of the key
+    unsigned int seed = VERSION * 2 + (Image::PNG_PREMULTIPLIED_ALPHA_ENABLED ? 1 : 0);
+    int length = static_cast<int>(dataLen);
+    uint64_t high = XXH32(data, length, seed);
+    uint64_t low = XXH32(data, length, seed ^ 0x9e3779b9u);
+    return (high << 32) | low;
+}
+
+bool DecodedImageCache::load(uint64_t key, ssize_t dataLen, Image* image)
+{
+    if (!s_enabled || key == 0)
+        return false;
+
+    std::string path = cachePath();
+    if (path.empty())
+        return false;
+    path += entryName(key) + ENTRY_EXTENSION;
+
+    FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "rb");
+    if (!fp)
+        return false;
+
+    // Check the footer before allocating anything
+    EntryFooter footer;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0)
+        size = ftell(fp);
+    if (size < static_cast<long>(sizeof(footer))
+        || fseek(fp, size - static_cast<long>(sizeof(footer)), SEEK_SET) != 0
+        || fread(&footer, sizeof(footer), 1, fp) != 1
+        || memcmp(footer.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0
+        || footer.version != VERSION
+        || footer.key != key
+        || footer.encodedSize != static_cast<uint64_t>(dataLen)
+        || footer.pixelSize != static_cast<uint64_t>(size) - sizeof(footer)
+        || footer.pixelSize == 0
+        || footer.width == 0
+        || footer.height == 0)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    auto pixels = static_cast<unsigned char*>(malloc(static_cast<size_t>(footer.pixelSize)));
+    if (!pixels
+        || fseek(fp, 0, SEEK_SET) != 0
+        || fread(pixels, 1, static_cast<size_t>(footer.pixelSize), fp) != footer.pixelSize)
+    {
+        free(pixels);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+
+    {
+        // Mark the entry as the most recently used one
+        std::lock_guard<std::mutex> lock(s_indexMutex);
+        auto iter = s_entries.find(key);
+        if (iter != s_entries.end())
+            s_entryList.splice(s_entryList.end(), s_entryList, iter->second);
+    }
+
+    image->_data = pixels;
+    image->_dataLen = static_cast<ssize_t>(footer.pixelSize);
+    image->_width = static_cast<int>(footer.width);
+    image->_height = static_cast<int>(footer.height);
+    image->_renderFormat = static_cast<Texture2D::PixelFormat>(footer.renderFormat);
+    image->_fileType = static_cast<Image::Format>(footer.fileType);
+    image->_hasPremultipliedAlpha = footer.premultipliedAlpha != 0;
+    return true;
+}
+
+bool DecodedImageCache::save(uint64_t key, ssize_t dataLen, Image* image)
+{
+    if (!s_enabled || key == 0)
+        return false;
+
+    if (!isCachedFormat(image->_fileType)
+        || image->_numberOfMipmaps > 1
+        || !image->_data
+        || image->_dataLen < static_cast<ssize_t>(MIN_IMAGE_SIZE))
+        return false;
+
+    std::string path = cachePath();
+    if (path.empty())
+        return false;
+
+    // Reserve the space up front so concurrent workers can't overshoot the budget together,
+    // and let a single worker write a key that several ones decoded at once
+    size_t entrySize = static_cast<size_t>(image->_dataLen) + sizeof(EntryFooter);
+    std::vector<uint64_t> evicted;
+    bool reserved = false;
+    {
+        std::lock_guard<std::mutex> lock(s_indexMutex);
+        if (s_entries.find(key) == s_entries.end()
+            && s_writing.find(key) == s_writing.end()
+            && evictLocked(entrySize, evicted))
+        {
+            s_size += entrySize;
+            s_writing.emplace(key, entrySize);
+            reserved = true;
+        }
+        // Under the lock, or another worker could write a key again before its old file is removed
+        removeEntryFiles(path, evicted);
+    }
+    if (!reserved)
+        return false;
+
+    EntryFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    memcpy(footer.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    footer.version = VERSION;
+    footer.key = key;
+    footer.encodedSize = static_cast<uint64_t>(dataLen);
+    footer.pixelSize = static_cast<uint64_t>(image->_dataLen);
+    footer.width = static_cast<uint32_t>(image->_width);
+    footer.height = static_cast<uint32_t>(image->_height);
+    footer.renderFormat = static_cast<uint32_t>(image->_renderFormat);
+    footer.fileType = static_cast<uint32_t>(image->_fileType);
+    footer.premultipliedAlpha = image->_hasPremultipliedAlpha ? 1 : 0;
+
+    // Write to a file of this thread and rename it, so a reader never sees a partial entry
+    auto fileUtils = FileUtils::getInstance();
+    std::string name = entryName(key);
+    std::string tempPath = path + name + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + TEMP_EXTENSION;
+    std::string entryPath = path + name + ENTRY_EXTENSION;
+
+    FILE* fp = fopen(fileUtils->getSuitableFOpen(tempPath).c_str(), "wb");
+    bool written = false;
+    if (fp)
+    {
+        written = fwrite(image->_data, 1, static_cast<size_t>(image->_dataLen), fp) == static_cast<size_t>(image->_dataLen)
+            && fwrite(&footer, sizeof(footer), 1, fp) == 1;
+        written = (fclose(fp) == 0) && written;
+    }
+
+    bool renamed = written && fileUtils->renameFile(tempPath, entryPath);
+    if (!renamed && fp)
+        fileUtils->removeFile(tempPath);
+
+    // The reserved size is now either the size of the entry or released
+    std::lock_guard<std::mutex> lock(s_indexMutex);
+    s_writing.erase(key);
+    if (renamed)
+    {
+        s_entryList.emplace_back(key, entrySize);
+        s_entries[key] = std::prev(s_entryList.end());
+    }
+    else
+    {
+        s_size -= entrySize;
+    }
+    return renamed;
+}
+
+NS_CC_END
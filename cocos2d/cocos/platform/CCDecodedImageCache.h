@@ -0,0 +1,133 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_DECODEDIMAGECACHE_H__
+#define __CC_DECODEDIMAGECACHE_H__
+
+#include <string>
+#include <cstdint>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Image;
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * An on-disk cache of decoded images, kept in the "decoded-images" directory of the writable path.
+ *
+ * When it is enabled, Image::initWithImageData() looks the encoded bytes up by their hash before
+ * decoding them, and stores what it decodes. Entries are keyed by the contents of the file rather
+ * than its name, so an asset that changes simply misses the cache. Only the formats that are
+ * actually decoded (PNG, JPEG, TIFF, WebP and TGA) are cached; compressed textures are already
+ * uploaded as they are.
+ *
+ * Each entry holds the pixels, premultiplied if the decoder premultiplied them, followed by a
+ * small footer, so the pixels start at offset 0 and can be used in place. The footer is written in
+ * the byte order of the device, as the cache is never shared between devices.
+ *
+ * The cache is bounded by a disk budget. When a new entry would exceed it, the least recently used
+ * entries are deleted first; across launches, entries are ordered by the time they were written.
+ *
+ * @since v3.17
+ */
+class CC_DLL DecodedImageCache
+{
+public:
+    /** Version of the entry format, entries of other versions are ignored. */
+    static const uint32_t VERSION = 1;
+
+    /** Images with fewer bytes of pixels than this are cheaper to decode than to read back. */
+    static const size_t MIN_IMAGE_SIZE = 16 * 1024;
+
+    /** Default disk budget of the cache, in bytes. */
+    static const size_t DEFAULT_MAX_SIZE = 256 * 1024 * 1024;
+
+    /**
+     * Enables or disables the cache. Call it from the main thread, before loading images.
+     * Enabling creates the cache directory, indexes the entries on disk and evicts the oldest ones
+     * if they exceed the disk budget.
+     *
+     * @param enabled (default: false)
+     */
+    static void setEnabled(bool enabled);
+
+    /** Returns true if the cache is enabled. */
+    static bool isEnabled();
+
+    /**
+     * Sets the disk budget of the cache, in bytes. It is enforced when the cache is enabled and when an image is saved.
+     *
+     * @param maxSize (default: DEFAULT_MAX_SIZE)
+     */
+    static void setMaxSize(size_t maxSize);
+
+    /** Returns the disk budget of the cache, in bytes. */
+    static size_t getMaxSize();
+
+    /** Returns the number of bytes the cache uses on disk. */
+    static size_t getSize();
+
+    /** Returns the directory of the cache, ending with '/', or an empty string if it has never been enabled. */
+    static std::string getCachePath();
+
+    /** Deletes all the cached images. */
+    static void removeAllFiles();
+
+    /** Returns the key of an encoded image. */
+    static uint64_t computeKey(const unsigned char* data, ssize_t dataLen);
+
+    /**
+     * Initializes an image from the cache. Thread safe.
+     *
+     * @param key The key of the encoded image, from computeKey().
+     * @param dataLen The size of the encoded image.
+     * @param image The image to initialize.
+     * @return true if the image was found in the cache.
+     */
+    static bool load(uint64_t key, ssize_t dataLen, Image* image);
+
+    /**
+     * Stores a decoded image in the cache, if it is worth caching. Thread safe.
+     *
+     * @param key The key of the encoded image, from computeKey().
+     * @param dataLen The size of the encoded image.
+     * @param image The decoded image.
+     * @return true if the image was written to the cache.
+     */
+    static bool save(uint64_t key, ssize_t dataLen, Image* image);
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __CC_DECODEDIMAGECACHE_H__
@@ -0,0 +1,347 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCFileArchive.h"
+
+#include <cstring>
+#include <xxhash.h>
+
+#include "platform/CCFileUtils.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+#include <windows.h>
+#include "platform/win32/CCUtils-win32.h"
+#elif CC_TARGET_PLATFORM != CC_PLATFORM_WINRT
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    struct ArchiveHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t slotCount;
+        uint32_t namesSize;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(ArchiveHeader) == 24, "archive header layout");
+    static_assert(sizeof(FileArchive::Entry) == 32, "archive entry layout");
+}
+
+struct FileArchive::Storage
+{
+    Storage()
+    : bytes(nullptr)
+    , size(0)
+    , mapping(nullptr)
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    , mappingHandle(nullptr)
+#endif
+    {
+    }
+
+    // Unmapped when the archive and the last view are released, from whichever thread releases it last
+    ~Storage()
+    {
+        if (mapping)
+        {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+            ::UnmapViewOfFile(mapping);
+            ::CloseHandle(mappingHandle);
+#elif CC_TARGET_PLATFORM != CC_PLATFORM_WINRT
+            munmap(mapping, size);
+#endif
+        }
+    }
+
+    bool map(const std::string& fullPath);
+    bool read(const std::string& fullPath);
+
+    // Either the mapped file or data
+    const unsigned char* bytes;
+    size_t size;
+    void* mapping;
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    void* mappingHandle;
+#endif
+    Data data;
+};
+
+bool FileArchive::Storage::map(const std::string& fullPath)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    HANDLE file = ::CreateFileW(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mappingObject = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (!mappingObject)
+        return false;
+
+    void* view = ::MapViewOfFile(mappingObject, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        ::CloseHandle(mappingObject);
+        return false;
+    }
+
+    mappingHandle = mappingObject;
+    mapping = view;
+    bytes = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_WINRT
+    CC_UNUSED_PARAM(fullPath);
+    return false;
+#else
+    int fd = open(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == -1 || statBuf.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(statBuf.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+
+    mapping = view;
+    bytes = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(statBuf.st_size);
+    return true;
+#endif
+}
+
+bool FileArchive::Storage::read(const std::string& fullPath)
+{
+    if (FileUtils::getInstance()->getContents(fullPath, &data) != FileUtils::Status::OK)
+        return false;
+
+    bytes = data.getBytes();
+    size = static_cast<size_t>(data.getSize());
+    return true;
+}
+
+void ArchivedFileView::clear()
+{
+    _storage.reset();
+    _bytes = nullptr;
+    _size = 0;
+}
+
+FileArchive* FileArchive::create(const std::string& fullPath)
+{
+    auto archive = new (std::nothrow) FileArchive();
+    if (archive && archive->initWithFile(fullPath))
+    {
+        archive->autorelease();
+        return archive;
+    }
+    CC_SAFE_DELETE(archive);
+    return nullptr;
+}
+
+uint32_t FileArchive::hashName(const char* name, size_t length)
+{
+    return XXH32(name, length, 0);
+}
+
+FileArchive::FileArchive()
+: _bytes(nullptr)
+, _size(0)
+, _slots(nullptr)
+, _entries(nullptr)
+, _names(nullptr)
+, _entryCount(0)
+, _slotMask(0)
+{
+}
+
+FileArchive::~FileArchive()
+{
+}
+
+bool FileArchive::initWithFile(const std::string& fullPath)
+{
+    _path = fullPath;
+
+    // Files packed into an APK or a store package can't be mapped, read them instead
+    auto storage = std::make_shared<Storage>();
+    if (!storage->map(fullPath) && !storage->read(fullPath))
+        return false;
+
+    _storage = storage;
+    _bytes = storage->bytes;
+    _size = storage->size;
+
+    if (!parse())
+    {
+        CCLOG("cocos2d: FileArchive: %s is not a valid archive", fullPath.c_str());
+        reset();
+        return false;
+    }
+    return true;
+}
+
+bool FileArchive::isMapped() const
+{
+    return _storage && _storage->mapping != nullptr;
+}
+
+void FileArchive::reset()
+{
+    _storage.reset();
+    _bytes = nullptr;
+    _size = 0;
+    _slots = nullptr;
+    _entries = nullptr;
+    _names = nullptr;
+    _entryCount = 0;
+    _slotMask = 0;
+}
+
+bool FileArchive::parse()
+{
+    if (_size < sizeof(ArchiveHeader))
+        return false;
+
+    ArchiveHeader header;
+    memcpy(&header, _bytes, sizeof(header));
+    if (memcmp(header.magic, "CCPK", 4) != 0 || header.version != VERSION)
+        return false;
+
+    // A power of two with at least one free slot, so that probing always terminates
+    uint32_t slotCount = header.slotCount;
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || header.entryCount >= slotCount)
+        return false;
+
+    uint64_t slotsOffset = sizeof(ArchiveHeader);
+    uint64_t entriesOffset = slotsOffset + uint64_t(slotCount) * sizeof(uint32_t);
+    uint64_t namesOffset = entriesOffset + uint64_t(header.entryCount) * sizeof(Entry);
+    if (namesOffset + header.namesSize > _size)
+        return false;
+
+    _slots = reinterpret_cast<const uint32_t*>(_bytes + slotsOffset);
+    _entries = reinterpret_cast<const Entry*>(_bytes + entriesOffset);
+    _names = reinterpret_cast<const char*>(_bytes + namesOffset);
+    _entryCount = header.entryCount;
+    _slotMask = slotCount - 1;
+
+    // Validate the whole table once so that lookups don't have to
+    uint32_t usedSlots = 0;
+    for (uint32_t i = 0; i <= _slotMask; ++i)
+    {
+        if (_slots[i] > _entryCount)
+            return false;
+        if (_slots[i] != 0)
+            ++usedSlots;
+    }
+    if (usedSlots != _entryCount)
+        return false;
+    for (uint32_t i = 0; i < _entryCount; ++i)
+    {
+        const Entry& entry = _entries[i];
+        if (uint64_t(entry.nameOffset) + entry.nameLength > header.namesSize)
+            return false;
+        if (entry.offset > _size || entry.size > _size - entry.offset)
+            return false;
+    }
+    return true;
+}
+
+const FileArchive::Entry* FileArchive::findEntry(const char* name, size_t length) const
+{
+    if (_entryCount == 0)
+        return nullptr;
+
+    uint32_t hash = hashName(name, length);
+    for (uint32_t slot = hash & _slotMask; ; slot = (slot + 1) & _slotMask)
+    {
+        uint32_t index = _slots[slot];
+        if (index == 0)
+            return nullptr;
+
+        const Entry& entry = _entries[index - 1];
+        if (entry.hash == hash && entry.nameLength == length && memcmp(_names + entry.nameOffset, name, length) == 0)
+            return &entry;
+    }
+}
+
+bool FileArchive::find(const char* name, size_t length, const unsigned char** bytes, ssize_t* size) const
+{
+    auto entry = findEntry(name, length);
+    if (entry == nullptr)
+        return false;
+
+    if (bytes)
+        *bytes = _bytes + entry->offset;
+    if (size)
+        *size = static_cast<ssize_t>(entry->size);
+    return true;
+}
+
+bool FileArchive::find(const char* name, size_t length, ArchivedFileView* view) const
+{
+    auto entry = findEntry(name, length);
+    if (entry == nullptr)
+        return false;
+
+    view->_storage = _storage;
+    view->_bytes = _bytes + entry->offset;
+    view->_size = static_cast<ssize_t>(entry->size);
+    return true;
+}
+
+std::vector<std::string> FileArchive::getFileNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(_entryCount);
+    for (uint32_t i = 0; i < _entryCount; ++i)
+        names.emplace_back(_names + _entries[i].nameOffset, _entries[i].nameLength);
+    return names;
+}
+
+NS_CC_END
@@ -0,0 +1,190 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_FILEARCHIVE_H__
+#define __CC_FILEARCHIVE_H__
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCRef.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * The contents of a file in an archive, without copying them.
+ * The view keeps the memory of the archive alive, so it stays valid after the archive is unmounted
+ * or released, and it can be used and released on any thread.
+ *
+ * @see FileUtils::getArchivedFileView()
+ * @since v3.17
+ */
+class CC_DLL ArchivedFileView
+{
+public:
+    ArchivedFileView() : _bytes(nullptr), _size(0) {}
+
+    /** Gets the contents of the file. */
+    const unsigned char* getBytes() const { return _bytes; }
+
+    /** Gets the size of the file. */
+    ssize_t getSize() const { return _size; }
+
+    /** Returns true if the view holds no file. */
+    bool isNull() const { return _bytes == nullptr; }
+
+    /** Releases the file, and the archive memory if the archive was released already. */
+    void clear();
+
+private:
+    friend class FileArchive;
+
+    std::shared_ptr<const void> _storage;
+    const unsigned char* _bytes;
+    ssize_t _size;
+};
+
+/**
+ * A read-only packed asset archive, as written by tools/asset-pack/pack_assets.py.
+ *
+ * The archive is memory mapped when the platform allows it, otherwise it is read into memory
+ * once. Looking up a file is a single probe in the hashed table of contents, and the contents
+ * are handed out as views into the archive without being copied.
+ *
+ * Layout, all integers little endian:
+ * - Header: "CCPK", version, entry count, slot count, names size, reserved (6 x 4 bytes).
+ * - Slots: slot count x uint32, index + 1 of the entry whose name hash lands there, 0 if empty.
+ *   The slot count is a power of two and collisions are resolved by linear probing.
+ * - Entries: entry count x Entry.
+ * - Names: the file names relative to the archive root, '/' separated, not null terminated.
+ * - Data: the file contents, each aligned to 16 bytes.
+ *
+ * FileUtils::mountArchive() mounts an archive into the search paths.
+ *
+ * @since v3.17
+ */
+class CC_DLL FileArchive : public Ref
+{
+public:
+    /** Version of the format this class reads. */
+    static const uint32_t VERSION = 1;
+
+    /** An entry of the table of contents. */
+    struct Entry
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t hash;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t reserved;
+    };
+
+    /**
+     * Opens an archive.
+     *
+     * @param fullPath The full path of the archive file.
+     * @return An autoreleased FileArchive, or nullptr if the file is missing or isn't a valid archive.
+     */
+    static FileArchive* create(const std::string& fullPath);
+
+    /**
+     * Finds a file in the archive.
+     *
+     * @param name The name of the file relative to the archive root.
+     * @param length The length of name.
+     * @param bytes Receives a pointer to the contents of the file, valid as long as the archive lives.
+     * @param size Receives the size of the file.
+     * @return true if the file is in the archive.
+     */
+    bool find(const char* name, size_t length, const unsigned char** bytes, ssize_t* size) const;
+
+    /**
+     * Finds a file in the archive, like find(name, length, bytes, size).
+     *
+     * @param view Receives the contents of the file, valid even after the archive is released.
+     * @return true if the file is in the archive.
+     */
+    bool find(const char* name, size_t length, ArchivedFileView* view) const;
+
+    /** Returns true if the archive contains the file name, relative to the archive root. */
+    bool contains(const std::string& name) const { return findEntry(name.c_str(), name.size()) != nullptr; }
+
+    /** Returns the names of all the files in the archive. */
+    std::vector<std::string> getFileNames() const;
+
+    /** Returns the number of files in the archive. */
+    uint32_t getFileCount() const { return _entryCount; }
+
+    /** Returns the full path the archive was opened from. */
+    const std::string& getPath() const { return _path; }
+
+    /** Returns true if the archive is memory mapped rather than read into memory. */
+    bool isMapped() const;
+
+    /** Hashes a file name the way the table of contents does. */
+    static uint32_t hashName(const char* name, size_t length);
+
+CC_CONSTRUCTOR_ACCESS:
+    FileArchive();
+    virtual ~FileArchive();
+
+    bool initWithFile(const std::string& fullPath);
+
+protected:
+    /** The mapped file or its contents read into memory, shared with the views, see FileArchive.cpp. */
+    struct Storage;
+
+    bool parse();
+    void reset();
+    const Entry* findEntry(const char* name, size_t length) const;
+
+    std::string _path;
+
+    std::shared_ptr<Storage> _storage;
+    const unsigned char* _bytes;
+    size_t _size;
+
+    const uint32_t* _slots;
+    const Entry* _entries;
+    const char* _names;
+    uint32_t _entryCount;
+    uint32_t _slotMask;
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __CC_FILEARCHIVE_H__
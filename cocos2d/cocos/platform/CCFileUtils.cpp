@@ -26,12 +26,14 @@ THE SOFTWARE.
 
 #include "platform/CCFileUtils.h"
 
-#include <stack>
+#include <algorithm>
+#include <xxhash.h>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
-#include "platform/CCSAXParser.h"
+#include "platform/CCFileArchive.h"
+#include "platform/CCPlistParser.h"
 //#include "base/ccUtils.h"
 
 #include "tinyxml2/tinyxml2.h"
@@ -44,304 +46,23 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
-// Implement DictMaker
-
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
 
-typedef enum
-{
-    SAX_NONE = 0,
-    SAX_KEY,
-    SAX_DICT,
-    SAX_INT,
-    SAX_REAL,
-    SAX_STRING,
-    SAX_ARRAY
-}SAXState;
-
-typedef enum
-{
-    SAX_RESULT_NONE = 0,
-    SAX_RESULT_DICT,
-    SAX_RESULT_ARRAY
-}SAXResult;
-
-class DictMaker : public SAXDelegator
-{
-public:
-    SAXResult _resultType;
-    ValueMap _rootDict;
-    ValueVector _rootArray;
-
-    std::string _curKey;   ///< parsed key
-    std::string _curValue; // parsed value
-    SAXState _state;
-
-    ValueMap*  _curDict;
-    ValueVector* _curArray;
-
-    std::stack<ValueMap*> _dictStack;
-    std::stack<ValueVector*> _arrayStack;
-    std::stack<SAXState>  _stateStack;
-
-public:
-    DictMaker()
-        : _resultType(SAX_RESULT_NONE)
-        , _state(SAX_NONE)
-    {
-    }
-
-    ~DictMaker()
-    {
-    }
-
-    ValueMap dictionaryWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-        return _rootDict;
-    }
-
-    ValueMap dictionaryWithDataOfFile(const char* filedata, int filesize)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(filedata, filesize);
-        return _rootDict;
-    }
-
-    ValueVector arrayWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_ARRAY;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-        return _rootArray;
-    }
-
-    void startElement(void *ctx, const char *name, const char **atts) override
-    {
-        const std::string sName(name);
-        if( sName == "dict" )
-        {
-            if(_resultType == SAX_RESULT_DICT && _rootDict.empty())
-            {
-                _curDict = &_rootDict;
-            }
-
-            _state = SAX_DICT;
-
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
-
-            if (SAX_ARRAY == preState)
-            {
-                // add a new dictionary into the array
-                _curArray->push_back(Value(ValueMap()));
-                _curDict = &(_curArray->rbegin())->asValueMap();
-            }
-            else if (SAX_DICT == preState)
-            {
-                // add a new dictionary into the pre dictionary
-                CCASSERT(! _dictStack.empty(), "The state is wrong!");
-                ValueMap* preDict = _dictStack.top();
-                (*preDict)[_curKey] = Value(ValueMap());
-                _curDict = &(*preDict)[_curKey].asValueMap();
-            }
-
-            // record the dict state
-            _stateStack.push(_state);
-            _dictStack.push(_curDict);
-        }
-        else if(sName == "key")
-        {
-            _state = SAX_KEY;
-        }
-        else if(sName == "integer")
-        {
-            _state = SAX_INT;
-        }
-        else if(sName == "real")
-        {
-            _state = SAX_REAL;
-        }
-        else if(sName == "string")
-        {
-            _state = SAX_STRING;
-        }
-        else if (sName == "array")
-        {
-            _state = SAX_ARRAY;
-
-            if (_resultType == SAX_RESULT_ARRAY && _rootArray.empty())
-            {
-                _curArray = &_rootArray;
-            }
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
-
-            if (preState == SAX_DICT)
-            {
-                (*_curDict)[_curKey] = Value(ValueVector());
-                _curArray = &(*_curDict)[_curKey].asValueVector();
-            }
-            else if (preState == SAX_ARRAY)
-            {
-                CCASSERT(! _arrayStack.empty(), "The state is wrong!");
-                ValueVector* preArray = _arrayStack.top();
-                preArray->push_back(Value(ValueVector()));
-                _curArray = &(_curArray->rbegin())->asValueVector();
-            }
-            // record the array state
-            _stateStack.push(_state);
-            _arrayStack.push(_curArray);
-        }
-        else
-        {
-            _state = SAX_NONE;
-        }
-    }
-
-    void endElement(void *ctx, const char *name) override
-    {
-        SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string sName((char*)name);
-        if( sName == "dict" )
-        {
-            _stateStack.pop();
-            _dictStack.pop();
-            if ( !_dictStack.empty())
-            {
-                _curDict = _dictStack.top();
-            }
-        }
-        else if (sName == "array")
-        {
-            _stateStack.pop();
-            _arrayStack.pop();
-            if (! _arrayStack.empty())
-            {
-                _curArray = _arrayStack.top();
-            }
-        }
-        else if (sName == "true")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                _curArray->push_back(Value(true));
-            }
-            else if (SAX_DICT == curState)
-            {
-                (*_curDict)[_curKey] = Value(true);
-            }
-        }
-        else if (sName == "false")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                _curArray->push_back(Value(false));
-            }
-            else if (SAX_DICT == curState)
-            {
-                (*_curDict)[_curKey] = Value(false);
-            }
-        }
-        else if (sName == "string" || sName == "integer" || sName == "real")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                if (sName == "string")
-                    _curArray->push_back(Value(_curValue));
-                else if (sName == "integer")
-                    _curArray->push_back(Value(atoi(_curValue.c_str())));
-                else
-                    _curArray->push_back(Value(std::atof(_curValue.c_str())));
-            }
-            else if (SAX_DICT == curState)
-            {
-                if (sName == "string")
-                    (*_curDict)[_curKey] = Value(_curValue);
-                else if (sName == "integer")
-                    (*_curDict)[_curKey] = Value(atoi(_curValue.c_str()));
-                else
-                    (*_curDict)[_curKey] = Value(std::atof(_curValue.c_str()));
-            }
-
-            _curValue.clear();
-        }
-
-        _state = SAX_NONE;
-    }
-
-    void textHandler(void *ctx, const char *ch, size_t len) override
-    {
-        if (_state == SAX_NONE)
-        {
-            return;
-        }
-
-        SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string text = std::string((char*)ch,len);
-
-        switch(_state)
-        {
-        case SAX_KEY:
-            _curKey = text;
-            break;
-        case SAX_INT:
-        case SAX_REAL:
-        case SAX_STRING:
-            {
-                if (curState == SAX_DICT)
-                {
-                    CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
-                }
-
-                _curValue.append(text);
-            }
-            break;
-        default:
-            break;
-        }
-    }
-};
-
 ValueMap FileUtils::getValueMapFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename);
-    DictMaker tMaker;
-    return tMaker.dictionaryWithContentsOfFile(fullPath);
+    return PlistParser::getValueMapFromFile(fullPath);
 }
 
 ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 {
-    DictMaker tMaker;
-    return tMaker.dictionaryWithDataOfFile(filedata, filesize);
+    return PlistParser::getValueMap(filedata, filesize);
 }
 
 ValueVector FileUtils::getValueVectorFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename);
-    DictMaker tMaker;
-    return tMaker.arrayWithContentsOfFile(fullPath);
+    return PlistParser::getValueVectorFromFile(fullPath);
 }
 
 
@@ -552,12 +273,15 @@ void FileUtils::setDelegate(FileUtils *delegate)
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _fullPathCacheGeneration(0)
+    , _writablePath("")
 {
 }
 
 FileUtils::~FileUtils()
 {
+    for (auto& mounted : _mountedArchives)
+        mounted.second->release();
 }
 
 bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string& fullPath)
@@ -618,8 +342,22 @@ bool FileUtils::init()
 }
 
 void FileUtils::purgeCachedEntries()
+{
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    clearFullPathCache();
+}
+
+void FileUtils::clearFullPathCache() const
 {
     _fullPathCache.clear();
+    _unverifiedFullPaths.clear();
+    ++_fullPathCacheGeneration;
+}
+
+std::unordered_map<std::string, std::string> FileUtils::getFullPathCache() const
+{
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    return _fullPathCache;
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename)
@@ -665,6 +403,9 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    if (fs->readArchivedFile(fullPath, buffer))
+        return Status::OK;
+
     FILE *fp = fopen(fs->getSuitableFOpen(fullPath).c_str(), "rb");
     if (!fp)
         return Status::OpenFailed;
@@ -771,6 +512,7 @@ std::string FileUtils::getNewFilename(const std::string &filename) const
 {
     std::string newFileName;
 
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     // in Lookup Filename dictionary ?
     auto iter = _filenameLookupDict.find(filename);
 
@@ -806,6 +548,58 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
     return path;
 }
 
+// Same composition as getPathForFilename(): searchPath + file_path + resolutionDirectory + file,
+// but answered by the archive's table of contents instead of the filesystem.
+static std::string getPathForArchivedFilename(const FileArchive* archive, const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath)
+{
+    std::string name;
+    size_t pos = filename.find_last_of('/');
+    if (pos != std::string::npos)
+    {
+        name.append(filename, 0, pos + 1);
+    }
+    name += resolutionDirectory;
+    if (!name.empty() && name[name.size() - 1] != '/')
+    {
+        name += '/';
+    }
+    name.append(filename, pos == std::string::npos ? 0 : pos + 1, std::string::npos);
+
+    if (!archive->contains(name))
+    {
+        return "";
+    }
+    return searchPath + name;
+}
+
+// The inverse of getPathForFilename(): the file name that resolves to relativePath, a path under a search path,
+// through resolutionDirectory. False if relativePath isn't in that resolution directory.
+static bool getFilenameForResolution(const std::string& relativePath, const std::string& resolutionDirectory, std::string* filename)
+{
+    if (resolutionDirectory.empty())
+    {
+        *filename = relativePath;
+        return true;
+    }
+
+    size_t pos = relativePath.find_last_of('/');
+    if (pos == std::string::npos || pos + 1 < resolutionDirectory.size())
+    {
+        return false;
+    }
+
+    size_t resolutionPos = pos + 1 - resolutionDirectory.size();
+    if (relativePath.compare(resolutionPos, resolutionDirectory.size(), resolutionDirectory) != 0
+        || (resolutionPos > 0 && relativePath[resolutionPos - 1] != '/'))
+    {
+        return false;
+    }
+
+    filename->assign(relativePath, 0, resolutionPos);
+    filename->append(relativePath, pos + 1, std::string::npos);
+    return true;
+}
+
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
     if (filename.empty())
@@ -818,28 +612,81 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    std::string newFilename;
+    std::string unverifiedPath;
+    std::vector<std::string> searchPaths;
+    std::vector<std::string> searchResolutionsOrder;
+    unsigned int generation;
     {
-        return cacheIter->second;
+        std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+
+        // Already Cached ?
+        auto cacheIter = _fullPathCache.find(filename);
+        if(cacheIter != _fullPathCache.end())
+        {
+            if (_unverifiedFullPaths.empty() || _unverifiedFullPaths.find(filename) == _unverifiedFullPaths.end())
+            {
+                return cacheIter->second;
+            }
+            unverifiedPath = cacheIter->second;
+        }
+
+        // Get the new file name.
+        newFilename = getNewFilename(filename);
+        searchPaths = _searchPathArray;
+        searchResolutionsOrder = _searchResolutionsOrderArray;
+        generation = _fullPathCacheGeneration;
     }
 
-    // Get the new file name.
-    const std::string newFilename( getNewFilename(filename) );
+    // The filesystem is checked without the lock, the search paths may change meanwhile:
+    // the result is only cached if the cache hasn't been cleared since the copy above.
+    if (!unverifiedPath.empty())
+    {
+        // An entry of loadFullPathCache(), the file may have been removed since it was saved
+        bool exists = isFileExist(unverifiedPath);
+        std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+        if (generation == _fullPathCacheGeneration)
+        {
+            _unverifiedFullPaths.erase(filename);
+            if (!exists)
+            {
+                _fullPathCache.erase(filename);
+            }
+        }
+        if (exists)
+        {
+            return unverifiedPath;
+        }
+    }
 
     std::string fullpath;
 
-    for (const auto& searchIt : _searchPathArray)
+    for (const auto& searchIt : searchPaths)
     {
-        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        for (const auto& resolutionIt : searchResolutionsOrder)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            bool archived = false;
+            if (!_mountedArchives.empty())
+            {
+                std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+                auto archiveIter = _mountedArchives.find(searchIt);
+                if (archiveIter != _mountedArchives.end())
+                {
+                    archived = true;
+                    fullpath = getPathForArchivedFilename(archiveIter->second, newFilename, resolutionIt, searchIt);
+                }
+            }
+            if (!archived)
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.emplace(filename, fullpath);
+                std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+                if (generation == _fullPathCacheGeneration)
+                {
+                    _fullPathCache.emplace(filename, fullpath);
+                }
                 return fullpath;
             }
 
@@ -861,6 +708,7 @@ std::string FileUtils::fullPathFromRelativeFile(const std::string &filename, con
 
 void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& searchResolutionsOrder)
 {
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     if (_searchResolutionsOrderArray == searchResolutionsOrder)
     {
         return;
@@ -868,7 +716,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     bool existDefault = false;
 
-    _fullPathCache.clear();
+    clearFullPathCache();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -898,7 +746,10 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     if (!resOrder.empty() && resOrder[resOrder.length()-1] != '/')
         resOrder.append("/");
 
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     if (front) {
+        // the files found before may now resolve to this directory, the ones added at the back are tried last
+        clearFullPathCache();
         _searchResolutionsOrderArray.insert(_searchResolutionsOrderArray.begin(), resOrder);
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
@@ -932,9 +783,10 @@ const std::string& FileUtils::getDefaultResourceRootPath() const
 
 void FileUtils::setDefaultResourceRootPath(const std::string& path)
 {
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     if (_defaultResRootPath != path)
     {
-        _fullPathCache.clear();
+        clearFullPathCache();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
         {
@@ -948,10 +800,11 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
 
 void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 {
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     bool existDefaultRootPath = false;
     _originalSearchPaths = searchPaths;
 
-    _fullPathCache.clear();
+    clearFullPathCache();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -994,7 +847,10 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         path += "/";
     }
 
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
     if (front) {
+        // the files found before may now resolve to this path, the ones added at the back are tried last
+        clearFullPathCache();
         _originalSearchPaths.insert(_originalSearchPaths.begin(), searchpath);
         _searchPathArray.insert(_searchPathArray.begin(), path);
     } else {
@@ -1003,9 +859,308 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     }
 }
 
+bool FileUtils::mountArchive(const std::string& archivePath, bool front)
+{
+    std::string fullPath = fullPathForFilename(archivePath);
+    if (fullPath.empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    std::string searchPath = fullPath + '/';
+    if (_mountedArchives.find(searchPath) != _mountedArchives.end())
+    {
+        return true;
+    }
+
+    auto archive = FileArchive::create(fullPath);
+    if (archive == nullptr)
+    {
+        return false;
+    }
+
+    archive->retain();
+    _mountedArchives.emplace(searchPath, archive);
+    addSearchPath(searchPath, front);
+
+    // Files may now resolve into the archive instead of where they were found before
+    clearFullPathCache();
+    return true;
+}
+
+bool FileUtils::unmountArchive(const std::string& archivePath)
+{
+    std::string fullPath = fullPathForFilename(archivePath);
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    auto iter = _mountedArchives.find(fullPath + '/');
+    if (iter == _mountedArchives.end())
+    {
+        return false;
+    }
+
+    const std::string& searchPath = iter->first;
+    _searchPathArray.erase(std::remove(_searchPathArray.begin(), _searchPathArray.end(), searchPath), _searchPathArray.end());
+    _originalSearchPaths.erase(std::remove(_originalSearchPaths.begin(), _originalSearchPaths.end(), searchPath), _originalSearchPaths.end());
+
+    iter->second->release();
+    _mountedArchives.erase(iter);
+    clearFullPathCache();
+    return true;
+}
+
+bool FileUtils::getArchivedFileView(const std::string& filename, ArchivedFileView* view) const
+{
+    if (filename.empty())
+    {
+        return false;
+    }
+    return findArchivedFile(fullPathForFilename(filename), view);
+}
+
+const FileArchive* FileUtils::getMountedArchive(const std::string& fullPath, size_t* prefixLength) const
+{
+    // An archive may itself be packed into another one, the innermost mount wins
+    const FileArchive* archive = nullptr;
+    *prefixLength = 0;
+    for (const auto& mounted : _mountedArchives)
+    {
+        const std::string& prefix = mounted.first;
+        if (prefix.size() > *prefixLength && fullPath.size() > prefix.size() && fullPath.compare(0, prefix.size(), prefix) == 0)
+        {
+            archive = mounted.second;
+            *prefixLength = prefix.size();
+        }
+    }
+    return archive;
+}
+
+bool FileUtils::findArchivedFile(const std::string& fullPath, const unsigned char** bytes, ssize_t* size) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    size_t prefixLength = 0;
+    const FileArchive* archive = _mountedArchives.empty() ? nullptr : getMountedArchive(fullPath, &prefixLength);
+    if (archive == nullptr)
+    {
+        return false;
+    }
+    return archive->find(fullPath.c_str() + prefixLength, fullPath.size() - prefixLength, bytes, size);
+}
+
+bool FileUtils::findArchivedFile(const std::string& fullPath, ArchivedFileView* view) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    size_t prefixLength = 0;
+    const FileArchive* archive = _mountedArchives.empty() ? nullptr : getMountedArchive(fullPath, &prefixLength);
+    if (archive == nullptr)
+    {
+        return false;
+    }
+    return archive->find(fullPath.c_str() + prefixLength, fullPath.size() - prefixLength, view);
+}
+
+bool FileUtils::readArchivedFile(const std::string& fullPath, ResizableBuffer* buffer) const
+{
+    const unsigned char* bytes = nullptr;
+    ssize_t size = 0;
+    // the archive stays mounted while it is copied
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    if (!findArchivedFile(fullPath, &bytes, &size))
+    {
+        return false;
+    }
+
+    buffer->resize(size);
+    if (size > 0)
+    {
+        memcpy(buffer->buffer(), bytes, size);
+    }
+    return true;
+}
+
+unsigned int FileUtils::getFullPathCacheKey() const
+{
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+
+    std::string state;
+    for (const auto& searchPath : _searchPathArray)
+    {
+        state += searchPath;
+        state += '\n';
+    }
+    state += '\0';
+    for (const auto& resolution : _searchResolutionsOrderArray)
+    {
+        state += resolution;
+        state += '\n';
+    }
+    state += '\0';
+
+    // ValueMap doesn't keep an order
+    std::vector<std::string> lookups;
+    lookups.reserve(_filenameLookupDict.size());
+    for (const auto& lookup : _filenameLookupDict)
+    {
+        lookups.push_back(lookup.first + '\t' + lookup.second.asString());
+    }
+    std::sort(lookups.begin(), lookups.end());
+    for (const auto& lookup : lookups)
+    {
+        state += lookup;
+        state += '\n';
+    }
+
+    return XXH32(state.data(), static_cast<int>(state.size()), 0);
+}
+
+void FileUtils::buildFullPathCache()
+{
+    std::vector<std::string> searchPaths;
+    std::vector<std::string> resolutions;
+    std::unordered_map<std::string, std::vector<std::string>> archivedFiles;
+    unsigned int key;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+        searchPaths = _searchPathArray;
+        resolutions = _searchResolutionsOrderArray;
+        for (const auto& mounted : _mountedArchives)
+        {
+            archivedFiles.emplace(mounted.first, mounted.second->getFileNames());
+        }
+        key = getFullPathCacheKey();
+    }
+
+    // The files by the name fullPathForFilename() resolves to them. Like it, the search paths are tried first,
+    // then the resolution directories, so the first file found for a name wins.
+    std::unordered_map<std::string, std::string> found;
+    std::vector<std::string> files;
+    std::string relativePath;
+    std::string filename;
+    for (const auto& searchPath : searchPaths)
+    {
+        files.clear();
+        size_t prefixLength = 0;
+        auto archiveIter = archivedFiles.find(searchPath);
+        if (archiveIter != archivedFiles.end())
+        {
+            files.swap(archiveIter->second);
+        }
+        else if (!searchPath.empty() && isAbsolutePath(searchPath) && isDirectoryExistInternal(searchPath))
+        {
+            listFilesRecursively(searchPath, &files);
+            prefixLength = searchPath.size();
+        }
+
+        for (const auto& resolution : resolutions)
+        {
+            for (const auto& file : files)
+            {
+                // the directories end with '/', the archived files are relative to the archive
+                if (file.size() <= prefixLength || file.back() == '/'
+                    || (prefixLength > 0 && file.compare(0, prefixLength, searchPath) != 0))
+                {
+                    continue;
+                }
+
+                relativePath.assign(file, prefixLength, std::string::npos);
+                if (getFilenameForResolution(relativePath, resolution, &filename) && found.find(filename) == found.end())
+                {
+                    found.emplace(filename, searchPath + relativePath);
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    if (key != getFullPathCacheKey())
+    {
+        // the search paths changed while scanning them
+        return;
+    }
+
+    for (const auto& file : found)
+    {
+        // the names replaced by the filenameLookup dictionary are only found by their key
+        if (getNewFilename(file.first) == file.first)
+        {
+            _fullPathCache.emplace(file.first, file.second);
+        }
+    }
+    for (const auto& lookup : _filenameLookupDict)
+    {
+        auto iter = found.find(lookup.second.asString());
+        if (iter != found.end())
+        {
+            _fullPathCache.emplace(lookup.first, iter->second);
+        }
+    }
+}
+
+bool FileUtils::saveFullPathCache(const std::string& fullPath)
+{
+    ValueMap paths;
+    char key[16];
+    {
+        std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+        for (const auto& entry : _fullPathCache)
+        {
+            paths.emplace(entry.first, Value(entry.second));
+        }
+        snprintf(key, sizeof(key), "%08x", getFullPathCacheKey());
+    }
+
+    ValueMap metadata;
+    metadata["version"] = Value(1);
+    metadata["key"] = Value(key);
+
+    ValueMap dict;
+    dict["metadata"] = Value(std::move(metadata));
+    dict["paths"] = Value(std::move(paths));
+    return writeValueMapToFile(dict, fullPath);
+}
+
+bool FileUtils::loadFullPathCache(const std::string& fullPath)
+{
+    if (!isFileExist(fullPath))
+    {
+        return false;
+    }
+
+    ValueMap dict = getValueMapFromFile(fullPath);
+    auto metadataIter = dict.find("metadata");
+    auto pathsIter = dict.find("paths");
+    if (metadataIter == dict.end() || metadataIter->second.getType() != Value::Type::MAP
+        || pathsIter == dict.end() || pathsIter->second.getType() != Value::Type::MAP)
+    {
+        CCLOG("cocos2d: FileUtils: %s is not a full path cache", fullPath.c_str());
+        return false;
+    }
+
+    ValueMap& metadata = metadataIter->second.asValueMap();
+    char key[16];
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    snprintf(key, sizeof(key), "%08x", getFullPathCacheKey());
+    if (metadata["version"].asInt() != 1 || metadata["key"].asString() != key)
+    {
+        CCLOG("cocos2d: FileUtils: the full path cache %s is out of date", fullPath.c_str());
+        return false;
+    }
+
+    // Each entry is checked the first time it is used, see fullPathForFilename()
+    for (const auto& entry : pathsIter->second.asValueMap())
+    {
+        if (_fullPathCache.emplace(entry.first, entry.second.asString()).second)
+        {
+            _unverifiedFullPaths.insert(entry.first);
+        }
+    }
+    return true;
+}
+
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
-    _fullPathCache.clear();
+    std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+    clearFullPathCache();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1049,6 +1204,8 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        if (findArchivedFile(filename, nullptr, nullptr))
+            return true;
         return isFileExistInternal(filename);
     }
     else
@@ -1083,23 +1240,47 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
         return isDirectoryExistInternal(dirPath);
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(dirPath);
-    if( cacheIter != _fullPathCache.end() )
+    std::string cachedPath;
+    std::vector<std::string> searchPaths;
+    std::vector<std::string> searchResolutionsOrder;
+    unsigned int generation = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+
+        // Already Cached ?
+        auto cacheIter = _fullPathCache.find(dirPath);
+        if( cacheIter != _fullPathCache.end() )
+        {
+            cachedPath = cacheIter->second;
+        }
+        else
+        {
+            searchPaths = _searchPathArray;
+            searchResolutionsOrder = _searchResolutionsOrderArray;
+            generation = _fullPathCacheGeneration;
+        }
+    }
+
+    // The filesystem is checked without the lock, like in fullPathForFilename()
+    if (!cachedPath.empty())
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        return isDirectoryExistInternal(cachedPath);
     }
 
     std::string fullpath;
-    for (const auto& searchIt : _searchPathArray)
+    for (const auto& searchIt : searchPaths)
     {
-        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        for (const auto& resolutionIt : searchResolutionsOrder)
         {
             // searchPath + file_path + resourceDirectory
             fullpath = fullPathForFilename(searchIt + dirPath + resolutionIt);
             if (isDirectoryExistInternal(fullpath))
             {
-                _fullPathCache.emplace(dirPath, fullpath);
+                std::lock_guard<std::recursive_mutex> lock(_fullPathMutex);
+                if (generation == _fullPathCacheGeneration)
+                {
+                    _fullPathCache.emplace(dirPath, fullpath);
+                }
                 return true;
             }
         }
@@ -1414,6 +1595,10 @@ long FileUtils::getFileSize(const std::string &filepath)
             return 0;
     }
 
+    ssize_t archivedSize = 0;
+    if (findArchivedFile(fullpath, nullptr, &archivedSize))
+        return (long)archivedSize;
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
@@ -29,7 +29,9 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
+#include <mutex>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
@@ -46,6 +48,9 @@ NS_CC_BEGIN
  * @{
  */
 
+class FileArchive;
+class ArchivedFileView;
+
 
 class ResizableBuffer {
 public:
@@ -461,6 +466,44 @@ public:
       */
     void addSearchPath(const std::string & path, const bool front=false);
 
+    /**
+     * Mounts a packed asset archive into the search paths.
+     *
+     * The archive is added to the search paths as if it were a directory named like the archive file,
+     * so "images/hero.png" packed into "assets.cpk" resolves to ".../assets.cpk/images/hero.png".
+     * Resolution directories and the filename lookup dictionary apply as usual, but looking up a file
+     * costs a single hash probe instead of filesystem calls, and reading it needs no file handle.
+     * Archives are written by tools/asset-pack/pack_assets.py.
+     *
+     * @param archivePath The path of the archive, resolved like any other file.
+     * @param front Whether the archive is searched before the existing search paths.
+     * @return true if the archive is mounted.
+     * @since v3.17
+     */
+    bool mountArchive(const std::string& archivePath, bool front = false);
+
+    /**
+     * Unmounts an archive mounted with mountArchive() and removes it from the search paths.
+     * The views returned by getArchivedFileView() for that archive stay valid, the archive is unmapped when the last one is released.
+     *
+     * @param archivePath The path the archive was mounted with.
+     * @return true if the archive was mounted.
+     * @since v3.17
+     */
+    bool unmountArchive(const std::string& archivePath);
+
+    /**
+     * Gets the contents of a file stored in a mounted archive without copying them.
+     *
+     * The view keeps the archive memory alive, so it can be read from a worker thread while the archive is unmounted.
+     *
+     * @param filename The file name, resolved like in fullPathForFilename().
+     * @param view Receives the contents.
+     * @return true if the file was found in a mounted archive, false if it is a loose file or missing.
+     * @since v3.17
+     */
+    bool getArchivedFileView(const std::string& filename, ArchivedFileView* view) const;
+
     /**
      *  Gets the array of search paths.
      *
@@ -841,8 +884,37 @@ public:
     */
     virtual void listFilesRecursivelyAsync(const std::string& dirPath, std::function<void(std::vector<std::string>)> callback) const;
 
-    /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
+    /** Returns a copy of the full path cache, it may be changed by other threads meanwhile. */
+    std::unordered_map<std::string, std::string> getFullPathCache() const;
+
+    /**
+     *  Fills the full path cache with the files found under the search paths, scanning each search path once,
+     *  instead of checking every search path and resolution directory the first time a file is asked for.
+     *  The files are resolved as fullPathForFilename() does, including the filenameLookup dictionary.
+     *  Only the absolute search paths and the mounted archives are scanned, the other files are still resolved when asked for.
+     *  @see loadFullPathCache()
+     *  @since v3.17
+     */
+    void buildFullPathCache();
+
+    /**
+     *  Saves the full path cache to a file, to be loaded by loadFullPathCache() at the next launch.
+     *  @param fullPath The full path of the file, e.g. in the writable path.
+     *  @return true if the file was written.
+     *  @since v3.17
+     */
+    bool saveFullPathCache(const std::string& fullPath);
+
+    /**
+     *  Loads a full path cache saved by saveFullPathCache().
+     *  The file is ignored if the search paths, the resolutions order or the filenameLookup dictionary changed since it was saved.
+     *  Each entry is checked the first time it is used, and resolved again if its file was removed. A file added in front of
+     *  a cached one isn't noticed, so keep a cache per version of the resources, or save it again after downloading an update.
+     *  @param fullPath The full path of the file.
+     *  @return true if the cache was loaded.
+     *  @since v3.17
+     */
+    bool loadFullPathCache(const std::string& fullPath);
 
     /**
      *  Gets the new filename from the filename lookup dictionary.
@@ -905,6 +977,52 @@ protected:
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename) const;
 
+    /**
+     *  Finds a full path inside the mounted archives.
+     *
+     *  @param fullPath The full path of the file.
+     *  @param bytes Receives a pointer to the archived contents, may be nullptr.
+     *  It is only valid while _fullPathMutex is held, use the ArchivedFileView version to keep it.
+     *  @param size Receives the size of the archived contents, may be nullptr.
+     *  @return true if the file lives in a mounted archive.
+     */
+    bool findArchivedFile(const std::string& fullPath, const unsigned char** bytes, ssize_t* size) const;
+
+    /**
+     *  Finds a full path inside the mounted archives.
+     *
+     *  @param fullPath The full path of the file.
+     *  @param view Receives the archived contents.
+     *  @return true if the file lives in a mounted archive.
+     */
+    bool findArchivedFile(const std::string& fullPath, ArchivedFileView* view) const;
+
+    /**
+     *  Gets the mounted archive a full path is in, with _fullPathMutex held.
+     *
+     *  @param fullPath The full path of the file.
+     *  @param prefixLength Receives the length of the search path of the archive.
+     *  @return The archive, nullptr if the path isn't in a mounted archive.
+     */
+    const FileArchive* getMountedArchive(const std::string& fullPath, size_t* prefixLength) const;
+
+    /**
+     *  Copies a file from the mounted archives into buffer.
+     *  Implementations of getContents() call this before touching the filesystem.
+     *
+     *  @return true if the file lives in a mounted archive and was copied.
+     */
+    bool readArchivedFile(const std::string& fullPath, ResizableBuffer* buffer) const;
+
+    /**
+     *  Gets a hash of what fullPathForFilename() depends on: the search paths, the resolutions order and the filenameLookup dictionary.
+     *  A saved full path cache is only valid for the same hash.
+     */
+    unsigned int getFullPathCacheKey() const;
+
+    /** Clears the full path cache, with _fullPathMutex held. */
+    void clearFullPathCache() const;
+
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
      *
@@ -946,6 +1064,23 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCache;
 
+    /** The entries of _fullPathCache loaded by loadFullPathCache() and not checked yet. */
+    mutable std::unordered_set<std::string> _unverifiedFullPaths;
+
+    /** Incremented each time _fullPathCache is cleared, so a path resolved without the lock isn't cached once it is out of date. */
+    mutable unsigned int _fullPathCacheGeneration;
+
+    /**
+     *  The mounted archives, keyed by the search path they were mounted as.
+     */
+    std::unordered_map<std::string, FileArchive*> _mountedArchives;
+
+    /**
+     *  Guards what fullPathForFilename() reads and the full path cache, since the loaders of the worker threads resolve paths too:
+     *  the search paths, the resolutions order, the filenameLookup dictionary and the mounted archives.
+     */
+    mutable std::recursive_mutex _fullPathMutex;
+
     /**
      * Writable path.
      */
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 
 #include <string>
+#include <algorithm>
 #include <ctype.h>
 
 #include "base/CCData.h"
@@ -105,10 +106,13 @@ extern "C"
 #include "base/ccMacros.h"
 #include "platform/CCCommon.h"
 #include "platform/CCStdC.h"
+#include "platform/CCDecodedImageCache.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCFileArchive.h"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
 #include "base/ZipUtils.h"
+#include "renderer/ccPixelConversion.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
@@ -452,7 +456,79 @@ namespace
             png_error(png_ptr, "pngReaderCallback failed");
         }
     }
+
+    // The bytes already inflated from the stream, followed by the rest of the stream
+    typedef struct
+    {
+        const unsigned char * head;
+        ssize_t headSize;
+        ssize_t offset;
+        InflateStream* stream;
+    }tImageStream;
+
+    static void pngStreamReadCallback(png_structp png_ptr, png_bytep data, png_size_t length)
+    {
+        tImageStream* isource = (tImageStream*)png_get_io_ptr(png_ptr);
+
+        ssize_t headLength = std::min(static_cast<ssize_t>(length), isource->headSize - isource->offset);
+        if (headLength > 0)
+        {
+            memcpy(data, isource->head + isource->offset, headLength);
+            isource->offset += headLength;
+        }
+
+        ssize_t remaining = static_cast<ssize_t>(length) - headLength;
+        if (remaining > 0 && isource->stream->read(data + headLength, remaining) != remaining)
+        {
+            png_error(png_ptr, "pngStreamReadCallback failed");
+        }
+    }
 #endif //CC_USE_PNG
+
+    // Inflates the rest of a stream whose first headLen bytes were already read into head
+    ssize_t inflateRemaining(InflateStream& stream, const unsigned char* head, ssize_t headLen, unsigned char** out)
+    {
+        // memory in iPhone is precious, grow the buffer only if the size isn't recorded
+        ssize_t capacity = std::max(stream.getUncompressedSize(), headLen);
+        if (capacity == headLen && !stream.isFinished())
+        {
+            capacity = std::max(static_cast<ssize_t>(256 * 1024), headLen * 2);
+        }
+
+        unsigned char* buffer = static_cast<unsigned char*>(malloc(capacity > 0 ? capacity : 1));
+        if (!buffer)
+        {
+            return -1;
+        }
+        memcpy(buffer, head, headLen);
+        ssize_t length = headLen;
+
+        while (!stream.isFinished())
+        {
+            if (length == capacity)
+            {
+                capacity *= 2;
+                unsigned char* grown = static_cast<unsigned char*>(realloc(buffer, capacity));
+                if (!grown)
+                {
+                    free(buffer);
+                    return -1;
+                }
+                buffer = grown;
+            }
+
+            ssize_t read = stream.read(buffer + length, capacity - length);
+            if (read < 0)
+            {
+                free(buffer);
+                return -1;
+            }
+            length += read;
+        }
+
+        *out = buffer;
+        return length;
+    }
 }
 
 Texture2D::PixelFormat getDevicePixelFormat(Texture2D::PixelFormat format)
@@ -511,6 +587,13 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
+    // Files in a mounted archive are decoded straight from the mapping, the view keeps it mapped
+    ArchivedFileView archived;
+    if (FileUtils::getInstance()->getArchivedFileView(_filePath, &archived))
+    {
+        return initWithImageData(archived.getBytes(), archived.getSize());
+    }
+
     Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
 
     if (!data.isNull())
@@ -526,6 +609,13 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
+    // called by the loader threads, the view keeps the archive mapped even if it is unmounted meanwhile
+    ArchivedFileView archived;
+    if (FileUtils::getInstance()->getArchivedFileView(fullpath, &archived))
+    {
+        return initWithImageData(archived.getBytes(), archived.getSize());
+    }
+
     Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
 
     if (!data.isNull())
@@ -539,22 +629,47 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
 bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
 {
     bool ret = false;
+    uint64_t cacheKey = 0;
     
     do
     {
         CC_BREAK_IF(! data || dataLen <= 0);
+
+        if (DecodedImageCache::isEnabled())
+        {
+            cacheKey = DecodedImageCache::computeKey(data, dataLen);
+            if (DecodedImageCache::load(cacheKey, dataLen, this))
+            {
+                // already cached, nothing to store
+                cacheKey = 0;
+                ret = true;
+                break;
+            }
+        }
         
         unsigned char* unpackedData = nullptr;
         ssize_t unpackedLen = 0;
         
         //detect and unzip the compress file
-        if (ZipUtils::isCCZBuffer(data, dataLen))
-        {
-            unpackedLen = ZipUtils::inflateCCZBuffer(data, dataLen, &unpackedData);
-        }
-        else if (ZipUtils::isGZipBuffer(data, dataLen))
+        if (ZipUtils::isCCZBuffer(data, dataLen) || ZipUtils::isGZipBuffer(data, dataLen))
         {
-            unpackedLen = ZipUtils::inflateMemory(const_cast<unsigned char*>(data), dataLen, &unpackedData);
+            // inflate the head only, so a PNG file can be decoded as it is inflated
+            InflateStream stream;
+            unsigned char head[16];
+            ssize_t headLen = stream.init(data, dataLen) ? stream.read(head, sizeof(head)) : -1;
+            CC_BREAK_IF(headLen < 0);
+
+#if CC_USE_PNG && !CC_USE_WIC
+            if (isPng(head, headLen))
+            {
+                _fileType = Format::PNG;
+                ret = initWithPngData(head, headLen, &stream);
+                break;
+            }
+#endif
+
+            unpackedLen = inflateRemaining(stream, head, headLen, &unpackedData);
+            CC_BREAK_IF(unpackedLen < 0);
         }
         else
         {
@@ -614,6 +729,11 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
             free(unpackedData);
         }
     } while (0);
+
+    if (ret && cacheKey != 0)
+    {
+        DecodedImageCache::save(cacheKey, dataLen, this);
+    }
     
     return ret;
 }
@@ -1018,8 +1138,14 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
 }
 
 bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
+{
+    return initWithPngData(data, dataLen, nullptr);
+}
+
+bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen, InflateStream* stream)
 {
 #if CC_USE_WIC
+    CCASSERT(!stream, "WIC decodes PNG files from memory only");
     return decodeWithWIC(data, dataLen);
 #elif CC_USE_PNG
     // length of bytes to check if it is a valid png file
@@ -1055,7 +1181,19 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         imageSource.data    = (unsigned char*)data;
         imageSource.size    = dataLen;
         imageSource.offset  = 0;
-        png_set_read_fn(png_ptr, &imageSource, pngReadCallback);
+        tImageStream imageStream;
+        imageStream.head     = data;
+        imageStream.headSize = dataLen;
+        imageStream.offset   = 0;
+        imageStream.stream   = stream;
+        if (stream)
+        {
+            png_set_read_fn(png_ptr, &imageStream, pngStreamReadCallback);
+        }
+        else
+        {
+            png_set_read_fn(png_ptr, &imageSource, pngReadCallback);
+        }
 
         // read png header info
 
@@ -2453,12 +2591,7 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    PixelConversion::premultiplyAlpha(_data, static_cast<ssize_t>(_width) * _height);
     
     _hasPremultipliedAlpha = true;
 #endif
@@ -45,6 +45,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class InflateStream;
+
 /**
  * @addtogroup platform
  * @{
@@ -64,6 +66,7 @@ class CC_DLL Image : public Ref
 {
 public:
     friend class TextureCache;
+    friend class DecodedImageCache;
     /**
      * @js ctor
      */
@@ -168,6 +171,7 @@ protected:
 #endif
     bool initWithJpgData(const unsigned char *  data, ssize_t dataLen);
     bool initWithPngData(const unsigned char * data, ssize_t dataLen);
+    bool initWithPngData(const unsigned char * data, ssize_t dataLen, InflateStream* stream);
     bool initWithTiffData(const unsigned char * data, ssize_t dataLen);
     bool initWithWebpData(const unsigned char * data, ssize_t dataLen);
     bool initWithPVRData(const unsigned char * data, ssize_t dataLen);
@@ -0,0 +1,757 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCPlistParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+#include "platform/CCFileUtils.h"
+#include "platform/CCFileArchive.h"
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // Deeper nesting than this is treated as malformed rather than risking the stack
+    const int MAX_PLIST_DEPTH = 256;
+
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    inline bool tagIs(const char* name, size_t length, const char* expected, size_t expectedLength)
+    {
+        return length == expectedLength && memcmp(name, expected, length) == 0;
+    }
+
+#define PLIST_TAG_IS(name, length, literal) tagIs(name, length, literal, sizeof(literal) - 1)
+
+    void appendUTF8(std::string& out, unsigned long codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x110000)
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    class XmlPlistReader
+    {
+    public:
+        XmlPlistReader(const char* data, size_t length, PlistVisitor* visitor)
+        : _p(data)
+        , _end(data + length)
+        , _visitor(visitor)
+        {
+        }
+
+        bool parse()
+        {
+            const char* name = nullptr;
+            size_t nameLength = 0;
+            bool closing = false, selfClosing = false;
+
+            if (!nextTag(&name, &nameLength, &closing, &selfClosing) || closing)
+                return false;
+
+            if (PLIST_TAG_IS(name, nameLength, "plist"))
+            {
+                if (selfClosing)
+                    return true;
+                if (!nextTag(&name, &nameLength, &closing, &selfClosing))
+                    return false;
+                // An empty <plist></plist>
+                if (closing)
+                    return true;
+            }
+            return parseElement(name, nameLength, selfClosing, 0);
+        }
+
+    private:
+        bool startsWith(const char* p, const char* literal, size_t length) const
+        {
+            return static_cast<size_t>(_end - p) >= length && memcmp(p, literal, length) == 0;
+        }
+
+        const char* find(const char* from, const char* literal, size_t length) const
+        {
+            for (const char* p = from; static_cast<size_t>(_end - p) >= length; ++p)
+            {
+                p = static_cast<const char*>(memchr(p, literal[0], _end - p));
+                if (p == nullptr)
+                    return nullptr;
+                if (static_cast<size_t>(_end - p) >= length && memcmp(p, literal, length) == 0)
+                    return p;
+            }
+            return nullptr;
+        }
+
+        // Skips text, comments, processing instructions and the DOCTYPE, stopping at the next tag
+        bool skipToTag()
+        {
+            for (;;)
+            {
+                const char* lt = static_cast<const char*>(memchr(_p, '<', _end - _p));
+                if (lt == nullptr)
+                    return false;
+                _p = lt;
+
+                const char* skipEnd = nullptr;
+                if (startsWith(_p, "<!--", 4))
+                    skipEnd = find(_p + 4, "-->", 3);
+                else if (startsWith(_p, "<?", 2))
+                    skipEnd = find(_p + 2, "?>", 2);
+                else if (startsWith(_p, "<!", 2))
+                    skipEnd = find(_p + 2, ">", 1);
+                else
+                    return true;
+
+                if (skipEnd == nullptr)
+                    return false;
+                _p = skipEnd + 1;
+            }
+        }
+
+        bool nextTag(const char** name, size_t* nameLength, bool* closing, bool* selfClosing)
+        {
+            if (!skipToTag())
+                return false;
+
+            ++_p;
+            *closing = (_p < _end && *_p == '/');
+            if (*closing)
+                ++_p;
+
+            *name = _p;
+            while (_p < _end && !isSpace(*_p) && *_p != '>' && *_p != '/')
+                ++_p;
+            *nameLength = _p - *name;
+
+            const char* gt = static_cast<const char*>(memchr(_p, '>', _end - _p));
+            if (gt == nullptr || *nameLength == 0)
+                return false;
+
+            *selfClosing = !*closing && gt[-1] == '/';
+            _p = gt + 1;
+            return true;
+        }
+
+        bool expectClosingTag(const char* name, size_t nameLength)
+        {
+            const char* tagName = nullptr;
+            size_t tagLength = 0;
+            bool closing = false, selfClosing = false;
+            return nextTag(&tagName, &tagLength, &closing, &selfClosing)
+                && closing && tagIs(tagName, tagLength, name, nameLength);
+        }
+
+        void appendUnescaped(const char* begin, const char* end)
+        {
+            while (begin < end)
+            {
+                const char* amp = static_cast<const char*>(memchr(begin, '&', end - begin));
+                if (amp == nullptr)
+                {
+                    _scratch.append(begin, end);
+                    return;
+                }
+                _scratch.append(begin, amp);
+
+                const char* semicolon = static_cast<const char*>(memchr(amp, ';', end - amp));
+                if (semicolon == nullptr)
+                {
+                    _scratch.append(amp, end);
+                    return;
+                }
+
+                const char* entity = amp + 1;
+                size_t length = semicolon - entity;
+                if (PLIST_TAG_IS(entity, length, "lt"))
+                    _scratch += '<';
+                else if (PLIST_TAG_IS(entity, length, "gt"))
+                    _scratch += '>';
+                else if (PLIST_TAG_IS(entity, length, "amp"))
+                    _scratch += '&';
+                else if (PLIST_TAG_IS(entity, length, "quot"))
+                    _scratch += '"';
+                else if (PLIST_TAG_IS(entity, length, "apos"))
+                    _scratch += '\'';
+                else if (length > 1 && entity[0] == '#')
+                {
+                    bool hex = (entity[1] == 'x' || entity[1] == 'X');
+                    unsigned long codePoint = 0;
+                    for (const char* c = entity + (hex ? 2 : 1); c < semicolon; ++c)
+                    {
+                        int digit = -1;
+                        if (*c >= '0' && *c <= '9')
+                            digit = *c - '0';
+                        else if (hex && *c >= 'a' && *c <= 'f')
+                            digit = *c - 'a' + 10;
+                        else if (hex && *c >= 'A' && *c <= 'F')
+                            digit = *c - 'A' + 10;
+                        if (digit < 0 || codePoint > 0x10FFFF)
+                            break;
+                        codePoint = codePoint * (hex ? 16 : 10) + digit;
+                    }
+                    appendUTF8(_scratch, codePoint);
+                }
+                else
+                    _scratch.append(amp, semicolon + 1);
+
+                begin = semicolon + 1;
+            }
+        }
+
+        // Reads the text of an element up to its closing tag. Plain text is handed out in place,
+        // entities and CDATA sections go through _scratch.
+        bool readText(const char* name, size_t nameLength, const char** text, size_t* length)
+        {
+            const char* start = _p;
+            bool inPlace = true;
+
+            for (;;)
+            {
+                const char* lt = static_cast<const char*>(memchr(_p, '<', _end - _p));
+                if (lt == nullptr)
+                    return false;
+
+                bool cdata = startsWith(lt, "<![CDATA[", 9);
+                if (inPlace && (cdata || memchr(_p, '&', lt - _p) != nullptr))
+                {
+                    inPlace = false;
+                    _scratch.clear();
+                }
+                if (!inPlace)
+                    appendUnescaped(_p, lt);
+
+                if (!cdata)
+                {
+                    *text = inPlace ? start : _scratch.data();
+                    *length = inPlace ? static_cast<size_t>(lt - start) : _scratch.size();
+                    _p = lt;
+                    break;
+                }
+
+                const char* cdataEnd = find(lt + 9, "]]>", 3);
+                if (cdataEnd == nullptr)
+                    return false;
+                _scratch.append(lt + 9, cdataEnd);
+                _p = cdataEnd + 3;
+            }
+
+            return expectClosingTag(name, nameLength);
+        }
+
+        bool readNumberText(const char* name, size_t nameLength, char* buffer, size_t bufferSize)
+        {
+            const char* text = nullptr;
+            size_t length = 0;
+            if (!readText(name, nameLength, &text, &length))
+                return false;
+
+            length = std::min(length, bufferSize - 1);
+            memcpy(buffer, text, length);
+            buffer[length] = '\0';
+            return true;
+        }
+
+        bool skipElement(const char* name, size_t nameLength)
+        {
+            int depth = 1;
+            while (depth > 0)
+            {
+                const char* tagName = nullptr;
+                size_t tagLength = 0;
+                bool closing = false, selfClosing = false;
+                if (!nextTag(&tagName, &tagLength, &closing, &selfClosing))
+                    return false;
+                if (closing)
+                    --depth;
+                else if (!selfClosing)
+                    ++depth;
+                if (depth == 0 && !tagIs(tagName, tagLength, name, nameLength))
+                    return false;
+            }
+            return true;
+        }
+
+        bool parseElement(const char* name, size_t nameLength, bool selfClosing, int depth)
+        {
+            if (depth > MAX_PLIST_DEPTH)
+                return false;
+
+            if (PLIST_TAG_IS(name, nameLength, "dict"))
+            {
+                _visitor->startDict();
+                if (!selfClosing && !parseChildren(name, nameLength, depth))
+                    return false;
+                _visitor->endDict();
+            }
+            else if (PLIST_TAG_IS(name, nameLength, "array"))
+            {
+                _visitor->startArray();
+                if (!selfClosing && !parseChildren(name, nameLength, depth))
+                    return false;
+                _visitor->endArray();
+            }
+            else if (PLIST_TAG_IS(name, nameLength, "string") || PLIST_TAG_IS(name, nameLength, "key"))
+            {
+                const char* text = "";
+                size_t length = 0;
+                if (!selfClosing && !readText(name, nameLength, &text, &length))
+                    return false;
+
+                if (nameLength == 3)
+                    _visitor->key(text, length);
+                else
+                    _visitor->stringValue(text, length);
+            }
+            else if (PLIST_TAG_IS(name, nameLength, "integer"))
+            {
+                char number[64] = "";
+                if (!selfClosing && !readNumberText(name, nameLength, number, sizeof(number)))
+                    return false;
+                _visitor->integerValue(strtoll(number, nullptr, 10));
+            }
+            else if (PLIST_TAG_IS(name, nameLength, "real"))
+            {
+                char number[64] = "";
+                if (!selfClosing && !readNumberText(name, nameLength, number, sizeof(number)))
+                    return false;
+                _visitor->realValue(strtod(number, nullptr));
+            }
+            else if (PLIST_TAG_IS(name, nameLength, "true") || PLIST_TAG_IS(name, nameLength, "false"))
+            {
+                if (!selfClosing && !skipElement(name, nameLength))
+                    return false;
+                _visitor->boolValue(nameLength == 4);
+            }
+            else if (!selfClosing)
+            {
+                // <date>, <data> and anything unknown
+                return skipElement(name, nameLength);
+            }
+            return true;
+        }
+
+        bool parseChildren(const char* name, size_t nameLength, int depth)
+        {
+            for (;;)
+            {
+                const char* childName = nullptr;
+                size_t childLength = 0;
+                bool closing = false, selfClosing = false;
+                if (!nextTag(&childName, &childLength, &closing, &selfClosing))
+                    return false;
+
+                if (closing)
+                    return tagIs(childName, childLength, name, nameLength);
+
+                if (!parseElement(childName, childLength, selfClosing, depth + 1))
+                    return false;
+            }
+        }
+
+        const char* _p;
+        const char* _end;
+        PlistVisitor* _visitor;
+        std::string _scratch;
+    };
+
+    class BinaryPlistReader
+    {
+    public:
+        BinaryPlistReader(const unsigned char* data, size_t length, PlistVisitor* visitor)
+        : _data(data)
+        , _length(length)
+        , _visitor(visitor)
+        , _offsetSize(0)
+        , _refSize(0)
+        , _objectCount(0)
+        , _offsetTable(0)
+        , _visitsLeft(0)
+        {
+        }
+
+        bool parse()
+        {
+            static const size_t HEADER_SIZE = 8;
+            static const size_t TRAILER_SIZE = 32;
+            if (_length < HEADER_SIZE + TRAILER_SIZE)
+                return false;
+
+            const unsigned char* trailer = _data + _length - TRAILER_SIZE;
+            _offsetSize = trailer[6];
+            _refSize = trailer[7];
+            _objectCount = readBigEndian(trailer + 8, 8);
+            uint64_t topObject = readBigEndian(trailer + 16, 8);
+            _offsetTable = readBigEndian(trailer + 24, 8);
+
+            if (_offsetSize == 0 || _offsetSize > 8 || _refSize == 0 || _refSize > 8)
+                return false;
+            // The objects lie between the header and the offset table, which ends at the trailer
+            if (_offsetTable < HEADER_SIZE || _offsetTable > _length - TRAILER_SIZE
+                || _objectCount > (_length - TRAILER_SIZE - _offsetTable) / _offsetSize)
+                return false;
+            if (topObject >= _objectCount)
+                return false;
+
+            // Objects may be referenced several times, so a file of shared containers could expand
+            // exponentially. A tree visits each reference of the object area at most once.
+            _visitsLeft = 1 + _offsetTable / _refSize;
+            return visitObject(topObject, 0);
+        }
+
+    private:
+        static uint64_t readBigEndian(const unsigned char* p, size_t size)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; ++i)
+                value = (value << 8) | p[i];
+            return value;
+        }
+
+        bool objectOffset(uint64_t ref, size_t* offset) const
+        {
+            if (ref >= _objectCount)
+                return false;
+            uint64_t value = readBigEndian(_data + _offsetTable + ref * _offsetSize, _offsetSize);
+            if (value < 8 || value >= _offsetTable)
+                return false;
+            *offset = static_cast<size_t>(value);
+            return true;
+        }
+
+        // Makes sure size bytes starting at pos lie in the object area
+        bool available(size_t pos, uint64_t size) const
+        {
+            return pos <= _offsetTable && size <= _offsetTable - pos;
+        }
+
+        bool readCount(unsigned char marker, size_t* pos, uint64_t* count) const
+        {
+            *count = marker & 0x0F;
+            if (*count != 0x0F)
+                return true;
+
+            // The count doesn't fit in the marker and follows as an integer object
+            if (!available(*pos, 1) || (_data[*pos] & 0xF0) != 0x10)
+                return false;
+            size_t size = size_t(1) << (_data[*pos] & 0x0F);
+            if (size > 8 || !available(*pos + 1, size))
+                return false;
+            *count = readBigEndian(_data + *pos + 1, size);
+            *pos += 1 + size;
+            return true;
+        }
+
+        // Reads an ASCII or UTF-16 string object. ASCII strings are handed out in place.
+        bool readString(unsigned char marker, size_t pos, const char** text, size_t* length)
+        {
+            uint64_t count = 0;
+            if (!readCount(marker, &pos, &count))
+                return false;
+
+            if ((marker & 0xF0) == 0x50)
+            {
+                if (!available(pos, count))
+                    return false;
+                *text = reinterpret_cast<const char*>(_data + pos);
+                *length = static_cast<size_t>(count);
+                return true;
+            }
+
+            if (count > _offsetTable / 2 || !available(pos, count * 2))
+                return false;
+
+            std::u16string utf16(static_cast<size_t>(count), u'\0');
+            for (size_t i = 0; i < count; ++i)
+                utf16[i] = static_cast<char16_t>((_data[pos + i * 2] << 8) | _data[pos + i * 2 + 1]);
+
+            _scratch.clear();
+            if (!StringUtils::UTF16ToUTF8(utf16, _scratch))
+                return false;
+            *text = _scratch.data();
+            *length = _scratch.size();
+            return true;
+        }
+
+        bool visitObject(uint64_t ref, int depth)
+        {
+            size_t pos = 0;
+            if (depth > MAX_PLIST_DEPTH || _visitsLeft == 0 || !objectOffset(ref, &pos))
+                return false;
+            --_visitsLeft;
+
+            unsigned char marker = _data[pos++];
+            switch (marker & 0xF0)
+            {
+            case 0x00:
+                if (marker == 0x08 || marker == 0x09)
+                    _visitor->boolValue(marker == 0x09);
+                return true;
+
+            case 0x10:
+            {
+                size_t size = size_t(1) << (marker & 0x0F);
+                if (size > 16 || !available(pos, size))
+                    return false;
+                // 16 byte integers only carry unsigned 64 bit values in their low half
+                if (size == 16)
+                    pos += 8, size = 8;
+                _visitor->integerValue(static_cast<long long>(readBigEndian(_data + pos, size)));
+                return true;
+            }
+
+            case 0x20:
+            {
+                size_t size = size_t(1) << (marker & 0x0F);
+                if ((size != 4 && size != 8) || !available(pos, size))
+                    return false;
+                uint64_t bits = readBigEndian(_data + pos, size);
+                if (size == 4)
+                {
+                    uint32_t bits32 = static_cast<uint32_t>(bits);
+                    float value;
+                    memcpy(&value, &bits32, sizeof(value));
+                    _visitor->realValue(value);
+                }
+                else
+                {
+                    double value;
+                    memcpy(&value, &bits, sizeof(value));
+                    _visitor->realValue(value);
+                }
+                return true;
+            }
+
+            case 0x50:
+            case 0x60:
+            {
+                const char* text = nullptr;
+                size_t length = 0;
+                if (!readString(marker, pos, &text, &length))
+                    return false;
+                _visitor->stringValue(text, length);
+                return true;
+            }
+
+            case 0xA0:
+            {
+                uint64_t count = 0;
+                if (!readCount(marker, &pos, &count) || count > _objectCount || !available(pos, count * _refSize))
+                    return false;
+
+                _visitor->startArray();
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    if (!visitObject(readBigEndian(_data + pos + i * _refSize, _refSize), depth + 1))
+                        return false;
+                }
+                _visitor->endArray();
+                return true;
+            }
+
+            case 0xD0:
+            {
+                uint64_t count = 0;
+                if (!readCount(marker, &pos, &count) || count > _objectCount || !available(pos, count * 2 * _refSize))
+                    return false;
+
+                _visitor->startDict();
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    size_t keyPos = 0;
+                    if (!objectOffset(readBigEndian(_data + pos + i * _refSize, _refSize), &keyPos))
+                        return false;
+
+                    unsigned char keyMarker = _data[keyPos];
+                    const char* key = nullptr;
+                    size_t keyLength = 0;
+                    if (((keyMarker & 0xF0) != 0x50 && (keyMarker & 0xF0) != 0x60)
+                        || !readString(keyMarker, keyPos + 1, &key, &keyLength))
+                        return false;
+                    _visitor->key(key, keyLength);
+
+                    if (!visitObject(readBigEndian(_data + pos + (count + i) * _refSize, _refSize), depth + 1))
+                        return false;
+                }
+                _visitor->endDict();
+                return true;
+            }
+
+            case 0x30: // date
+            case 0x40: // data
+            case 0x80: // uid
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        const unsigned char* _data;
+        size_t _length;
+        PlistVisitor* _visitor;
+        size_t _offsetSize;
+        size_t _refSize;
+        uint64_t _objectCount;
+        uint64_t _offsetTable;
+        uint64_t _visitsLeft;
+        std::string _scratch;
+    };
+
+    // Builds the Value tree FileUtils::getValueMapFromFile() always returned
+    class ValueBuilder : public PlistVisitor
+    {
+    public:
+        Value root;
+
+        virtual void startDict() override { add(Value(ValueMap()), true); }
+        virtual void endDict() override { _containers.pop_back(); }
+        virtual void startArray() override { add(Value(ValueVector()), true); }
+        virtual void endArray() override { _containers.pop_back(); }
+
+        virtual void key(const char* key, size_t length) override { _key.assign(key, length); }
+        virtual void stringValue(const char* value, size_t length) override { add(Value(value, length), false); }
+        virtual void integerValue(long long value) override { add(Value(static_cast<int>(value)), false); }
+        virtual void realValue(double value) override { add(Value(value), false); }
+        virtual void boolValue(bool value) override { add(Value(value), false); }
+
+    private:
+        void add(Value&& value, bool isContainer)
+        {
+            Value* slot = nullptr;
+            if (_containers.empty())
+            {
+                root = std::move(value);
+                slot = &root;
+            }
+            else if (_containers.back()->getType() == Value::Type::MAP)
+            {
+                slot = &_containers.back()->asValueMap()[_key];
+                *slot = std::move(value);
+            }
+            else
+            {
+                auto& vector = _containers.back()->asValueVector();
+                vector.push_back(std::move(value));
+                slot = &vector.back();
+            }
+
+            // A container only grows while it is on top, so pointers to its parents' elements stay valid
+            if (isContainer)
+                _containers.push_back(slot);
+        }
+
+        std::vector<Value*> _containers;
+        std::string _key;
+    };
+}
+
+bool PlistParser::isBinary(const char* data, size_t length)
+{
+    return length >= 8 && memcmp(data, "bplist00", 8) == 0;
+}
+
+bool PlistParser::parse(const char* data, size_t length, PlistVisitor* visitor)
+{
+    CCASSERT(visitor, "visitor can't be nullptr");
+    if (data == nullptr || length == 0)
+        return false;
+
+    if (isBinary(data, length))
+    {
+        BinaryPlistReader reader(reinterpret_cast<const unsigned char*>(data), length, visitor);
+        return reader.parse();
+    }
+
+    XmlPlistReader reader(data, length, visitor);
+    return reader.parse();
+}
+
+bool PlistParser::parseFile(const std::string& fullPath, PlistVisitor* visitor)
+{
+    auto fileUtils = FileUtils::getInstance();
+
+    ArchivedFileView archived;
+    if (fileUtils->getArchivedFileView(fullPath, &archived))
+        return parse(reinterpret_cast<const char*>(archived.getBytes()), static_cast<size_t>(archived.getSize()), visitor);
+
+    Data data;
+    if (fileUtils->getContents(fullPath, &data) != FileUtils::Status::OK)
+        return false;
+    return parse(reinterpret_cast<const char*>(data.getBytes()), static_cast<size_t>(data.getSize()), visitor);
+}
+
+ValueMap PlistParser::getValueMap(const char* data, size_t length)
+{
+    ValueArena arena;
+    ValueBuilder builder;
+    if (!parse(data, length, &builder) || builder.root.getType() != Value::Type::MAP)
+        return ValueMap();
+    return std::move(builder.root.asValueMap());
+}
+
+ValueMap PlistParser::getValueMapFromFile(const std::string& fullPath)
+{
+    ValueArena arena;
+    ValueBuilder builder;
+    if (!parseFile(fullPath, &builder) || builder.root.getType() != Value::Type::MAP)
+        return ValueMap();
+    return std::move(builder.root.asValueMap());
+}
+
+ValueVector PlistParser::getValueVectorFromFile(const std::string& fullPath)
+{
+    ValueArena arena;
+    ValueBuilder builder;
+    if (!parseFile(fullPath, &builder) || builder.root.getType() != Value::Type::VECTOR)
+        return ValueVector();
+    return std::move(builder.root.asValueVector());
+}
+
+NS_CC_END
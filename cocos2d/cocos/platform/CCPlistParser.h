@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PLISTPARSER_H__
+#define __CC_PLISTPARSER_H__
+
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCValue.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * Receives the contents of a property list while PlistParser walks it.
+ *
+ * Containers are reported as start/end pairs, and inside a dictionary every value
+ * is preceded by its key. Strings and keys are views that are only valid during the
+ * call: they point straight into the parsed buffer unless the text had to be
+ * unescaped or converted from UTF-16. Dates and data blobs are skipped.
+ *
+ * @since v3.17
+ */
+class CC_DLL PlistVisitor
+{
+public:
+    virtual ~PlistVisitor() {}
+
+    virtual void startDict() {}
+    virtual void endDict() {}
+    virtual void startArray() {}
+    virtual void endArray() {}
+
+    virtual void key(const char* /*key*/, size_t /*length*/) {}
+    virtual void stringValue(const char* /*value*/, size_t /*length*/) {}
+    virtual void integerValue(long long /*value*/) {}
+    virtual void realValue(double /*value*/) {}
+    virtual void boolValue(bool /*value*/) {}
+};
+
+/**
+ * Streams XML and binary ("bplist00") property lists into a PlistVisitor.
+ *
+ * Neither format goes through an intermediate document: the XML reader scans the
+ * buffer in place and the binary reader follows the object table.
+ *
+ * @since v3.17
+ */
+class CC_DLL PlistParser
+{
+public:
+    /** Returns true if the buffer holds a binary property list. */
+    static bool isBinary(const char* data, size_t length);
+
+    /**
+     * Parses a property list held in memory.
+     *
+     * @return false if the property list is malformed. The visitor may have seen part of it.
+     */
+    static bool parse(const char* data, size_t length, PlistVisitor* visitor);
+
+    /**
+     * Parses a property list file. Files in a mounted archive are parsed without being copied.
+     *
+     * @param fullPath The full path of the file.
+     * @return false if the file is missing or malformed.
+     */
+    static bool parseFile(const std::string& fullPath, PlistVisitor* visitor);
+
+    /** Builds a ValueMap from a property list whose root is a dictionary. */
+    static ValueMap getValueMap(const char* data, size_t length);
+
+    /** Builds a ValueMap from a property list file whose root is a dictionary. */
+    static ValueMap getValueMapFromFile(const std::string& fullPath);
+
+    /** Builds a ValueVector from a property list file whose root is an array. */
+    static ValueVector getValueVectorFromFile(const std::string& fullPath);
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __CC_PLISTPARSER_H__
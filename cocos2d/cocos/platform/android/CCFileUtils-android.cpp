@@ -290,6 +290,9 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
 
     string fullPath = fullPathForFilename(filename);
 
+    if (readArchivedFile(fullPath, buffer))
+        return FileUtils::Status::OK;
+
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
 
@@ -454,14 +454,26 @@ ValueVector FileUtilsApple::getValueVectorFromFile(const std::string& filename)
     //    pPath = [[NSBundle mainBundle] pathForResource:pPath ofType:pathExtension];
     //    fixing cannot read data using Array::createWithContentsOfFile
     std::string fullPath = fullPathForFilename(filename);
-    NSString* path = [NSString stringWithUTF8String:fullPath.c_str()];
-    NSArray* array = [NSArray arrayWithContentsOfFile:path];
 
+    // read through getDataFromFile() like getValueMapFromFile(), so the plists of the mounted archives are found
+    Data data = getDataFromFile(fullPath);
     ValueVector ret;
+    if (data.isNull())
+    {
+        return ret;
+    }
+
+    NSData* file = [NSData dataWithBytes:data.getBytes() length:data.getSize()];
+    NSPropertyListFormat format;
+    NSError* error;
+    id plist = [NSPropertyListSerialization propertyListWithData:file options:NSPropertyListImmutable format:&format error:&error];
 
-    for (id value in array)
+    if ([plist isKindOfClass:[NSArray class]])
     {
-        addNSObjectToCCVector(value, ret);
+        for (id value in (NSArray*)plist)
+        {
+            addNSObjectToCCVector(value, ret);
+        }
     }
 
     return ret;
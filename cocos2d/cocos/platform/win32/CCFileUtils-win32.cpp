@@ -123,6 +123,12 @@ std::string FileUtilsWin32::getSuitableFOpen(const std::string& filenameUtf8) co
 
 long FileUtilsWin32::getFileSize(const std::string &filepath)
 {
+    ssize_t archivedSize = 0;
+    if (findArchivedFile(filepath, nullptr, &archivedSize))
+    {
+        return (long)archivedSize;
+    }
+
     WIN32_FILE_ATTRIBUTE_DATA fad;
     if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
     {
@@ -173,6 +179,9 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    if (readArchivedFile(fullPath, buffer))
+        return FileUtils::Status::OK;
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -133,6 +133,12 @@ std::string CCFileUtilsWinRT::getSuitableFOpen(const std::string& filenameUtf8)
 
 long CCFileUtilsWinRT::getFileSize(const std::string &filepath)
 {
+    ssize_t archivedSize = 0;
+    if (findArchivedFile(filepath, nullptr, &archivedSize))
+    {
+        return (long)archivedSize;
+    }
+
     WIN32_FILE_ATTRIBUTE_DATA fad;
     if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
     {
@@ -152,6 +158,9 @@ FileUtils::Status CCFileUtilsWinRT::getContents(const std::string& filename, Res
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    if (readArchivedFile(fullPath, buffer))
+        return FileUtils::Status::OK;
+
     HANDLE fileHandle = ::CreateFile2(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -0,0 +1,418 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "renderer/CCDynamicAtlas.h"
+
+#include <algorithm>
+
+#include "2d/CCSpriteFrame.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // transparent border around each image, with the edge texels repeated, so the linear filtering
+    // doesn't sample the neighbouring images
+    const int REGION_PADDING = 1;
+    const int BYTES_PER_TEXEL = 4;
+}
+
+DynamicAtlas::DynamicAtlas(int pageSize, int maxPageCount)
+: _pageSize(pageSize)
+, _maxPageCount(maxPageCount)
+, _maxRegionSize(256)
+, _clock(0)
+, _hitCount(0)
+, _rejectCount(0)
+, _evictionCount(0)
+{
+    CCASSERT(pageSize > 0 && maxPageCount > 0, "Invalid page size or count");
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    removeAll();
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    if (fullpath.empty())
+        return nullptr;
+
+    auto it = _regions.find(fullpath);
+    if (it != _regions.end())
+    {
+        it->second->lastUsed = ++_clock;
+        ++_hitCount;
+        return it->second->frame;
+    }
+
+    Region* region = nullptr;
+    Image* image = new (std::nothrow) Image();
+    if (image && image->initWithImageFile(fullpath))
+    {
+        region = pack(fullpath, image);
+    }
+    CC_SAFE_RELEASE(image);
+
+    if (!region)
+    {
+        ++_rejectCount;
+        return nullptr;
+    }
+    return region->frame;
+}
+
+DynamicAtlas::Region* DynamicAtlas::pack(const std::string& key, Image* image)
+{
+    // compressed textures and formats other than RGBA8888 keep their own texture
+    if (image->isCompressed() || image->getRenderFormat() != Texture2D::PixelFormat::RGBA8888)
+        return nullptr;
+    if (image->getWidth() > _maxRegionSize || image->getHeight() > _maxRegionSize)
+        return nullptr;
+
+    const bool premultipliedAlpha = image->hasPremultipliedAlpha();
+    const int width = image->getWidth() + REGION_PADDING * 2;
+    const int height = image->getHeight() + REGION_PADDING * 2;
+    if (width > _pageSize || height > _pageSize)
+        return nullptr;
+
+    Page* target = nullptr;
+    Slot slot;
+    for (auto page : _pages)
+    {
+        if (page->premultipliedAlpha == premultipliedAlpha && allocate(page, width, height, &slot))
+        {
+            target = page;
+            break;
+        }
+    }
+
+    if (!target && (int)_pages.size() < _maxPageCount)
+    {
+        Page* page = createPage(premultipliedAlpha);
+        if (page && allocate(page, width, height, &slot))
+            target = page;
+    }
+
+    // evict the least recently used regions until the image fits
+    while (!target)
+    {
+        Region* victim = nullptr;
+        for (const auto& iter : _regions)
+        {
+            Region* region = iter.second;
+            if (isEvictable(region) && (!victim || region->lastUsed < victim->lastUsed))
+                victim = region;
+        }
+        if (!victim)
+            break;
+
+        Page* page = victim->page;
+        evict(victim);
+
+        if (page->regionCount == 0 && page->premultipliedAlpha != premultipliedAlpha)
+        {
+            // an empty page can't change its alpha mode, replace it
+            _pages.erase(std::find(_pages.begin(), _pages.end(), page));
+            destroyPage(page);
+            page = createPage(premultipliedAlpha);
+            if (!page)
+                break;
+        }
+
+        if (page->premultipliedAlpha == premultipliedAlpha && allocate(page, width, height, &slot))
+            target = page;
+    }
+
+    if (!target)
+        return nullptr;
+
+    upload(target, slot, image);
+
+    Rect rect((float)(slot.x + REGION_PADDING), (float)(slot.y + REGION_PADDING), (float)image->getWidth(), (float)image->getHeight());
+    SpriteFrame* frame = SpriteFrame::createWithTexture(target->texture, CC_RECT_PIXELS_TO_POINTS(rect));
+    frame->retain();
+
+    Region* region = new (std::nothrow) Region();
+    region->key = key;
+    region->frame = frame;
+    region->page = target;
+    region->x = slot.x;
+    region->y = slot.y;
+    region->width = slot.width;
+    region->height = slot.height;
+    region->lastUsed = ++_clock;
+    ++target->regionCount;
+    _regions.emplace(key, region);
+
+    return region;
+}
+
+bool DynamicAtlas::allocate(Page* page, int width, int height, Slot* slot)
+{
+    // reuse the smallest slot of an evicted region where the image fits, splitting the rest
+    auto bestSlot = page->freeSlots.end();
+    for (auto it = page->freeSlots.begin(); it != page->freeSlots.end(); ++it)
+    {
+        if (it->width >= width && it->height >= height &&
+            (bestSlot == page->freeSlots.end() || it->width * it->height < bestSlot->width * bestSlot->height))
+        {
+            bestSlot = it;
+        }
+    }
+    if (bestSlot != page->freeSlots.end())
+    {
+        const Slot freeSlot = *bestSlot;
+        page->freeSlots.erase(bestSlot);
+        *slot = {freeSlot.x, freeSlot.y, width, height};
+        if (freeSlot.width > width)
+            page->freeSlots.push_back({freeSlot.x + width, freeSlot.y, freeSlot.width - width, freeSlot.height});
+        if (freeSlot.height > height)
+            page->freeSlots.push_back({freeSlot.x, freeSlot.y + height, width, freeSlot.height - height});
+        return true;
+    }
+
+    // else the lowest shelf with room for it
+    Shelf* bestShelf = nullptr;
+    for (auto& shelf : page->shelves)
+    {
+        if (shelf.height >= height && shelf.usedWidth + width <= _pageSize &&
+            (!bestShelf || shelf.height < bestShelf->height))
+        {
+            bestShelf = &shelf;
+        }
+    }
+    if (bestShelf)
+    {
+        *slot = {bestShelf->usedWidth, bestShelf->y, width, height};
+        bestShelf->usedWidth += width;
+        return true;
+    }
+
+    // else a new shelf
+    if (page->nextShelfY + height <= _pageSize)
+    {
+        page->shelves.push_back({page->nextShelfY, height, width});
+        *slot = {0, page->nextShelfY, width, height};
+        page->nextShelfY += height;
+        return true;
+    }
+
+    return false;
+}
+
+void DynamicAtlas::upload(Page* page, const Slot& slot, Image* image)
+{
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    const unsigned char* src = image->getData();
+    const int srcStride = width * BYTES_PER_TEXEL;
+    const int dstStride = slot.width * BYTES_PER_TEXEL;
+
+    // copy the image in the middle of the slot, repeating the edges in the padding
+    std::vector<unsigned char> texels(dstStride * slot.height);
+    for (int y = 0; y < slot.height; ++y)
+    {
+        const int srcY = std::min(std::max(y - REGION_PADDING, 0), height - 1);
+        const unsigned char* srcRow = src + srcY * srcStride;
+        unsigned char* dstRow = texels.data() + y * dstStride;
+        for (int x = 0; x < REGION_PADDING; ++x)
+        {
+            memcpy(dstRow + x * BYTES_PER_TEXEL, srcRow, BYTES_PER_TEXEL);
+            memcpy(dstRow + (REGION_PADDING + width + x) * BYTES_PER_TEXEL, srcRow + srcStride - BYTES_PER_TEXEL, BYTES_PER_TEXEL);
+        }
+        memcpy(dstRow + REGION_PADDING * BYTES_PER_TEXEL, srcRow, srcStride);
+    }
+
+    page->texture->updateWithData(texels.data(), slot.x, slot.y, slot.width, slot.height);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    unsigned char* pageTexels = page->image->getData();
+    for (int y = 0; y < slot.height; ++y)
+    {
+        memcpy(pageTexels + ((slot.y + y) * _pageSize + slot.x) * BYTES_PER_TEXEL, texels.data() + y * dstStride, dstStride);
+    }
+#endif
+}
+
+DynamicAtlas::Page* DynamicAtlas::createPage(bool premultipliedAlpha)
+{
+    const ssize_t dataLen = (ssize_t)_pageSize * _pageSize * BYTES_PER_TEXEL;
+    unsigned char* texels = (unsigned char*)calloc(dataLen, 1);
+    if (!texels)
+        return nullptr;
+
+    Image* image = new (std::nothrow) Image();
+    Texture2D* texture = nullptr;
+    if (image && image->initWithRawData(texels, dataLen, _pageSize, _pageSize, 8, premultipliedAlpha))
+    {
+        texture = new (std::nothrow) Texture2D();
+        if (texture && !texture->initWithImage(image, Texture2D::PixelFormat::RGBA8888))
+        {
+            CC_SAFE_RELEASE_NULL(texture);
+        }
+    }
+    free(texels);
+
+    if (!texture)
+    {
+        CCLOG("cocos2d: DynamicAtlas: couldn't create a page of %d x %d", _pageSize, _pageSize);
+        CC_SAFE_RELEASE(image);
+        return nullptr;
+    }
+
+    Page* page = new (std::nothrow) Page();
+    page->texture = texture;
+    page->premultipliedAlpha = premultipliedAlpha;
+    page->nextShelfY = 0;
+    page->regionCount = 0;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    page->image = image;
+    VolatileTextureMgr::addImage(texture, image);
+#else
+    image->release();
+#endif
+    _pages.push_back(page);
+
+    return page;
+}
+
+void DynamicAtlas::resetPage(Page* page)
+{
+    // the old texels are overwritten by the next uploads, no need to clear them
+    page->shelves.clear();
+    page->freeSlots.clear();
+    page->nextShelfY = 0;
+}
+
+void DynamicAtlas::destroyPage(Page* page)
+{
+    // the sprites that still use the page retain its texture
+    page->texture->release();
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    page->image->release();
+#endif
+    delete page;
+}
+
+bool DynamicAtlas::isEvictable(const Region* region) const
+{
+    // the sprites retain their sprite frame
+    return region->frame->getReferenceCount() == 1;
+}
+
+void DynamicAtlas::evict(Region* region)
+{
+    Page* page = region->page;
+    page->freeSlots.push_back({region->x, region->y, region->width, region->height});
+    if (--page->regionCount == 0)
+    {
+        resetPage(page);
+    }
+
+    region->frame->release();
+    _regions.erase(region->key);
+    delete region;
+    ++_evictionCount;
+}
+
+void DynamicAtlas::removeUnusedRegions()
+{
+    std::vector<Region*> unused;
+    for (const auto& iter : _regions)
+    {
+        if (isEvictable(iter.second))
+            unused.push_back(iter.second);
+    }
+    for (auto region : unused)
+    {
+        evict(region);
+    }
+}
+
+void DynamicAtlas::removeAll()
+{
+    for (auto& iter : _regions)
+    {
+        iter.second->frame->release();
+        delete iter.second;
+    }
+    _regions.clear();
+
+    for (auto page : _pages)
+    {
+        destroyPage(page);
+    }
+    _pages.clear();
+}
+
+DynamicAtlas::Stats DynamicAtlas::getStats() const
+{
+    Stats stats;
+    stats.pageCount = (int)_pages.size();
+    stats.regionCount = (int)_regions.size();
+    stats.hitCount = _hitCount;
+    stats.rejectCount = _rejectCount;
+    stats.evictionCount = _evictionCount;
+    stats.usedTexels = 0;
+    for (const auto& iter : _regions)
+    {
+        stats.usedTexels += iter.second->width * iter.second->height;
+    }
+    stats.totalTexels = (uint32_t)(_pages.size() * _pageSize * _pageSize);
+    stats.savedTextureCount = std::max(stats.regionCount - stats.pageCount, 0);
+    return stats;
+}
+
+size_t DynamicAtlas::getMemoryUsage() const
+{
+    size_t usage = 0;
+    for (const auto& page : _pages)
+    {
+        if (page->texture)
+        {
+            usage += page->texture->getMemorySize();
+        }
+    }
+    return usage;
+}
+
+std::string DynamicAtlas::getDescription() const
+{
+    Stats stats = getStats();
+    return StringUtils::format("<DynamicAtlas | %d images in %d pages of %d x %d (%.1f%% used), %d textures saved, %u hits, %u rejected, %u evicted>",
+                               stats.regionCount, stats.pageCount, _pageSize, _pageSize,
+                               stats.totalTexels ? stats.usedTexels * 100.0f / stats.totalTexels : 0.0f,
+                               stats.savedTextureCount, stats.hitCount, stats.rejectCount, stats.evictionCount);
+}
+
+NS_CC_END
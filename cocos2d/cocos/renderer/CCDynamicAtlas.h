@@ -0,0 +1,181 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCDYNAMICATLAS_H__
+#define __CCDYNAMICATLAS_H__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Image;
+class SpriteFrame;
+class Texture2D;
+
+/** @class DynamicAtlas
+ * @brief Packs small image files into shared textures at load time.
+ *
+ * Every texture is a different material, so sprites created from individual image files can't be batched
+ * together. The dynamic atlas copies the small images into a few big textures (pages), and returns a
+ * SpriteFrame of the page instead, so the sprites that use them share the texture and are drawn in a
+ * single batch.
+ *
+ * Only uncompressed images with alpha (RGBA8888) that are not bigger than the max region size are packed,
+ * the others are left to the TextureCache. When the pages are full, the least recently used regions that
+ * are not referenced by any sprite are evicted to make room, and a page is repacked from scratch once all
+ * its regions are gone.
+ *
+ * It is enabled with TextureCache::setDynamicAtlasEnabled() and used by Sprite::initWithFile().
+ * @since v3.17
+ */
+class CC_DLL DynamicAtlas
+{
+public:
+    /** Statistics of the atlas. */
+    struct Stats
+    {
+        /** Number of pages (textures) in use. */
+        int pageCount;
+        /** Number of images packed in the pages. */
+        int regionCount;
+        /** Number of requests served from an already packed image. */
+        uint32_t hitCount;
+        /** Number of images that couldn't be packed and were left to the TextureCache. */
+        uint32_t rejectCount;
+        /** Number of regions evicted to make room for other images. */
+        uint32_t evictionCount;
+        /** Number of texels used by the packed images, and available in the pages. */
+        uint32_t usedTexels;
+        uint32_t totalTexels;
+        /** Number of textures (and so materials and batches) saved by sharing the pages: regionCount - pageCount. */
+        int savedTextureCount;
+    };
+
+    /**
+     * @param pageSize Width and height of the pages, in pixels.
+     * @param maxPageCount Max number of pages before evicting regions.
+     */
+    DynamicAtlas(int pageSize = 1024, int maxPageCount = 4);
+    ~DynamicAtlas();
+
+    /** Returns a sprite frame of the image file packed in a page, packing it if needed.
+     * Returns nullptr if the image can't be packed, then the caller should fall back to TextureCache::addImage().
+     * The frame is owned by the atlas, and retained by the sprites that use it: a region isn't evicted while
+     * its frame is retained by someone else.
+     */
+    SpriteFrame* getSpriteFrame(const std::string& filename);
+
+    /** Removes the regions whose frame isn't used anymore, and resets the empty pages. */
+    void removeUnusedRegions();
+    /** Releases all the pages and regions. The sprites keep the pages they already use. */
+    void removeAll();
+
+    /** Images bigger than this size, in pixels, are not packed. Defaults to 256. */
+    void setMaxRegionSize(int size) { _maxRegionSize = size; }
+    int getMaxRegionSize() const { return _maxRegionSize; }
+    int getPageSize() const { return _pageSize; }
+    int getMaxPageCount() const { return _maxPageCount; }
+
+    /** Returns the statistics of the atlas. */
+    Stats getStats() const;
+    /** Returns the memory used by the pages, in bytes. */
+    size_t getMemoryUsage() const;
+    /** Returns the statistics of the atlas as a string, for logging. */
+    std::string getDescription() const;
+
+protected:
+    struct Page;
+
+    struct Region
+    {
+        std::string key;
+        SpriteFrame* frame;
+        Page* page;
+        // slot in the page, including the padding
+        int x, y, width, height;
+        uint64_t lastUsed;
+    };
+
+    struct Shelf
+    {
+        int y, height, usedWidth;
+    };
+
+    struct Slot
+    {
+        int x, y, width, height;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        bool premultipliedAlpha;
+        std::vector<Shelf> shelves;
+        // slots of evicted regions, reused by images that fit in them
+        std::vector<Slot> freeSlots;
+        int nextShelfY;
+        int regionCount;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // copy of the texels to restore the page when the GL context is lost
+        Image* image;
+#endif
+    };
+
+    Page* createPage(bool premultipliedAlpha);
+    void resetPage(Page* page);
+    void destroyPage(Page* page);
+    bool allocate(Page* page, int width, int height, Slot* slot);
+    Region* pack(const std::string& key, Image* image);
+    void upload(Page* page, const Slot& slot, Image* image);
+    void evict(Region* region);
+    bool isEvictable(const Region* region) const;
+
+    int _pageSize;
+    int _maxPageCount;
+    int _maxRegionSize;
+    std::vector<Page*> _pages;
+    std::unordered_map<std::string, Region*> _regions;
+    uint64_t _clock;
+    uint32_t _hitCount;
+    uint32_t _rejectCount;
+    uint32_t _evictionCount;
+};
+
+NS_CC_END
+
+// end of _2d group
+/// @}
+
+#endif // __CCDYNAMICATLAS_H__
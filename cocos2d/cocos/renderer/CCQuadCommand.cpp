@@ -114,6 +114,7 @@ void QuadCommand::init(float globalOrder, Texture2D* texture, GLProgramState* gl
 {
     init(globalOrder, texture->getName(), glProgramState, blendType, quads, quadCount, mv, flags);
     _alphaTextureID = texture->getAlphaTextureName();
+    texture->markUsed();
 }
 
 NS_CC_END
\ No newline at end of file
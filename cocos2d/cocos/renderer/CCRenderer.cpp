@@ -45,21 +45,36 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCFrameTracer.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
 
+// Sync objects and glMapBufferRange() are core in desktop OpenGL (or exposed by GLEW),
+// on OpenGL ES 2.0 only the orphaning path is available.
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+#define CC_RENDERER_USE_SYNC_OBJECTS 1
+#else
+#define CC_RENDERER_USE_SYNC_OBJECTS 0
+#endif
+
 NS_CC_BEGIN
 
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
+// Maps a float to an unsigned integer with the same order, so that it can be radix sorted
+static inline uint32_t floatToSortKey(float value)
 {
-    return a->getGlobalOrder() < b->getGlobalOrder();
+    // -0.0 and 0.0 are equal, they must have the same key
+    if (value == 0.0f)
+        value = 0.0f;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    // negative numbers: flip all bits, positive numbers: flip the sign bit
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
-{
-    return  a->getDepth() > b->getDepth();
-}
+// Queues smaller than this are not worth the histogram passes of the radix sort
+static const size_t RADIX_SORT_MIN_SIZE = 64;
 
 // queue
 RenderQueue::RenderQueue()
@@ -67,16 +82,26 @@ RenderQueue::RenderQueue()
     
 }
 
+uint32_t RenderQueue::getSortKey(QUEUE_GROUP group, RenderCommand* command)
+{
+    // transparent 3D objects are drawn back to front
+    if (group == QUEUE_GROUP::TRANSPARENT_3D)
+        return ~floatToSortKey(command->getDepth());
+    return floatToSortKey(command->getGlobalOrder());
+}
+
 void RenderQueue::push_back(RenderCommand* command)
 {
     float z = command->getGlobalOrder();
     if(z < 0)
     {
         _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
+        _sortKeys[QUEUE_GROUP::GLOBALZ_NEG].push_back(floatToSortKey(z));
     }
     else if(z > 0)
     {
         _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
+        _sortKeys[QUEUE_GROUP::GLOBALZ_POS].push_back(floatToSortKey(z));
     }
     else
     {
@@ -85,6 +110,7 @@ void RenderQueue::push_back(RenderCommand* command)
             if(command->isTransparent())
             {
                 _commands[QUEUE_GROUP::TRANSPARENT_3D].push_back(command);
+                _sortKeys[QUEUE_GROUP::TRANSPARENT_3D].push_back(getSortKey(QUEUE_GROUP::TRANSPARENT_3D, command));
             }
             else
             {
@@ -112,9 +138,88 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    sortSubQueue(QUEUE_GROUP::TRANSPARENT_3D);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_NEG);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_POS);
+}
+
+void RenderQueue::sortSubQueue(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    auto& keys = _sortKeys[group];
+    const size_t count = commands.size();
+    if (count < 2)
+        return;
+
+    // commands added directly through getSubQueue() have no key yet
+    if (keys.size() != count)
+    {
+        keys.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            keys[i] = getSortKey(group, commands[i]);
+    }
+
+    _sortItems.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _sortItems[i].key = keys[i];
+        _sortItems[i].command = commands[i];
+    }
+
+    if (count < RADIX_SORT_MIN_SIZE)
+    {
+        std::stable_sort(_sortItems.begin(), _sortItems.end(), [](const SortItem& a, const SortItem& b) {
+            return a.key < b.key;
+        });
+    }
+    else
+    {
+        // LSD radix sort, 8 bits per pass. Every pass is a stable counting sort,
+        // so commands with the same key keep the order in which they were added.
+        size_t histograms[4][256] = {};
+        for (const auto& item : _sortItems)
+        {
+            ++histograms[0][item.key & 0xff];
+            ++histograms[1][(item.key >> 8) & 0xff];
+            ++histograms[2][(item.key >> 16) & 0xff];
+            ++histograms[3][item.key >> 24];
+        }
+
+        _sortScratch.resize(count);
+        SortItem* src = _sortItems.data();
+        SortItem* dst = _sortScratch.data();
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            const int shift = pass * 8;
+            size_t* histogram = histograms[pass];
+
+            // all the keys share this byte: the pass would not move anything
+            if (histogram[(src[0].key >> shift) & 0xff] == count)
+                continue;
+
+            size_t offset = 0;
+            for (int digit = 0; digit < 256; ++digit)
+            {
+                size_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != _sortItems.data())
+            _sortItems.swap(_sortScratch);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = _sortItems[i].key;
+        commands[i] = _sortItems[i].command;
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -138,6 +243,7 @@ void RenderQueue::clear()
     for(int i = 0; i < QUEUE_COUNT; ++i)
     {
         _commands[i].clear();
+        _sortKeys[i].clear();
     }
 }
 
@@ -147,6 +253,7 @@ void RenderQueue::realloc(size_t reserveSize)
     {
         _commands[i] = std::vector<RenderCommand*>();
         _commands[i].reserve(reserveSize);
+        _sortKeys[i] = std::vector<uint32_t>();
     }
 }
 
@@ -199,13 +306,20 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 //
 Renderer::Renderer()
 :_lastBatchedMeshCommand(nullptr)
+,_currentStreamingBuffer(0)
+,_streamingMode(StreamingMode::ORPHANING)
+,_streamVertexBase(0)
+,_streamIndexBase(0)
+,_triBatchesToDrawCapacity(-1)
+,_triBatchesToDraw(nullptr)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_uploadedBytes(0)
+,_lastFrameUploadedBytes(0)
+,_peakUploadedBytes(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
-,_triBatchesToDraw(nullptr)
-,_triBatchesToDrawCapacity(-1)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
 #endif
@@ -224,6 +338,8 @@ Renderer::Renderer()
     // for the batched TriangleCommand
     _triBatchesToDrawCapacity = 500;
     _triBatchesToDraw = (TriBatchToDraw*) malloc(sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
+
+    memset(_streamingBuffers, 0, sizeof(_streamingBuffers));
 }
 
 Renderer::~Renderer()
@@ -231,13 +347,23 @@ Renderer::~Renderer()
     _renderGroups.clear();
     _groupCommandManager->release();
     
-    glDeleteBuffers(2, _buffersVBO);
-
     free(_triBatchesToDraw);
 
+    for (auto& stream : _streamingBuffers)
+    {
+        glDeleteBuffers(2, stream.vbo);
+#if CC_RENDERER_USE_SYNC_OBJECTS
+        if (stream.fence)
+            glDeleteSync((GLsync)stream.fence);
+#endif
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_buffersVAO);
+        for (auto& stream : _streamingBuffers)
+        {
+            glDeleteVertexArrays(1, &stream.vao);
+        }
         GL::bindVAO(0);
     }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -263,7 +389,19 @@ void Renderer::initGLView()
 
 void Renderer::setupBuffer()
 {
-    if(Configuration::getInstance()->supportsShareableVAO())
+    // the previous buffers and fences (if any) died with the GL context
+    memset(_streamingBuffers, 0, sizeof(_streamingBuffers));
+    _currentStreamingBuffer = 0;
+
+    auto conf = Configuration::getInstance();
+#if CC_RENDERER_USE_SYNC_OBJECTS
+    if (CC_RENDERER_STREAMING_BUFFER_COUNT > 1 && conf->supportsMapBufferRange() && conf->supportsSyncObjects())
+        _streamingMode = StreamingMode::RING;
+    else
+#endif
+        _streamingMode = StreamingMode::ORPHANING;
+
+    if(conf->supportsShareableVAO())
     {
         setupVBOAndVAO();
     }
@@ -271,52 +409,63 @@ void Renderer::setupBuffer()
     {
         setupVBO();
     }
+
+    // nothing was allocated yet: the first upload into each buffer of the ring allocates it
+    for (auto& stream : _streamingBuffers)
+    {
+        stream.needsOrphaning = true;
+    }
 }
 
 void Renderer::setupVBOAndVAO()
 {
-    //generate vbo and vao for trianglesCommand
-    glGenVertexArrays(1, &_buffersVAO);
-    GL::bindVAO(_buffersVAO);
+    //generate vbo and vao for trianglesCommand, one of each per streaming buffer
+    for (auto& stream : _streamingBuffers)
+    {
+        glGenVertexArrays(1, &stream.vao);
+        GL::bindVAO(stream.vao);
 
-    glGenBuffers(2, &_buffersVBO[0]);
+        glGenBuffers(2, &stream.vbo[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    // Issue #15652
-    // Should not initialize VBO with a large size (VBO_SIZE=65536),
-    // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
-    // It's probably because some implementations of OpenGLES driver will
-    // copy the whole memory of VBO which initialized at the first time
-    // once glBufferData/glBufferSubData is invoked.
-    // For more discussion, please refer to https://github.com/cocos2d/cocos2d-x/issues/15652
-    //glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.vbo[0]);
+        // Issue #15652
+        // Should not initialize VBO with a large size (VBO_SIZE=65536),
+        // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
+        // It's probably because some implementations of OpenGLES driver will
+        // copy the whole memory of VBO which initialized at the first time
+        // once glBufferData/glBufferSubData is invoked.
+        // For more discussion, please refer to https://github.com/cocos2d/cocos2d-x/issues/15652
+        //glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+        // vertices
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        // colors
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+        // tex coords
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.vbo[1]);
 
-    // Must unbind the VAO before changing the element buffer.
-    GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // Must unbind the VAO before changing the element buffer.
+        GL::bindVAO(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
     CHECK_GL_ERROR_DEBUG();
 }
 
 void Renderer::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    for (auto& stream : _streamingBuffers)
+    {
+        glGenBuffers(2, &stream.vbo[0]);
+    }
     // Issue #15652
     // Should not initialize VBO with a large size (VBO_SIZE=65536),
     // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
@@ -332,15 +481,16 @@ void Renderer::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
     GL::bindVAO(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-    
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (auto& stream : _streamingBuffers)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, stream.vbo[0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.vbo[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+    }
 
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
@@ -631,6 +781,8 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_TRACE_SCOPE("Renderer::render");
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -671,6 +823,47 @@ void Renderer::clean()
     _lastBatchedMeshCommand = nullptr;
 }
 
+void Renderer::beginFrame()
+{
+    _lastFrameUploadedBytes = _uploadedBytes;
+    _peakUploadedBytes = std::max(_peakUploadedBytes, _uploadedBytes);
+    _uploadedBytes = 0;
+
+    _currentStreamingBuffer = (_currentStreamingBuffer + 1) % CC_RENDERER_STREAMING_BUFFER_COUNT;
+    auto& stream = _streamingBuffers[_currentStreamingBuffer];
+
+    if (_streamingMode == StreamingMode::RING)
+    {
+        // only restart from the beginning of the buffer when the GPU is done with it,
+        // otherwise orphan it on the next upload instead of stalling
+        bool available = true;
+#if CC_RENDERER_USE_SYNC_OBJECTS
+        if (stream.fence)
+        {
+            GLenum result = glClientWaitSync((GLsync)stream.fence, 0, 0);
+            available = (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED);
+            glDeleteSync((GLsync)stream.fence);
+            stream.fence = nullptr;
+        }
+#endif
+        if (!available)
+            stream.needsOrphaning = true;
+    }
+    stream.filledVertex = 0;
+    stream.filledIndex = 0;
+}
+
+void Renderer::endFrame()
+{
+#if CC_RENDERER_USE_SYNC_OBJECTS
+    auto& stream = _streamingBuffers[_currentStreamingBuffer];
+    if (_streamingMode == StreamingMode::RING && stream.filledVertex > 0)
+    {
+        stream.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+#endif
+}
+
 void Renderer::clear()
 {
     //Enable Depth mask to make sure glClear clear the depth buffer correctly
@@ -717,11 +910,12 @@ void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
         modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
     }
 
-    // fill index
+    // fill index, relative to the first vertex of the batch in the streaming buffer
     const unsigned short* indices = cmd->getIndices();
+    const GLushort indexBase = (GLushort)(_streamVertexBase + _filledVertex);
     for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        _indices[_filledIndex + i] = indexBase + indices[i];
     }
 
     _filledVertex += cmd->getVertexCount();
@@ -735,6 +929,27 @@ void Renderer::drawBatchedTriangles()
 
     CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_BATCH_TRIANGLES");
 
+    // reserve room for the whole batch in the current streaming buffer.
+    // If it doesn't fit in what is left, the buffer is orphaned and filled from the beginning.
+    auto& stream = _streamingBuffers[_currentStreamingBuffer];
+    if (_streamingMode == StreamingMode::RING)
+    {
+        if (stream.filledVertex + _filledVertex > VBO_SIZE || stream.filledIndex + _filledIndex > INDEX_VBO_SIZE)
+            stream.needsOrphaning = true;
+        if (stream.needsOrphaning)
+        {
+            stream.filledVertex = 0;
+            stream.filledIndex = 0;
+        }
+        _streamVertexBase = stream.filledVertex;
+        _streamIndexBase = stream.filledIndex;
+    }
+    else
+    {
+        _streamVertexBase = 0;
+        _streamIndexBase = 0;
+    }
+
     _filledVertex = 0;
     _filledIndex = 0;
 
@@ -794,37 +1009,23 @@ void Renderer::drawBatchedTriangles()
     if (conf->supportsShareableVAO() && conf->supportsMapBuffer())
     {
         //Bind VAO
-        GL::bindVAO(_buffersVAO);
+        GL::bindVAO(stream.vao);
         //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
+        glBindBuffer(GL_ARRAY_BUFFER, stream.vbo[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.vbo[1]);
 
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, _verts, GL_STATIC_DRAW);
-
-        // option 3: orphaning + glMapBuffer
-        // FIXME: in order to work as fast as possible, it must "and the exact same size and usage hints it had before."
-        //  source: https://www.opengl.org/wiki/Buffer_Object_Streaming#Explicit_multiple_buffering
-        // so most probably we won't have any benefit of using it
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_STATIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0]) * _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+        uploadStreamingBuffer(_filledVertex, _filledIndex);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
     }
     else
     {
         // Client Side Arrays
 #define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.vbo[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.vbo[1]);
 
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
+        uploadStreamingBuffer(_filledVertex, _filledIndex);
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
@@ -836,9 +1037,6 @@ void Renderer::drawBatchedTriangles()
 
         // tex coords
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
     }
 
     /************** 3: Draw *************/
@@ -846,7 +1044,7 @@ void Renderer::drawBatchedTriangles()
     {
         CC_ASSERT(_triBatchesToDraw[i].cmd && "Invalid batch");
         _triBatchesToDraw[i].cmd->useMaterial();
-        glDrawElements(GL_TRIANGLES, (GLsizei) _triBatchesToDraw[i].indicesToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (_triBatchesToDraw[i].offset*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) _triBatchesToDraw[i].indicesToDraw, GL_UNSIGNED_SHORT, (GLvoid*) ((_streamIndexBase + _triBatchesToDraw[i].offset)*sizeof(_indices[0])) );
         _drawnBatches++;
         _drawnVertices += _triBatchesToDraw[i].indicesToDraw;
     }
@@ -868,6 +1066,64 @@ void Renderer::drawBatchedTriangles()
     _filledIndex = 0;
 }
 
+void Renderer::uploadStreamingBuffer(GLsizei vertexCount, GLsizei indexCount)
+{
+    // expects the vertex and index buffers of the current streaming buffer to be bound
+    const GLsizeiptr vertexBytes = sizeof(_verts[0]) * vertexCount;
+    const GLsizeiptr indexBytes = sizeof(_indices[0]) * indexCount;
+
+#if CC_RENDERER_USE_SYNC_OBJECTS
+    if (_streamingMode == StreamingMode::RING)
+    {
+        auto& stream = _streamingBuffers[_currentStreamingBuffer];
+        if (stream.needsOrphaning)
+        {
+            // same size and usage every time, so that the driver can recycle the storage
+            glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, nullptr, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, nullptr, GL_STREAM_DRAW);
+            stream.needsOrphaning = false;
+        }
+
+        // the range was never used since the buffer was fenced or orphaned: no need to synchronize with the GPU
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        const GLintptr vertexOffset = sizeof(_verts[0]) * _streamVertexBase;
+        void* buf = glMapBufferRange(GL_ARRAY_BUFFER, vertexOffset, vertexBytes, access);
+        if (buf)
+        {
+            memcpy(buf, _verts, vertexBytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, vertexOffset, vertexBytes, _verts);
+        }
+
+        const GLintptr indexOffset = sizeof(_indices[0]) * _streamIndexBase;
+        buf = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, indexOffset, indexBytes, access);
+        if (buf)
+        {
+            memcpy(buf, _indices, indexBytes);
+            glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset, indexBytes, _indices);
+        }
+
+        stream.filledVertex = _streamVertexBase + vertexCount;
+        stream.filledIndex = _streamIndexBase + indexCount;
+    }
+    else
+#endif
+    {
+        // orphaning: new storage for every upload, the driver renames the buffer instead of waiting for the GPU
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, _verts, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, _indices, GL_STREAM_DRAW);
+    }
+
+    _uploadedBytes += vertexBytes + indexBytes;
+}
+
 void Renderer::flush()
 {
     flush2D();
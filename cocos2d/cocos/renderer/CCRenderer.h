@@ -29,6 +29,7 @@
 
 #include <vector>
 #include <stack>
+#include <cstdint>
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
@@ -67,6 +68,8 @@ class MeshCommand;
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
  are the ones that have `z < 0` and `z > 0`.
+ Their sort key (globalZ, or depth for transparent 3D objects) is packed into an integer
+ once, when they are pushed, and the queues are sorted with a stable radix sort.
 */
 class RenderQueue {
 public:
@@ -114,8 +117,25 @@ public:
     void restoreRenderState();
     
 protected:
+    /**A render command and its packed sort key.*/
+    struct SortItem
+    {
+        uint32_t key;
+        RenderCommand* command;
+    };
+
+    /**Returns the packed sort key of a command pushed into the given group.*/
+    static uint32_t getSortKey(QUEUE_GROUP group, RenderCommand* command);
+    /**Stable sort of a sub group by the keys in _sortKeys.*/
+    void sortSubQueue(QUEUE_GROUP group);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**The sort keys of the commands, only filled for the groups that are sorted.*/
+    std::vector<uint32_t> _sortKeys[QUEUE_COUNT];
+    /**Buffers used by the radix sort, kept around to avoid allocating them every frame.*/
+    std::vector<SortItem> _sortItems;
+    std::vector<SortItem> _sortScratch;
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -193,6 +213,19 @@ public:
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
     /* clear draw stats */
     void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    /* returns the number of vertex and index bytes streamed to the GPU by the batched triangles in the last frame */
+    size_t getUploadedBytes() const { return _lastFrameUploadedBytes; }
+    /* returns the biggest number of bytes streamed to the GPU in a single frame */
+    size_t getPeakUploadedBytes() const { return _peakUploadedBytes; }
+
+    /** Starts a new frame: moves to the next streaming buffer of the ring and updates the upload stats.
+     * Called by the Director once per frame, before anything is rendered.
+     */
+    void beginFrame();
+    /** Ends the current frame: fences the streaming buffer used by it, when sync objects are supported.
+     * Called by the Director once per frame, after everything was rendered.
+     */
+    void endFrame();
 
     /**
      * Enable/Disable depth test
@@ -215,6 +248,7 @@ protected:
     void setupVBO();
     void mapBuffers();
     void drawBatchedTriangles();
+    void uploadStreamingBuffer(GLsizei vertexCount, GLsizei indexCount);
 
     //Draw the previews queued triangles and flush previous context
     void flush();
@@ -244,8 +278,33 @@ protected:
     //for TrianglesCommand
     V3F_C4B_T2F _verts[VBO_SIZE];
     GLushort _indices[INDEX_VBO_SIZE];
-    GLuint _buffersVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+
+    // How the batched triangles are streamed to the GPU
+    enum class StreamingMode
+    {
+        // append into a ring of buffers with unsynchronized glMapBufferRange, guarded by fences
+        RING,
+        // reallocate the buffer storage on every upload and let the driver rename it
+        ORPHANING,
+    };
+
+    // One vertex/index buffer pair of the streaming ring
+    struct StreamingBuffer
+    {
+        GLuint vao;
+        GLuint vbo[2]; //0: vertex  1: indices
+        void* fence; // GLsync of the last frame that used it
+        GLsizei filledVertex; // vertices already written in the current frame
+        GLsizei filledIndex; // indices already written in the current frame
+        bool needsOrphaning; // its storage has to be reallocated before writing to it again
+    };
+    StreamingBuffer _streamingBuffers[CC_RENDERER_STREAMING_BUFFER_COUNT];
+    int _currentStreamingBuffer;
+    StreamingMode _streamingMode;
+    // first vertex of the current batch inside the streaming buffer
+    GLsizei _streamVertexBase;
+    // first index of the current batch inside the streaming buffer
+    GLsizei _streamIndexBase;
 
     // Internal structure that has the information for the batches
     struct TriBatchToDraw {
@@ -266,6 +325,9 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    size_t _uploadedBytes;
+    size_t _lastFrameUploadedBytes;
+    size_t _peakUploadedBytes;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
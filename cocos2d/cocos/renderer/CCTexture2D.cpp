@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/ccGLStateCache.h"
+#include "renderer/ccPixelConversion.h"
 #include "renderer/CCGLProgramCache.h"
 #include "base/CCNinePatchImageParser.h"
 
@@ -278,48 +279,25 @@ void Texture2D::convertAI88ToI8(const unsigned char* data, ssize_t dataLen, unsi
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-        *outData++ = 0xFF;            //A
-    }
+    PixelConversion::convertRGB888ToRGBA8888(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void Texture2D::convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-    }
+    PixelConversion::convertRGBA8888ToRGB888(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00FC) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    PixelConversion::convertRGB888ToRGB565(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00FC) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    PixelConversion::convertRGBA8888ToRGB565(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> AAAAAAAA
@@ -352,10 +330,7 @@ void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
 void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
-    {
-        *outData++ = data[i + 3]; //A
-    }
+    PixelConversion::convertRGBA8888ToA8(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIIIAAAAAAAA
@@ -382,53 +357,25 @@ void Texture2D::convertRGBA8888ToAI88(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = ((data[i] & 0x00F0) << 8           //R
-                    | (data[i + 1] & 0x00F0) << 4     //G
-                    | (data[i + 2] & 0xF0)            //B
-                    |  0x0F);                         //A
-    }
+    PixelConversion::convertRGB888ToRGBA4444(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F0) << 8    //R
-        | (data[i + 1] & 0x00F0) << 4         //G
-        | (data[i + 2] & 0xF0)                //B
-        |  (data[i + 3] & 0xF0) >> 4;         //A
-    }
+    PixelConversion::convertRGBA8888ToRGBA4444(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00F8) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 2     //B
-            |  0x01;                          //A
-    }
+    PixelConversion::convertRGB888ToRGB5A1(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00F8) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 2     //B
-            |  (data[i + 3] & 0x0080) >> 7;   //A
-    }
+    PixelConversion::convertRGBA8888ToRGB5A1(data, dataLen, outData);
 }
 // converter function end
 //////////////////////////////////////////////////////////////////////////
@@ -447,6 +394,7 @@ Texture2D::Texture2D()
 , _ninePatchInfo(nullptr)
 , _valid(true)
 , _alphaTexture(nullptr)
+, _lastUsedFrame(0)
 {
 }
 
@@ -503,6 +451,26 @@ GLuint Texture2D::getAlphaTextureName() const
     return _alphaTexture == nullptr ? 0 : _alphaTexture->getName();
 }
 
+size_t Texture2D::getMemorySize() const
+{
+    size_t bytes = static_cast<size_t>(_pixelsWide) * _pixelsHigh * getBitsPerPixelForFormat() / 8;
+    if (_hasMipmaps)
+    {
+        // the mipmap chain adds a third
+        bytes += bytes / 3;
+    }
+    if (_alphaTexture)
+    {
+        bytes += _alphaTexture->getMemorySize();
+    }
+    return bytes;
+}
+
+void Texture2D::markUsed()
+{
+    _lastUsedFrame = Director::getInstance()->getTotalFrames();
+}
+
 Size Texture2D::getContentSize() const
 {
     Size ret;
@@ -415,6 +415,21 @@ public:
     Texture2D* getAlphaTexture() const;
 
     GLuint getAlphaTextureName() const;
+
+    /** Gets the memory used by the texture in bytes, including its mipmaps and its alpha texture.
+     * @since v3.17
+     */
+    size_t getMemorySize() const;
+
+    /** Records that the texture is used in the current frame.
+     * The draw commands call it, TextureCache evicts the least recently used textures first.
+     * @since v3.17
+     */
+    void markUsed();
+    /** Gets the frame the texture was last used in, see Director::getTotalFrames().
+     * @since v3.17
+     */
+    unsigned int getLastUsedFrame() const { return _lastUsedFrame; }
 public:
     /** Get pixel info map, the key-value pairs is PixelFormat and PixelFormatInfo.*/
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
@@ -554,6 +569,8 @@ protected:
     std::string _filePath;
 
     Texture2D* _alphaTexture;
+
+    unsigned int _lastUsedFrame;
 };
 
 
@@ -27,17 +27,21 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
 
 #include <errno.h>
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCJobSystem.h"
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
@@ -68,9 +72,16 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _needQuit(false)
-, _asyncRefCount(0)
+: _asyncRefCount(0)
+, _asyncSequence(0)
+, _asyncUploadTimeBudget(0.0f)
+, _decodingCount(0)
+, _asyncDecodeConcurrency(0)
+, _textureBytes(0)
+, _memoryBudget(0)
+, _evictedCount(0)
+, _evictedBytes(0)
+, _dynamicAtlas(nullptr)
 {
 }
 
@@ -81,7 +92,7 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    CC_SAFE_DELETE(_dynamicAtlas);
 }
 
 void TextureCache::destroyInstance()
@@ -105,12 +116,20 @@ std::string TextureCache::getDescription() const
 struct TextureCache::AsyncStruct
 {
 public:
+    enum class State
+    {
+        PENDING,
+        DECODING,
+        DECODED,
+        CANCELLED
+    };
+
     AsyncStruct
     ( const std::string& fn,const std::function<void(Texture2D*)>& f,
-      const std::string& key )
+      const std::string& key, int p, unsigned int seq )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        loadSuccess(false), priority(p), sequence(seq), state(State::PENDING)
     {}
 
     std::string filename;
@@ -120,21 +139,32 @@ public:
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
     bool loadSuccess;
+    int priority;
+    unsigned int sequence;
+    // PENDING -> DECODING and PENDING -> CANCELLED under _decodeMutex, DECODED is released to the GL thread
+    std::atomic<State> state;
+    JobSystem::JobHandle job;
+
+    // the order of the _pendingDecodes heap: the top is the highest priority, then the oldest request
+    static bool isDecodedAfter(const AsyncStruct* a, const AsyncStruct* b)
+    {
+        return a->priority < b->priority || (a->priority == b->priority && a->sequence > b->sequence);
+    }
 };
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _asyncStructQueue and _pendingDecodes, and launch the decode jobs (GL thread)
+ - load res and fill image data to AsyncStruct.image, then launch the next decode job (JobSystem worker)
+ - on schedule callback, pop the decoded AsyncStructs from the front of _asyncStructQueue, convert image to texture within the upload time budget, then delete AsyncStruct (GL thread)
 
  the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - _pendingDecodes and _decodingCount: guarded by _decodeMutex
+ - AsyncStruct image data: written by the job, read once its state is DECODED
 
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in JobSystem worker, delete in GL thread(by Image instance)
 
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -159,17 +189,17 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _asyncStructQueue and _pendingDecodes, and launch the decode jobs (GL thread)
+ - load res and fill image data to AsyncStruct.image, then launch the next decode job (JobSystem worker)
+ - on schedule callback, pop the decoded AsyncStructs from the front of _asyncStructQueue, convert image to texture within the upload time budget, then delete AsyncStruct (GL thread)
  
  the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - _pendingDecodes and _decodingCount: guarded by _decodeMutex
+ - AsyncStruct image data: written by the job, read once its state is DECODED
  
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in JobSystem worker, delete in GL thread(by Image instance)
  
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -189,7 +219,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbind the callback independently as needed whilst a call to
  unbindImageAsync(path) would be ambiguous.
  */
-void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, int priority)
 {
     Texture2D *texture = nullptr;
 
@@ -211,14 +241,6 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_loadingThread == nullptr)
-    {
-        // create a new thread to load images
-        _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
-    }
-
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->schedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this, 0, false);
@@ -228,13 +250,18 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     // generate async struct
     AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey, priority, _asyncSequence++);
     
-    // add async struct into queue
-    _asyncStructQueue.push_back(data);
-    std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
-    _sleepCondition.notify_one();
+    // add async struct into queue, after the requests of the same or a higher priority
+    auto position = std::upper_bound(_asyncStructQueue.begin(), _asyncStructQueue.end(), data,
+        [](const AsyncStruct* a, const AsyncStruct* b) { return a->priority > b->priority; });
+    _asyncStructQueue.insert(position, data);
+
+    // the image is loaded by a worker of the job system when a decode slot is free
+    std::lock_guard<std::mutex> lock(_decodeMutex);
+    _pendingDecodes.push_back(data);
+    std::push_heap(_pendingDecodes.begin(), _pendingDecodes.end(), AsyncStruct::isDecodedAfter);
+    launchDecodes();
 }
 
 void TextureCache::unbindImageAsync(const std::string& callbackKey)
@@ -244,11 +271,13 @@ void TextureCache::unbindImageAsync(const std::string& callbackKey)
         return;
     }
 
+    std::lock_guard<std::mutex> lock(_decodeMutex);
     for (auto& asyncStruct : _asyncStructQueue)
     {
         if (asyncStruct->callbackKey == callbackKey)
         {
             asyncStruct->callback = nullptr;
+            cancelDecode(asyncStruct);
         }
     }
 }
@@ -260,52 +289,77 @@ void TextureCache::unbindAllImageAsync()
         return;
 
     }
+    std::lock_guard<std::mutex> lock(_decodeMutex);
     for (auto& asyncStruct : _asyncStructQueue)
     {
         asyncStruct->callback = nullptr;
+        cancelDecode(asyncStruct);
     }
 }
 
-void TextureCache::loadImage()
+void TextureCache::setAsyncDecodeConcurrency(int concurrency)
 {
-    AsyncStruct *asyncStruct = nullptr;
-    while (!_needQuit)
+    std::lock_guard<std::mutex> lock(_decodeMutex);
+    _asyncDecodeConcurrency = std::max(concurrency, 0);
+    launchDecodes();
+}
+
+void TextureCache::launchDecodes()
+{
+    // _decodeMutex is locked by the caller
+    auto jobSystem = JobSystem::getInstance();
+    const int concurrency = _asyncDecodeConcurrency > 0 ? _asyncDecodeConcurrency : jobSystem->getWorkerCount();
+
+    while (_decodingCount < concurrency && !_pendingDecodes.empty())
     {
-        std::unique_lock<std::mutex> ul(_requestMutex);
-        // pop an AsyncStruct from request queue
-        if (_requestQueue.empty())
-        {
-            asyncStruct = nullptr;
-        }
-        else
-        {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
-        }
+        std::pop_heap(_pendingDecodes.begin(), _pendingDecodes.end(), AsyncStruct::isDecodedAfter);
+        AsyncStruct* asyncStruct = _pendingDecodes.back();
+        _pendingDecodes.pop_back();
+
+        asyncStruct->state.store(AsyncStruct::State::DECODING, std::memory_order_relaxed);
+        ++_decodingCount;
+
+        asyncStruct->job = jobSystem->createJob([this, asyncStruct]() {
+            loadImage(asyncStruct);
+
+            std::lock_guard<std::mutex> lock(_decodeMutex);
+            --_decodingCount;
+            // the GL thread may delete the struct from now on
+            asyncStruct->state.store(AsyncStruct::State::DECODED, std::memory_order_release);
+            launchDecodes();
+        });
+        jobSystem->schedule(asyncStruct->job);
+    }
+}
 
-        if (nullptr == asyncStruct) {
-            if (_needQuit) {
-                break;
-            }
-            _sleepCondition.wait(ul);
-            continue;
-        }
-        ul.unlock();
+void TextureCache::cancelDecode(AsyncStruct* asyncStruct)
+{
+    // _decodeMutex is locked by the caller
+    if (asyncStruct->state.load(std::memory_order_relaxed) != AsyncStruct::State::PENDING)
+    {
+        return;
+    }
 
-        // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+    auto it = std::find(_pendingDecodes.begin(), _pendingDecodes.end(), asyncStruct);
+    if (it != _pendingDecodes.end())
+    {
+        _pendingDecodes.erase(it);
+        std::make_heap(_pendingDecodes.begin(), _pendingDecodes.end(), AsyncStruct::isDecodedAfter);
+    }
+    asyncStruct->state.store(AsyncStruct::State::CANCELLED, std::memory_order_relaxed);
+}
 
-        // ETC1 ALPHA supports.
-        if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
-        { // check whether alpha texture exists & load it
-            auto alphaFile = asyncStruct->filename + s_etc1AlphaFileSuffix;
-            if (FileUtils::getInstance()->isFileExist(alphaFile))
-                asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
-        }
-        // push the asyncStruct to response queue
-        _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
-        _responseMutex.unlock();
+void TextureCache::loadImage(AsyncStruct* asyncStruct)
+{
+    // load image
+    asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+
+    // ETC1 ALPHA supports.
+    if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
+    { // check whether alpha texture exists & load it
+        auto alphaFile = asyncStruct->filename + s_etc1AlphaFileSuffix;
+        if (FileUtils::getInstance()->isFileExist(alphaFile))
+            asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
     }
 }
 
@@ -313,27 +367,32 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
-    while (true)
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(_asyncUploadTimeBudget));
+    int uploadCount = 0;
+    while (!_asyncStructQueue.empty())
     {
-        // pop an AsyncStruct from response queue
-        _responseMutex.lock();
-        if (_responseQueue.empty())
+        // the images are loaded in parallel, but the callbacks are called in priority then request order:
+        // stop at the first image that is not loaded yet
+        asyncStruct = _asyncStructQueue.front();
+        const auto state = asyncStruct->state.load(std::memory_order_acquire);
+        if (state == AsyncStruct::State::PENDING || state == AsyncStruct::State::DECODING)
         {
-            asyncStruct = nullptr;
+            break;
         }
-        else
-        {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
 
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
+        // the other textures are created in the next frames
+        if (uploadCount > 0 && _asyncUploadTimeBudget > 0.0f && std::chrono::steady_clock::now() - start >= budget)
+        {
+            break;
         }
-        _responseMutex.unlock();
+        _asyncStructQueue.pop_front();
 
-        if (nullptr == asyncStruct) {
-            break;
+        if (state == AsyncStruct::State::CANCELLED)
+        {
+            delete asyncStruct;
+            --_asyncRefCount;
+            continue;
         }
 
         // check the image has been convert to texture or not
@@ -341,6 +400,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         if (it != _textures.end())
         {
             texture = it->second;
+            texture->markUsed();
         }
         else
         {
@@ -352,14 +412,14 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 texture = new (std::nothrow) Texture2D();
 
                 texture->initWithImage(image, asyncStruct->pixelFormat);
+                ++uploadCount;
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, asyncStruct->filename);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
 #endif
-                // cache the texture. retain it, since it is added in the map
-                _textures.emplace(asyncStruct->filename, texture);
+                // retain it, since it is added in the map
                 texture->retain();
 
                 texture->autorelease();
@@ -371,6 +431,10 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                     }
                     CC_SAFE_RELEASE(alphaTexture);
                 }
+                // cache the texture once its alpha texture is set, so that its size is counted
+                cacheTexture(asyncStruct->filename, texture);
+                texture->markUsed();
+                checkMemoryBudget();
             }
             else {
                 texture = nullptr;
@@ -410,7 +474,10 @@ Texture2D * TextureCache::addImage(const std::string &path)
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        texture->markUsed();
+    }
 
     if (!texture)
     {
@@ -431,9 +498,6 @@ Texture2D * TextureCache::addImage(const std::string &path)
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, fullpath);
 #endif
-                // texture already retained, no need to re-retain it
-                _textures.emplace(fullpath, texture);
-
                 //-- ANDROID ETC1 ALPHA SUPPORTS.
                 std::string alphaFullPath = path + s_etc1AlphaFileSuffix;
                 if (image->getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty() && FileUtils::getInstance()->isFileExist(alphaFullPath))
@@ -451,6 +515,11 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
+
+                // texture already retained, no need to re-retain it
+                cacheTexture(fullpath, texture);
+                texture->markUsed();
+                checkMemoryBudget();
             }
             else
             {
@@ -489,6 +558,7 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         auto it = _textures.find(key);
         if (it != _textures.end()) {
             texture = it->second;
+            texture->markUsed();
             break;
         }
 
@@ -498,7 +568,9 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         {
             if (texture->initWithImage(image))
             {
-                _textures.emplace(key, texture);
+                cacheTexture(key, texture);
+                texture->markUsed();
+                checkMemoryBudget();
             }
             else
             {
@@ -568,6 +640,13 @@ void TextureCache::removeAllTextures()
         texture.second->release();
     }
     _textures.clear();
+    _textureSizes.clear();
+    _textureBytes = 0;
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeAll();
+    }
 }
 
 void TextureCache::removeUnusedTextures()
@@ -578,13 +657,129 @@ void TextureCache::removeUnusedTextures()
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
             tex->release();
-            it = _textures.erase(it);
+            it = uncacheTexture(it);
         }
         else {
             ++it;
         }
 
     }
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeUnusedRegions();
+    }
+}
+
+size_t TextureCache::removeUnusedTextures(size_t maxMemoryUsage)
+{
+    size_t released = evictTextures(maxMemoryUsage);
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeUnusedRegions();
+    }
+    return released;
+}
+
+size_t TextureCache::evictTextures(size_t maxMemoryUsage)
+{
+    size_t usage = getMemoryUsage();
+    if (usage <= maxMemoryUsage)
+    {
+        return 0;
+    }
+
+    // the textures only retained by the cache and not used in this frame, the least recently used first
+    unsigned int currentFrame = Director::getInstance()->getTotalFrames();
+    std::vector<std::unordered_map<std::string, Texture2D*>::iterator> candidates;
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        Texture2D* tex = it->second;
+        if (tex->getReferenceCount() == 1 && tex->getLastUsedFrame() != currentFrame)
+        {
+            candidates.push_back(it);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const std::unordered_map<std::string, Texture2D*>::iterator& a,
+                                                       const std::unordered_map<std::string, Texture2D*>::iterator& b) {
+        return a->second->getLastUsedFrame() < b->second->getLastUsedFrame();
+    });
+
+    size_t released = 0;
+    for (auto& it : candidates)
+    {
+        if (usage - released <= maxMemoryUsage)
+        {
+            break;
+        }
+
+        size_t bytes = _textureSizes[it->first];
+        CCLOG("cocos2d: TextureCache: evicting texture: %s (%lu KB)", it->first.c_str(), (unsigned long)(bytes / 1024));
+        released += bytes;
+        ++_evictedCount;
+        _evictedBytes += bytes;
+
+        it->second->release();
+        uncacheTexture(it);
+    }
+    return released;
+}
+
+void TextureCache::cacheTexture(const std::string& key, Texture2D* texture)
+{
+    if (_textures.emplace(key, texture).second)
+    {
+        size_t bytes = texture->getMemorySize();
+        _textureSizes[key] = bytes;
+        _textureBytes += bytes;
+    }
+}
+
+std::unordered_map<std::string, Texture2D*>::const_iterator TextureCache::uncacheTexture(std::unordered_map<std::string, Texture2D*>::const_iterator it)
+{
+    auto sizeIt = _textureSizes.find(it->first);
+    if (sizeIt != _textureSizes.end())
+    {
+        _textureBytes -= sizeIt->second;
+        _textureSizes.erase(sizeIt);
+    }
+    return _textures.erase(it);
+}
+
+void TextureCache::checkMemoryBudget()
+{
+    if (_memoryBudget > 0)
+    {
+        evictTextures(_memoryBudget);
+    }
+}
+
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    checkMemoryBudget();
+}
+
+size_t TextureCache::getMemoryUsage() const
+{
+    size_t usage = _textureBytes;
+    if (_dynamicAtlas)
+    {
+        usage += _dynamicAtlas->getMemoryUsage();
+    }
+    return usage;
+}
+
+TextureCache::Statistics TextureCache::getStatistics() const
+{
+    Statistics statistics;
+    statistics.textureCount = _textures.size();
+    statistics.memoryUsage = getMemoryUsage();
+    statistics.memoryBudget = _memoryBudget;
+    statistics.evictedCount = _evictedCount;
+    statistics.evictedBytes = _evictedBytes;
+    return statistics;
 }
 
 void TextureCache::removeTexture(Texture2D* texture)
@@ -597,7 +792,7 @@ void TextureCache::removeTexture(Texture2D* texture)
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         if (it->second == texture) {
             it->second->release();
-            it = _textures.erase(it);
+            uncacheTexture(it);
             break;
         }
         else
@@ -617,7 +812,7 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
 
     if (it != _textures.end()) {
         it->second->release();
-        _textures.erase(it);
+        uncacheTexture(it);
     }
 }
 
@@ -659,12 +854,30 @@ std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    std::unique_lock<std::mutex> ul(_requestMutex);
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    if (_asyncStructQueue.empty())
+    {
+        return;
+    }
+
+    // discard the images that are not loaded yet, and wait for the ones being loaded
+    std::vector<JobSystem::JobHandle> decodingJobs;
+    {
+        std::lock_guard<std::mutex> lock(_decodeMutex);
+        for (auto& asyncStruct : _asyncStructQueue)
+        {
+            cancelDecode(asyncStruct);
+            if (asyncStruct->state.load(std::memory_order_relaxed) == AsyncStruct::State::DECODING)
+            {
+                decodingJobs.push_back(asyncStruct->job);
+            }
+        }
+    }
+
+    auto jobSystem = JobSystem::getInstance();
+    for (auto& job : decodingJobs)
+    {
+        jobSystem->wait(job);
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -673,7 +886,7 @@ std::string TextureCache::getCachedTextureInfo() const
     char buftmp[4096];
 
     unsigned int count = 0;
-    unsigned int totalBytes = 0;
+    size_t totalBytes = 0;
 
     for (auto& texture : _textures) {
 
@@ -682,8 +895,8 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex = texture.second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        // Each texture takes up width * height * bytesPerPixel bytes, plus its mipmaps and its alpha texture.
+        auto bytes = tex->getMemorySize();
         totalBytes += bytes;
         count++;
         snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
@@ -701,9 +914,36 @@ std::string TextureCache::getCachedTextureInfo() const
     snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
 
+    if (_memoryBudget > 0)
+    {
+        snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache budget: %lu KB, %lu textures evicted for %lu KB\n",
+            (unsigned long)(_memoryBudget / 1024),
+            (unsigned long)_evictedCount,
+            (unsigned long)(_evictedBytes / 1024));
+        buffer += buftmp;
+    }
+
+    if (_dynamicAtlas)
+    {
+        buffer += _dynamicAtlas->getDescription();
+        buffer += "\n";
+    }
+
     return buffer;
 }
 
+void TextureCache::setDynamicAtlasEnabled(bool enabled)
+{
+    if (enabled && !_dynamicAtlas)
+    {
+        _dynamicAtlas = new (std::nothrow) DynamicAtlas();
+    }
+    else if (!enabled)
+    {
+        CC_SAFE_DELETE(_dynamicAtlas);
+    }
+}
+
 void TextureCache::renameTextureWithKey(const std::string& srcName, const std::string& dstName)
 {
     std::string key = srcName;
@@ -724,9 +964,9 @@ void TextureCache::renameTextureWithKey(const std::string& srcName, const std::s
             bool ret = image->initWithImageFile(dstName);
             if (ret)
             {
+                uncacheTexture(it);
                 tex->initWithImage(image);
-                _textures.emplace(fullpath, tex);
-                _textures.erase(it);
+                cacheTexture(fullpath, tex);
             }
             CC_SAFE_DELETE(image);
         }
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
 #include <functional>
@@ -47,6 +48,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class DynamicAtlas;
+
 /**
  * @addtogroup _2d
  * @{
@@ -125,21 +128,49 @@ public:
     */
     virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback);
     
-    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
+    /** Loads a texture in a worker thread, like addImageAsync(filepath, callback).
+     * @param callbackKey The key used to unbind the callback, see unbindImageAsync().
+     * @param priority The requests with a higher priority are decoded and their callbacks called first, e.g. the
+     * images of the visible nodes. The requests with the same priority are handled in request order.
+     */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, int priority = 0);
 
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
+     * The images that are not being decoded yet are not loaded at all.
      * @param filename It's the related/absolute path of the file image.
      * @since v3.1
      */
     virtual void unbindImageAsync(const std::string &filename);
     
     /** Unbind all bound image asynchronous load callbacks.
+     * The images that are not being decoded yet are not loaded at all.
      * @since v3.1
      */
     virtual void unbindAllImageAsync();
 
+    /** Sets how many images of addImageAsync() are decoded in parallel by the JobSystem workers.
+     * The other requests wait in priority order. 0, the default, uses all the workers.
+     * @since v3.17
+     */
+    void setAsyncDecodeConcurrency(int concurrency);
+    /** Gets how many images of addImageAsync() are decoded in parallel, 0 means all the JobSystem workers.
+     * @since v3.17
+     */
+    int getAsyncDecodeConcurrency() const { return _asyncDecodeConcurrency; }
+
+    /** Sets the max time spent each frame creating the textures of the images decoded by addImageAsync(), in seconds.
+     * At least one texture is created per frame, the others are created in the next frames, in order.
+     * 0, the default, means no limit.
+     * @since v3.17
+     */
+    void setAsyncUploadTimeBudget(float seconds) { _asyncUploadTimeBudget = seconds; }
+    /** Gets the max time spent each frame creating the textures of the images decoded by addImageAsync(), in seconds.
+     * @since v3.17
+     */
+    float getAsyncUploadTimeBudget() const { return _asyncUploadTimeBudget; }
+
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image.
@@ -189,6 +220,49 @@ public:
     */
     void removeTextureForKey(const std::string &key);
 
+    /** Removes the unused textures, the least recently used first, until the cached textures use at most maxMemoryUsage bytes.
+    * Like removeUnusedTextures(), only the textures that have a retain count of 1 are deleted.
+    * The textures used in the current frame are kept.
+    * @param maxMemoryUsage The memory the cached textures may still use, in bytes.
+    * @return The memory released, in bytes.
+    * @since v3.17
+    */
+    size_t removeUnusedTextures(size_t maxMemoryUsage);
+
+    /** Sets the memory the cached textures may use, in bytes.
+    * When a new texture makes the cache use more, the unused textures are removed, the least recently used first,
+    * see removeUnusedTextures(size_t). The textures that are still retained are never removed, so the budget can be exceeded.
+    * Director::purgeCachedData() removes the unused textures down to half of the budget, instead of all of them.
+    * 0, the default, means no limit.
+    * @since v3.17
+    */
+    void setMemoryBudget(size_t bytes);
+    /** Gets the memory the cached textures may use, in bytes, 0 means no limit.
+    * @since v3.17
+    */
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Gets the memory used by the cached textures and the dynamic atlas pages, in bytes, see Texture2D::getMemorySize().
+    * @since v3.17
+    */
+    size_t getMemoryUsage() const;
+
+    /** The state of the cache, as reported by getCachedTextureInfo(). */
+    struct Statistics
+    {
+        size_t textureCount;
+        size_t memoryUsage;
+        size_t memoryBudget;
+        /** the textures removed to stay within the budget, since the cache was created */
+        unsigned int evictedCount;
+        size_t evictedBytes;
+    };
+
+    /** Gets the number of textures, the memory they use and what the budget removed.
+    * @since v3.17
+    */
+    Statistics getStatistics() const;
+
     /** Output to CCLOG the current contents of this TextureCache.
     * This will attempt to calculate the size of each texture, and the total texture memory in use.
     *
@@ -219,31 +293,59 @@ public:
     */
     void renameTextureWithKey(const std::string& srcName, const std::string& dstName);
 
+    /** Enables or disables the dynamic atlas.
+    * When it is enabled, Sprite::initWithFile() packs the small images into shared textures, so the sprites
+    * created from different files can be drawn in the same batch. Disabling it releases the atlas.
+    *
+    * @see DynamicAtlas
+    * @since v3.17
+    */
+    void setDynamicAtlasEnabled(bool enabled);
+
+    /** Returns the dynamic atlas, or nullptr if it is disabled.
+    * @since v3.17
+    */
+    DynamicAtlas* getDynamicAtlas() const { return _dynamicAtlas; }
+
 
 private:
+    struct AsyncStruct;
+
     void addImageAsyncCallBack(float dt);
-    void loadImage();
+    void loadImage(AsyncStruct* asyncStruct);
+    void launchDecodes();
+    void cancelDecode(AsyncStruct* asyncStruct);
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    void cacheTexture(const std::string& key, Texture2D* texture);
+    std::unordered_map<std::string, Texture2D*>::const_iterator uncacheTexture(std::unordered_map<std::string, Texture2D*>::const_iterator it);
+    size_t evictTextures(size_t maxMemoryUsage);
+    void checkMemoryBudget();
 public:
 protected:
-    struct AsyncStruct;
-    
-    std::thread* _loadingThread;
-
+    // the images are loaded by JobSystem jobs, the textures are created in priority then request order
     std::deque<AsyncStruct*> _asyncStructQueue;
-    std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
-
-    std::mutex _requestMutex;
-    std::mutex _responseMutex;
-    
-    std::condition_variable _sleepCondition;
-
-    bool _needQuit;
 
     int _asyncRefCount;
+    unsigned int _asyncSequence;
+    float _asyncUploadTimeBudget;
+
+    // the requests waiting for a decode job, a heap of the highest priority then the oldest.
+    // The decode jobs launch the next ones, so these members are shared with the workers.
+    std::mutex _decodeMutex;
+    std::vector<AsyncStruct*> _pendingDecodes;
+    int _decodingCount;
+    int _asyncDecodeConcurrency;
 
     std::unordered_map<std::string, Texture2D*> _textures;
+    // the size counted for each cached texture, it may change after the texture is cached
+    std::unordered_map<std::string, size_t> _textureSizes;
+    size_t _textureBytes;
+
+    size_t _memoryBudget;
+    unsigned int _evictedCount;
+    size_t _evictedBytes;
+
+    DynamicAtlas* _dynamicAtlas;
 
     static std::string s_etc1AlphaFileSuffix;
 };
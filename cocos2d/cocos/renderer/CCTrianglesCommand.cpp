@@ -79,6 +79,7 @@ void TrianglesCommand::init(float globalOrder, Texture2D* texture, GLProgramStat
 {
     init(globalOrder, texture->getName(), glProgramState, blendType, triangles, mv, flags);
     _alphaTextureID = texture->getAlphaTextureName();
+    texture->markUsed();
 }
 
 TrianglesCommand::~TrianglesCommand()
@@ -0,0 +1,592 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "renderer/ccPixelConversion.h"
+
+#include <atomic>
+#include <string.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <cpu-features.h>
+#endif
+
+//#define USE_SSE2        : SSE2 code used
+//#define USE_NEON        : NEON code used, armeabi-v7a builds this file with .neon and checks the CPU at runtime
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace PixelConversion
+{
+
+namespace
+{
+    bool detectSIMD()
+    {
+#if defined(USE_SSE2)
+        // the compiler only targets SSE2 when the ABI guarantees it (x86_64, android x86) or when asked to
+        return true;
+#elif defined(USE_NEON) && (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) && !defined(__aarch64__)
+        return android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM && (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+#elif defined(USE_NEON)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const bool s_simdAvailable = detectSIMD();
+    // read by the threads decoding images
+    std::atomic<bool> s_simdEnabled(s_simdAvailable);
+
+    inline uint32_t load32(const unsigned char* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline void store32(unsigned char* p, uint32_t value)
+    {
+        memcpy(p, &value, sizeof(value));
+    }
+
+#if defined(USE_SSE2)
+
+    // The pixels are loaded as 32-bit lanes: R | G << 8 | B << 16 | A << 24
+
+    // 4 RGB888 pixels as 32-bit lanes, the top bytes are the next pixel's red. Reads 13 bytes.
+    inline __m128i loadRGB888(const unsigned char* p)
+    {
+        return _mm_set_epi32(static_cast<int>(load32(p + 9)), static_cast<int>(load32(p + 6)), static_cast<int>(load32(p + 3)), static_cast<int>(load32(p)));
+    }
+
+    // the low 16 bits of the lanes of a, then of b
+    inline __m128i pack16(__m128i a, __m128i b)
+    {
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        return _mm_packs_epi32(a, b);
+    }
+
+    inline __m128i bits(__m128i px, int mask)
+    {
+        return _mm_and_si128(px, _mm_set1_epi32(mask));
+    }
+
+    // the alpha bits are ignored
+    struct ToRGB565
+    {
+        __m128i operator()(__m128i px) const
+        {
+            const __m128i rg = _mm_or_si128(_mm_slli_epi32(bits(px, 0xF8), 8), _mm_srli_epi32(bits(px, 0xFC00), 5));
+            return _mm_or_si128(rg, _mm_srli_epi32(bits(px, 0xF80000), 19));
+        }
+    };
+
+    struct ToRGB444
+    {
+        __m128i operator()(__m128i px) const
+        {
+            const __m128i rg = _mm_or_si128(_mm_slli_epi32(bits(px, 0xF0), 8), _mm_srli_epi32(bits(px, 0xF000), 4));
+            return _mm_or_si128(rg, _mm_srli_epi32(bits(px, 0xF00000), 16));
+        }
+    };
+
+    struct ToRGB555
+    {
+        __m128i operator()(__m128i px) const
+        {
+            const __m128i rg = _mm_or_si128(_mm_slli_epi32(bits(px, 0xF8), 8), _mm_srli_epi32(bits(px, 0xF800), 5));
+            return _mm_or_si128(rg, _mm_srli_epi32(bits(px, 0xF80000), 18));
+        }
+    };
+
+    struct ToRGBA4444
+    {
+        __m128i operator()(__m128i px) const { return _mm_or_si128(ToRGB444()(px), _mm_srli_epi32(px, 28)); }
+    };
+
+    struct ToRGB5A1
+    {
+        __m128i operator()(__m128i px) const { return _mm_or_si128(ToRGB555()(px), _mm_srli_epi32(px, 31)); }
+    };
+
+    // Each kernel converts the whole blocks it can and returns the number of source bytes converted
+
+    template <typename Convert>
+    ssize_t convertRGBA8888To16(const unsigned char* data, ssize_t dataLen, unsigned char* outData, Convert convert)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 16)
+        {
+            const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(outData), pack16(convert(p0), convert(p1)));
+        }
+        return i;
+    }
+
+    template <typename Convert>
+    ssize_t convertRGB888To16(const unsigned char* data, ssize_t dataLen, unsigned char* outData, Convert convert, int alpha)
+    {
+        const __m128i alphaBits = _mm_set1_epi32(alpha);
+        ssize_t i = 0;
+        for (; i + 24 < dataLen; i += 24, outData += 16)
+        {
+            const __m128i p0 = _mm_or_si128(convert(loadRGB888(data + i)), alphaBits);
+            const __m128i p1 = _mm_or_si128(convert(loadRGB888(data + i + 12)), alphaBits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(outData), pack16(p0, p1));
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGBA8888To16(data, dataLen, outData, ToRGB565());
+    }
+
+    ssize_t simdRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGBA8888To16(data, dataLen, outData, ToRGBA4444());
+    }
+
+    ssize_t simdRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGBA8888To16(data, dataLen, outData, ToRGB5A1());
+    }
+
+    ssize_t simdRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGB888To16(data, dataLen, outData, ToRGB565(), 0);
+    }
+
+    ssize_t simdRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGB888To16(data, dataLen, outData, ToRGB444(), 0x0F);
+    }
+
+    ssize_t simdRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        return convertRGB888To16(data, dataLen, outData, ToRGB555(), 0x01);
+    }
+
+    ssize_t simdRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        ssize_t i = 0;
+        for (; i + 12 < dataLen; i += 12, outData += 16)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(outData), _mm_or_si128(loadRGB888(data + i), alpha));
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        // SSE2 can't shuffle bytes, 4 pixels are packed into 3 words
+        ssize_t i = 0;
+        for (; i + 16 <= dataLen; i += 16, outData += 12)
+        {
+            const uint32_t p0 = load32(data + i);
+            const uint32_t p1 = load32(data + i + 4);
+            const uint32_t p2 = load32(data + i + 8);
+            const uint32_t p3 = load32(data + i + 12);
+            store32(outData, (p0 & 0xFFFFFF) | (p1 << 24));
+            store32(outData + 4, ((p1 >> 8) & 0xFFFF) | (p2 << 16));
+            store32(outData + 8, ((p2 >> 16) & 0xFF) | (p3 << 8));
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 64 <= dataLen; i += 64, outData += 16)
+        {
+            const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+            const __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(p), 24);
+            const __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(p + 1), 24);
+            const __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(p + 2), 24);
+            const __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(p + 3), 24);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(outData), _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+        }
+        return i;
+    }
+
+    ssize_t simdPremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        ssize_t i = 0;
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(data + i * 4);
+            const __m128i px = _mm_loadu_si128(p);
+
+            // 2 pixels of 16-bit channels, multiplied by their alpha + 1
+            __m128i lo = _mm_unpacklo_epi8(px, zero);
+            __m128i hi = _mm_unpackhi_epi8(px, zero);
+            const __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_add_epi16(alphaLo, one)), 8);
+            hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_add_epi16(alphaHi, one)), 8);
+
+            // the alpha is kept as is
+            const __m128i premultiplied = _mm_packus_epi16(lo, hi);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_andnot_si128(alphaMask, premultiplied), _mm_and_si128(px, alphaMask)));
+        }
+        return i;
+    }
+
+#elif defined(USE_NEON)
+
+    // 8 pixels per iteration, de-interleaved by vld3/vld4
+
+    inline uint16x8_t toRGB565(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+    {
+        const uint16x8_t r16 = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+        const uint16x8_t g16 = vshll_n_u8(vand_u8(g, vdup_n_u8(0xFC)), 3);
+        const uint16x8_t b16 = vmovl_u8(vshr_n_u8(b, 3));
+        return vorrq_u16(vorrq_u16(r16, g16), b16);
+    }
+
+    inline uint16x8_t toRGB444(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+    {
+        const uint8x8_t mask = vdup_n_u8(0xF0);
+        const uint16x8_t r16 = vshll_n_u8(vand_u8(r, mask), 8);
+        const uint16x8_t g16 = vshll_n_u8(vand_u8(g, mask), 4);
+        const uint16x8_t b16 = vmovl_u8(vand_u8(b, mask));
+        return vorrq_u16(vorrq_u16(r16, g16), b16);
+    }
+
+    inline uint16x8_t toRGB555(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+    {
+        const uint8x8_t mask = vdup_n_u8(0xF8);
+        const uint16x8_t r16 = vshll_n_u8(vand_u8(r, mask), 8);
+        const uint16x8_t g16 = vshll_n_u8(vand_u8(g, mask), 3);
+        const uint16x8_t b16 = vshll_n_u8(vshr_n_u8(b, 3), 1);
+        return vorrq_u16(vorrq_u16(r16, g16), b16);
+    }
+
+    ssize_t simdRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 16)
+        {
+            const uint8x8x4_t px = vld4_u8(data + i);
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), toRGB565(px.val[0], px.val[1], px.val[2]));
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 16)
+        {
+            const uint8x8x4_t px = vld4_u8(data + i);
+            const uint16x8_t a16 = vmovl_u8(vshr_n_u8(px.val[3], 4));
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), vorrq_u16(toRGB444(px.val[0], px.val[1], px.val[2]), a16));
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 16)
+        {
+            const uint8x8x4_t px = vld4_u8(data + i);
+            const uint16x8_t a16 = vmovl_u8(vshr_n_u8(px.val[3], 7));
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), vorrq_u16(toRGB555(px.val[0], px.val[1], px.val[2]), a16));
+        }
+        return i;
+    }
+
+    ssize_t simdRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 24 <= dataLen; i += 24, outData += 16)
+        {
+            const uint8x8x3_t px = vld3_u8(data + i);
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), toRGB565(px.val[0], px.val[1], px.val[2]));
+        }
+        return i;
+    }
+
+    ssize_t simdRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 24 <= dataLen; i += 24, outData += 16)
+        {
+            const uint8x8x3_t px = vld3_u8(data + i);
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), vorrq_u16(toRGB444(px.val[0], px.val[1], px.val[2]), vdupq_n_u16(0x0F)));
+        }
+        return i;
+    }
+
+    ssize_t simdRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 24 <= dataLen; i += 24, outData += 16)
+        {
+            const uint8x8x3_t px = vld3_u8(data + i);
+            vst1q_u16(reinterpret_cast<uint16_t*>(outData), vorrq_u16(toRGB555(px.val[0], px.val[1], px.val[2]), vdupq_n_u16(0x01)));
+        }
+        return i;
+    }
+
+    ssize_t simdRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 24 <= dataLen; i += 24, outData += 32)
+        {
+            const uint8x8x3_t rgb = vld3_u8(data + i);
+            uint8x8x4_t rgba;
+            rgba.val[0] = rgb.val[0];
+            rgba.val[1] = rgb.val[1];
+            rgba.val[2] = rgb.val[2];
+            rgba.val[3] = vdup_n_u8(0xFF);
+            vst4_u8(outData, rgba);
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 24)
+        {
+            const uint8x8x4_t rgba = vld4_u8(data + i);
+            uint8x8x3_t rgb;
+            rgb.val[0] = rgba.val[0];
+            rgb.val[1] = rgba.val[1];
+            rgb.val[2] = rgba.val[2];
+            vst3_u8(outData, rgb);
+        }
+        return i;
+    }
+
+    ssize_t simdRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        ssize_t i = 0;
+        for (; i + 32 <= dataLen; i += 32, outData += 8)
+        {
+            vst1_u8(outData, vld4_u8(data + i).val[3]);
+        }
+        return i;
+    }
+
+    ssize_t simdPremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+    {
+        ssize_t i = 0;
+        for (; i + 8 <= pixelCount; i += 8)
+        {
+            uint8x8x4_t px = vld4_u8(data + i * 4);
+            // c * (a + 1) >> 8
+            px.val[0] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[0], px.val[3]), px.val[0]), 8);
+            px.val[1] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[1], px.val[3]), px.val[1]), 8);
+            px.val[2] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[2], px.val[3]), px.val[2]), 8);
+            vst4_u8(data + i * 4, px);
+        }
+        return i;
+    }
+
+#endif
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+    #define SIMD_CONVERT(kernel, data, dataLen, outData) \
+        (s_simdEnabled.load(std::memory_order_relaxed) ? kernel(data, dataLen, outData) : 0)
+#else
+    #define SIMD_CONVERT(kernel, data, dataLen, outData) 0
+#endif
+}
+
+bool isSIMDAvailable()
+{
+    return s_simdAvailable;
+}
+
+bool isSIMDEnabled()
+{
+    return s_simdEnabled.load(std::memory_order_relaxed);
+}
+
+void setSIMDEnabled(bool enabled)
+{
+    s_simdEnabled.store(enabled && s_simdAvailable, std::memory_order_relaxed);
+}
+
+// The scalar loops convert the pixels the kernels left
+
+void premultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    ssize_t i = 0;
+#if defined(USE_SSE2) || defined(USE_NEON)
+    if (s_simdEnabled.load(std::memory_order_relaxed))
+        i = simdPremultiplyAlpha(data, pixelCount);
+#endif
+    for (; i < pixelCount; ++i)
+    {
+        unsigned char* p = data + i * 4;
+        const unsigned int alpha = p[3] + 1;
+        p[0] = static_cast<unsigned char>((p[0] * alpha) >> 8);
+        p[1] = static_cast<unsigned char>((p[1] * alpha) >> 8);
+        p[2] = static_cast<unsigned char>((p[2] * alpha) >> 8);
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
+void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGBA8888ToRGB565, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 4;
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
+    {
+        *out16++ = (data[i] & 0x00F8) << 8    //R
+            | (data[i + 1] & 0x00FC) << 3     //G
+            | (data[i + 2] & 0x00F8) >> 3;    //B
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
+void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGBA8888ToRGBA4444, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 4;
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
+    {
+        *out16++ = (data[i] & 0x00F0) << 8    //R
+        | (data[i + 1] & 0x00F0) << 4         //G
+        | (data[i + 2] & 0xF0)                //B
+        |  (data[i + 3] & 0xF0) >> 4;         //A
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGBBBBBA
+void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGBA8888ToRGB5A1, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 4;
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
+    {
+        *out16++ = (data[i] & 0x00F8) << 8    //R
+            | (data[i + 1] & 0x00F8) << 3     //G
+            | (data[i + 2] & 0x00F8) >> 2     //B
+            |  (data[i + 3] & 0x0080) >> 7;   //A
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
+void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGBA8888ToRGB888, data, dataLen, outData);
+    outData += i / 4 * 3;
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
+    {
+        *outData++ = data[i];         //R
+        *outData++ = data[i + 1];     //G
+        *outData++ = data[i + 2];     //B
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
+void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGBA8888ToA8, data, dataLen, outData);
+    outData += i / 4;
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
+    {
+        *outData++ = data[i + 3]; //A
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
+void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGB888ToRGBA8888, data, dataLen, outData);
+    outData += i / 3 * 4;
+    for (ssize_t l = dataLen - 2; i < l; i += 3)
+    {
+        *outData++ = data[i];         //R
+        *outData++ = data[i + 1];     //G
+        *outData++ = data[i + 2];     //B
+        *outData++ = 0xFF;            //A
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGGBBBBB
+void convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGB888ToRGB565, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 3;
+    for (ssize_t l = dataLen - 2; i < l; i += 3)
+    {
+        *out16++ = (data[i] & 0x00F8) << 8    //R
+            | (data[i + 1] & 0x00FC) << 3     //G
+            | (data[i + 2] & 0x00F8) >> 3;    //B
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRGGGGBBBBAAAA
+void convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGB888ToRGBA4444, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 3;
+    for (ssize_t l = dataLen - 2; i < l; i += 3)
+    {
+        *out16++ = ((data[i] & 0x00F0) << 8           //R
+                    | (data[i + 1] & 0x00F0) << 4     //G
+                    | (data[i + 2] & 0xF0)            //B
+                    |  0x0F);                         //A
+    }
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
+void convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t i = SIMD_CONVERT(simdRGB888ToRGB5A1, data, dataLen, outData);
+    unsigned short* out16 = (unsigned short*)outData + i / 3;
+    for (ssize_t l = dataLen - 2; i < l; i += 3)
+    {
+        *out16++ = (data[i] & 0x00F8) << 8    //R
+            | (data[i + 1] & 0x00F8) << 3     //G
+            | (data[i + 2] & 0x00F8) >> 2     //B
+            |  0x01;                          //A
+    }
+}
+
+} // namespace PixelConversion
+
+NS_CC_END
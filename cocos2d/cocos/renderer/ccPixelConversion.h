@@ -0,0 +1,80 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PIXEL_CONVERSION_H__
+#define __CC_PIXEL_CONVERSION_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <stdint.h> // for ssize_t on android
+#include <string>   // for ssize_t on linux
+#include "platform/CCStdC.h" // for ssize_t on window
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @file ccPixelConversion.h
+ * The pixel format conversions of Texture2D and the alpha premultiplication of Image.
+ *
+ * They use SSE2 or NEON when the CPU supports it, and the scalar code for the pixels that are left. The results
+ * are the same in both cases. The sizes are in bytes, like the converters of Texture2D.
+ * @since v3.17
+ */
+namespace PixelConversion
+{
+    /** Returns whether the library was built with SSE2 or NEON kernels and the CPU supports them. */
+    CC_DLL bool isSIMDAvailable();
+
+    /** Returns whether the SSE2 or NEON kernels are used. */
+    CC_DLL bool isSIMDEnabled();
+
+    /** Enables or disables the SSE2 or NEON kernels, e.g. to compare them to the scalar code.
+     * They can't be enabled when they are not available.
+     */
+    CC_DLL void setSIMDEnabled(bool enabled);
+
+    /** Multiplies the color channels of RGBA8888 pixels by their alpha, in place. */
+    CC_DLL void premultiplyAlpha(unsigned char* data, ssize_t pixelCount);
+
+    CC_DLL void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+
+    CC_DLL void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+}
+
+NS_CC_END
+
+// end of renderer group
+/// @}
+
+#endif // __CC_PIXEL_CONVERSION_H__
@@ -0,0 +1,161 @@
+#!/usr/bin/python
+# pack_assets.py
+# Packs a resource directory into an archive that FileUtils::mountArchive() can mount.
+#
+#   python pack_assets.py Resources assets.cpk
+#   python pack_assets.py Resources assets.cpk --exclude "*.psd" --exclude "src/*"
+#
+# The layout is documented in cocos/platform/CCFileArchive.h.
+
+import argparse
+import fnmatch
+import os
+import struct
+import sys
+
+MAGIC = b'CCPK'
+VERSION = 1
+HEADER_FORMAT = '<4s5I'
+ENTRY_FORMAT = '<QQIIII'
+DATA_ALIGNMENT = 16
+
+PRIME32_1 = 2654435761
+PRIME32_2 = 2246822519
+PRIME32_3 = 3266489917
+PRIME32_4 = 668265263
+PRIME32_5 = 374761393
+MASK32 = 0xFFFFFFFF
+
+
+def _rotl32(x, r):
+    return ((x << r) | (x >> (32 - r))) & MASK32
+
+
+def _round32(acc, value):
+    acc = (acc + value * PRIME32_2) & MASK32
+    return (_rotl32(acc, 13) * PRIME32_1) & MASK32
+
+
+# XXH32, the hash the engine uses to look names up (external/xxhash)
+def xxh32(data, seed=0):
+    length = len(data)
+    pos = 0
+    if length >= 16:
+        v1 = (seed + PRIME32_1 + PRIME32_2) & MASK32
+        v2 = (seed + PRIME32_2) & MASK32
+        v3 = seed & MASK32
+        v4 = (seed - PRIME32_1) & MASK32
+        while pos + 16 <= length:
+            a, b, c, d = struct.unpack_from('<4I', data, pos)
+            v1 = _round32(v1, a)
+            v2 = _round32(v2, b)
+            v3 = _round32(v3, c)
+            v4 = _round32(v4, d)
+            pos += 16
+        h = (_rotl32(v1, 1) + _rotl32(v2, 7) + _rotl32(v3, 12) + _rotl32(v4, 18)) & MASK32
+    else:
+        h = (seed + PRIME32_5) & MASK32
+
+    h = (h + length) & MASK32
+
+    while pos + 4 <= length:
+        (value,) = struct.unpack_from('<I', data, pos)
+        h = (h + value * PRIME32_3) & MASK32
+        h = (_rotl32(h, 17) * PRIME32_4) & MASK32
+        pos += 4
+
+    while pos < length:
+        value = bytearray(data[pos:pos + 1])[0]
+        h = (h + value * PRIME32_5) & MASK32
+        h = (_rotl32(h, 11) * PRIME32_1) & MASK32
+        pos += 1
+
+    h ^= h >> 15
+    h = (h * PRIME32_2) & MASK32
+    h ^= h >> 13
+    h = (h * PRIME32_3) & MASK32
+    h ^= h >> 16
+    return h
+
+
+def collect_files(root, excludes):
+    files = []
+    for directory, dirnames, filenames in os.walk(root):
+        dirnames.sort()
+        for filename in sorted(filenames):
+            path = os.path.join(directory, filename)
+            name = os.path.relpath(path, root).replace(os.sep, '/')
+            if any(fnmatch.fnmatch(name, pattern) for pattern in excludes):
+                continue
+            files.append((name, path))
+    return files
+
+
+def pack(root, output, excludes):
+    files = collect_files(root, excludes)
+
+    # Keep at least half of the slots free so that probes stay short
+    slot_count = 2
+    while slot_count < len(files) * 2:
+        slot_count *= 2
+
+    names = b''
+    entries = []
+    for name, path in files:
+        encoded = name.encode('utf-8')
+        entries.append({'name': encoded, 'path': path, 'hash': xxh32(encoded), 'name_offset': len(names)})
+        names += encoded
+
+    slots = [0] * slot_count
+    for index, entry in enumerate(entries):
+        slot = entry['hash'] & (slot_count - 1)
+        while slots[slot] != 0:
+            slot = (slot + 1) & (slot_count - 1)
+        slots[slot] = index + 1
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entry_size = struct.calcsize(ENTRY_FORMAT)
+    offset = header_size + 4 * slot_count + entry_size * len(entries) + len(names)
+
+    contents = []
+    for entry in entries:
+        with open(entry['path'], 'rb') as f:
+            data = f.read()
+        offset = (offset + DATA_ALIGNMENT - 1) // DATA_ALIGNMENT * DATA_ALIGNMENT
+        entry['offset'] = offset
+        entry['size'] = len(data)
+        contents.append(data)
+        offset += len(data)
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(entries), slot_count, len(names), 0))
+        f.write(struct.pack('<%dI' % slot_count, *slots))
+        for entry in entries:
+            f.write(struct.pack(ENTRY_FORMAT, entry['offset'], entry['size'], entry['hash'],
+                                entry['name_offset'], len(entry['name']), 0))
+        f.write(names)
+        for entry, data in zip(entries, contents):
+            f.write(b'\0' * (entry['offset'] - f.tell()))
+            f.write(data)
+
+    return len(entries), offset
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Packs a resource directory into an archive for FileUtils::mountArchive().')
+    parser.add_argument('input', help='the resource directory to pack')
+    parser.add_argument('output', help='the archive to write, e.g. assets.cpk')
+    parser.add_argument('--exclude', action='append', default=[],
+                        help='skip files whose path relative to the input matches this pattern, may be repeated')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.input):
+        print(args.input + ' is not a directory!')
+        sys.exit(1)
+
+    count, size = pack(args.input, args.output, args.exclude)
+    print('Packed %d files into %s (%d bytes)' % (count, args.output, size))
+
+
+if __name__ == '__main__':
+    main()